@@ -0,0 +1,46 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+/* -----------------------------------------------------------
+ * 效能量測程式共用的輔助函式
+ *    - nextRandom：固定種子的線性同餘亂數，每次執行產生相同資料
+ *    - timeBest：重複執行取最短時間（毫秒）
+ *    - printRow：方法名稱、毫秒、每秒百萬筆、相對基準的倍數、結果檢查
+ * ---------------------------------------------------------- */
+namespace BenchUtil {
+
+    const int NAME_WIDTH = 30;      // printRow 與表頭的方法名稱欄寬
+
+    inline unsigned int nextRandom(unsigned int& state) {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    template<typename Fn>
+    double timeBest(int repeats, Fn fn) {
+        double best = 0.0;
+        for (int r = 0; r < repeats; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            auto stop = std::chrono::steady_clock::now();
+            double ms = std::chrono::duration<double, std::milli>(stop - start).count();
+            if (r == 0 || ms < best) best = ms;
+        }
+        return best;
+    }
+
+    inline void printRow(const std::string& name, double ms, size_t n, double baseline, bool ok) {
+        std::cout << std::left << std::setw(NAME_WIDTH) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << ms
+                  << std::setw(14) << (ms > 0 ? n / ms / 1000.0 : 0.0)
+                  << std::setw(10) << (ms > 0 ? baseline / ms : 0.0)
+                  << std::setw(8) << (ok ? "ok" : "FAIL") << "\n";
+    }
+}
+
+#endif // BENCH_UTIL_H
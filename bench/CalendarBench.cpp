@@ -0,0 +1,109 @@
+// 日曆分桶效能量測：逐筆 localtime + strftime + 字串雜湊表，與 CalendarUtil 的算術序號 + 稠密陣列比較
+// 用法：bin/bench_CalendarBench [時間戳數量=10000000] [重複次數=3] [TZ，例如 America/New_York]
+#include "../include/CalendarUtil.h"
+#include "BenchUtil.h"
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using BenchUtil::nextRandom;
+using BenchUtil::printRow;
+using BenchUtil::timeBest;
+
+int main(int argc, char* argv[]) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000000;
+    int repeats = argc > 2 ? std::atoi(argv[2]) : 3;
+    if (repeats <= 0) repeats = 1;
+    if (argc > 3) {
+#ifdef _WIN32
+        _putenv_s("TZ", argv[3]);
+#else
+        setenv("TZ", argv[3], 1);
+#endif
+    }
+    tzset();
+
+    // 2000 年至 2030 年之間的隨機時間戳，涵蓋多次日光節約時間轉換
+    std::vector<time_t> timestamps(n);
+    unsigned int state = 7u;
+    for (size_t i = 0; i < n; ++i) {
+        unsigned long long r = (static_cast<unsigned long long>(nextRandom(state)) << 24) ^ nextRandom(state);
+        timestamps[i] = static_cast<time_t>(946684800LL + static_cast<long long>(r % 946684800ULL));
+    }
+
+    auto buildStart = std::chrono::steady_clock::now();
+    const CalendarUtil::OffsetTable& zone = CalendarUtil::localZone();
+    auto buildStop = std::chrono::steady_clock::now();
+
+    const char* tz = std::getenv("TZ");
+    std::cout << "TZ=" << (tz ? tz : "(system)") << ", " << n << " timestamps, milliseconds, best of " << repeats << "\n";
+    std::cout << "Offset table: " << zone.transitionCount() << " entries, built in "
+              << std::fixed << std::setprecision(2)
+              << std::chrono::duration<double, std::milli>(buildStop - buildStart).count() << " ms\n\n";
+    std::cout << std::left << std::setw(BenchUtil::NAME_WIDTH) << "method" << std::right << std::setw(12) << "ms"
+              << std::setw(14) << "M stamps/s" << std::setw(10) << "speedup" << std::setw(8) << "check" << "\n";
+
+    // 基準：原本 getMonthlyStats 的作法
+    std::unordered_map<std::string, int> byString;
+    double msLocaltime = timeBest(repeats, [&] {
+        byString.clear();
+        for (time_t t : timestamps) {
+            struct tm* timeInfo = localtime(&t);
+            char buffer[8];
+            strftime(buffer, 8, "%Y-%m", timeInfo);
+            byString[buffer]++;
+        }
+    });
+    printRow("localtime+strftime+hash", msLocaltime, n, msLocaltime, true);
+
+    CalendarUtil::DenseSeries monthly;
+    double msMonth = timeBest(repeats, [&] {
+        monthly.clear();
+        for (time_t t : timestamps) {
+            monthly.add(CalendarUtil::monthOrdinal(t));
+        }
+    });
+    bool monthOk = true;
+    size_t nonEmpty = 0;
+    for (long long m = monthly.firstOrdinal(); m < monthly.endOrdinal(); ++m) {
+        int count = monthly.get(m);
+        if (count == 0) continue;
+        ++nonEmpty;
+        auto it = byString.find(CalendarUtil::formatMonth(static_cast<int>(m)));
+        monthOk = monthOk && it != byString.end() && it->second == count;
+    }
+    monthOk = monthOk && nonEmpty == byString.size();
+    printRow("month ordinal+dense", msMonth, n, msLocaltime, monthOk);
+
+    CalendarUtil::DenseSeries daily, weekly, monthlyAll;
+    double msAll = timeBest(repeats, [&] {
+        daily.clear();
+        weekly.clear();
+        monthlyAll.clear();
+        for (time_t t : timestamps) {
+            long long day = CalendarUtil::dayOrdinal(t);
+            daily.add(day);
+            weekly.add(CalendarUtil::weekOfDay(day));
+            monthlyAll.add(CalendarUtil::monthOfDay(day));
+        }
+    });
+    printRow("day+week+month dense", msAll, n, msLocaltime, monthlyAll.values() == monthly.values());
+
+    // 抽樣比對 localtime 的年月日
+    bool dateOk = true;
+    for (size_t i = 0; i < n; i += 97) {
+        time_t t = timestamps[i];
+        struct tm* timeInfo = localtime(&t);
+        CalendarUtil::CivilDate date = CalendarUtil::localDate(t);
+        dateOk = dateOk && date.year == timeInfo->tm_year + 1900 && date.month == timeInfo->tm_mon + 1 &&
+                 date.day == timeInfo->tm_mday;
+    }
+    std::cout << "\nSampled local dates vs localtime: " << (dateOk ? "ok" : "FAIL") << "\n";
+
+    return (monthOk && dateOk) ? 0 : 1;
+}
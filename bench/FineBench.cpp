@@ -0,0 +1,90 @@
+// 罰款計算效能量測：逐日 pow 累加、等比級數封閉形式、前綴表批次計算，並檢查三者結果一致
+// 用法：bin/bench_FineBench [借閱筆數=1000000] [重複次數=3]
+#include "../include/FinePolicy.h"
+#include "BenchUtil.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using BenchUtil::nextRandom;
+using BenchUtil::timeBest;
+
+namespace {
+    double relativeError(double value, double reference) {
+        if (value == reference) return 0.0;
+        if (std::isinf(value) && std::isinf(reference)) return 0.0;
+        return std::fabs(value - reference) / std::max(std::fabs(reference), 1e-300);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    int repeats = argc > 2 ? std::atoi(argv[2]) : 3;
+    if (repeats <= 0) repeats = 1;
+
+    // 等價性：各種政策在 0..3000 天的結果與逐日累加比對
+    const double factors[] = {0.5, 1.0, 1.0001, 1.01, 1.05, 1.1, 1.5};
+    double maxTableError = 0.0, maxClosedError = 0.0;
+    for (int grace = 0; grace <= 3; ++grace) {
+        for (double factor : factors) {
+            FinePolicy policy(grace, 10.0, factor);
+            std::vector<int> days(3001);
+            for (int d = 0; d <= 3000; ++d) days[d] = d;
+            std::vector<double> batch;
+            policy.calculateFines(days, batch);
+            for (int d = 0; d <= 3000; ++d) {
+                double reference = policy.calculateFineIterative(d);
+                maxTableError = std::max(maxTableError, relativeError(policy.calculateFine(d), reference));
+                maxTableError = std::max(maxTableError, relativeError(batch[d], reference));
+                maxClosedError = std::max(maxClosedError, relativeError(policy.calculateFineClosedForm(d), reference));
+            }
+        }
+    }
+    bool equivalent = maxTableError < 1e-9 && maxClosedError < 1e-9;
+    std::cout << "Equivalence vs day-by-day loop (0..3000 days, 28 policies)\n"
+              << "  max relative error, table/batch: " << std::scientific << std::setprecision(2) << maxTableError << "\n"
+              << "  max relative error, closed form: " << maxClosedError << "\n"
+              << "  " << (equivalent ? "ok" : "FAIL") << "\n\n";
+
+    // 吞吐量：逾期 0..730 天的借閱紀錄
+    FinePolicy policy(3, 10.0, 1.05);
+    std::vector<int> overdueDays(n);
+    unsigned int state = 5u;
+    for (size_t i = 0; i < n; ++i) {
+        overdueDays[i] = static_cast<int>(nextRandom(state) % 731);
+    }
+
+    double sumIterative = 0.0, sumClosed = 0.0, sumBatch = 0.0;
+    double msIterative = timeBest(repeats, [&] {
+        sumIterative = 0.0;
+        for (int d : overdueDays) sumIterative += policy.calculateFineIterative(d);
+    });
+    double msClosed = timeBest(repeats, [&] {
+        sumClosed = 0.0;
+        for (int d : overdueDays) sumClosed += policy.calculateFineClosedForm(d);
+    });
+    std::vector<double> fines;
+    double msBatch = timeBest(repeats, [&] {
+        policy.calculateFines(overdueDays, fines);
+        sumBatch = 0.0;
+        for (double fine : fines) sumBatch += fine;
+    });
+
+    std::cout << n << " loans, 0..730 days overdue, milliseconds, best of " << repeats << "\n";
+    std::cout << std::left << std::setw(20) << "method" << std::right << std::setw(12) << "ms"
+              << std::setw(10) << "speedup" << "\n" << std::fixed << std::setprecision(2);
+    std::cout << std::left << std::setw(20) << "day-by-day pow" << std::right << std::setw(12) << msIterative
+              << std::setw(10) << 1.0 << "\n";
+    std::cout << std::left << std::setw(20) << "closed form" << std::right << std::setw(12) << msClosed
+              << std::setw(10) << (msClosed > 0 ? msIterative / msClosed : 0.0) << "\n";
+    std::cout << std::left << std::setw(20) << "table batch" << std::right << std::setw(12) << msBatch
+              << std::setw(10) << (msBatch > 0 ? msIterative / msBatch : 0.0) << "\n";
+    std::cout << "\nTotals: " << std::setprecision(4) << sumIterative << " / " << sumClosed << " / " << sumBatch << "\n";
+
+    return equivalent ? 0 : 1;
+}
@@ -0,0 +1,203 @@
+// 借閱歷史編碼量測：loans.json 格式、封存區段的精簡 JSON 與 LoanCodec 二進位編碼的大小與解碼速度
+// 用法：bin/bench_LoanCodecBench [借閱筆數=200000] [重複次數=3] [讀者數=5000] [書籍數=20000]
+#include "../include/LoanCodec.h"
+#include "../include/CopyInventory.h"
+#include "../include/SimpleJSON.h"
+#include "../include/SortUtil.h"
+#include "BenchUtil.h"
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using JSONValue = SimpleJSON::JSONValue;
+using BenchUtil::nextRandom;
+using BenchUtil::timeBest;
+
+namespace {
+    // 與 LoanManager::saveToFile 相同的欄位與縮排
+    std::string toLoansJson(const std::vector<LoanRecord>& loans) {
+        auto array = JSONValue::createArray();
+        for (const auto& loan : loans) {
+            auto object = JSONValue::createObject();
+            object->set("bookId", loan.getBookId());
+            object->set("username", loan.getUsername());
+            object->set("borrowDate", static_cast<int>(loan.getBorrowDate()));
+            object->set("dueDate", static_cast<int>(loan.getDueDate()));
+            if (loan.isReturned()) {
+                object->set("returnDate", static_cast<int>(loan.getReturnDate()));
+            }
+            if (!loan.getBarcode().empty()) {
+                object->set("barcode", loan.getBarcode());
+            }
+            array->push_back(object);
+        }
+        auto root = JSONValue::createObject();
+        root->set("loans", array);
+        return SimpleJSON::stringifyJSON(root, 4);
+    }
+
+    // 與前一版封存區段相同：讀者字典 + 每筆一個陣列，不縮排
+    std::string toCompactJson(const std::vector<LoanRecord>& loans) {
+        std::unordered_map<std::string, int> userIndex;
+        auto users = JSONValue::createArray();
+        auto records = JSONValue::createArray();
+        for (const auto& loan : loans) {
+            auto inserted = userIndex.emplace(loan.getUsername(), static_cast<int>(userIndex.size()));
+            if (inserted.second) {
+                users->push_back(loan.getUsername());
+            }
+            auto record = JSONValue::createArray();
+            record->push_back(loan.getBookId());
+            record->push_back(inserted.first->second);
+            record->push_back(static_cast<double>(loan.getBorrowDate()));
+            record->push_back(static_cast<double>(loan.getDueDate()));
+            record->push_back(static_cast<double>(loan.getReturnDate()));
+            record->push_back(loan.getBarcode());
+            records->push_back(record);
+        }
+        auto root = JSONValue::createObject();
+        root->set("users", users);
+        root->set("loans", records);
+        return SimpleJSON::stringifyJSON(root);
+    }
+
+    bool sameLoan(const LoanRecord& a, const LoanRecord& b) {
+        return a.getUsername() == b.getUsername() && a.getBookId() == b.getBookId() &&
+               a.getBorrowDate() == b.getBorrowDate() && a.getDueDate() == b.getDueDate() &&
+               a.getReturnDate() == b.getReturnDate() && a.getBarcode() == b.getBarcode();
+    }
+
+    void printRow(const std::string& name, size_t bytes, size_t n, double ms, double baseline) {
+        std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(14) << bytes
+                  << std::setw(12) << static_cast<double>(bytes) / n
+                  << std::setw(12) << ms
+                  << std::setw(14) << (ms > 0 ? n / ms / 1000.0 : 0.0)
+                  << std::setw(10) << (ms > 0 ? baseline / ms : 0.0) << "\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    int repeats = argc > 2 ? std::atoi(argv[2]) : 3;
+    int userTotal = argc > 3 ? std::atoi(argv[3]) : 5000;
+    int bookTotal = argc > 4 ? std::atoi(argv[4]) : 20000;
+    if (n == 0) n = 1;
+    if (repeats <= 0) repeats = 1;
+    if (userTotal <= 0) userTotal = 1;
+    if (bookTotal <= 0) bookTotal = 1;
+
+    // 一年內依時間遞增的已歸還借閱；多數借出的冊有條碼，少數是舊資料沒有條碼
+    const time_t day = 24 * 60 * 60;
+    time_t begin = time(nullptr) - 400 * day;
+    std::vector<LoanRecord> loans;
+    loans.reserve(n);
+    unsigned int state = 23u;
+    for (size_t i = 0; i < n; ++i) {
+        time_t borrow = begin + static_cast<time_t>((365 * day) * (static_cast<double>(i) / n));
+        int bookId = 1 + static_cast<int>(nextRandom(state) % bookTotal);
+        LoanRecord loan("reader" + std::to_string(nextRandom(state) % userTotal), bookId, borrow, borrow + 14 * day);
+        loan.setReturnDate(borrow + static_cast<time_t>(nextRandom(state) % (21 * day)));
+        if (nextRandom(state) % 10 != 0) {
+            loan.setBarcode(CopyInventory::makeBarcode(bookId, 1 + static_cast<int>(nextRandom(state) % 5)));
+        }
+        loans.push_back(loan);
+    }
+    std::vector<const LoanRecord*> pointers;
+    for (const auto& loan : loans) {
+        pointers.push_back(&loan);
+    }
+
+    std::string loansJson = toLoansJson(loans);
+    std::string compactJson = toCompactJson(loans);
+    std::string encoded;
+    double msEncode = timeBest(repeats, [&] { encoded = LoanCodec::encode(pointers); });
+
+    std::cout << n << " loans, " << userTotal << " readers, " << bookTotal << " books, best of " << repeats << "\n";
+    std::cout << "LoanCodec::encode: " << std::fixed << std::setprecision(2) << msEncode << " ms ("
+              << (msEncode > 0 ? n / msEncode / 1000.0 : 0.0) << " M loans/s)\n\n";
+    std::cout << std::left << std::setw(22) << "format" << std::right << std::setw(14) << "bytes"
+              << std::setw(12) << "bytes/loan" << std::setw(12) << "decode ms" << std::setw(14) << "M loans/s"
+              << std::setw(10) << "speedup" << "\n";
+
+    // 解碼：全部轉成 LoanRecord
+    std::vector<LoanRecord> fromJson;
+    double msJson = timeBest(repeats, [&] {
+        fromJson.clear();
+        auto root = SimpleJSON::parseJSON(loansJson);
+        for (const auto& item : root->at("loans")->getArray()) {
+            LoanRecord loan(item->at("username")->getString(), item->at("bookId")->getInt(),
+                            item->at("borrowDate")->getInt(), item->at("dueDate")->getInt());
+            if (item->contains("returnDate")) {
+                loan.setReturnDate(item->at("returnDate")->getInt());
+            }
+            if (item->contains("barcode")) {
+                loan.setBarcode(item->at("barcode")->getString());
+            }
+            fromJson.push_back(loan);
+        }
+    });
+    printRow("loans.json", loansJson.size(), n, msJson, msJson);
+
+    std::vector<LoanRecord> fromCompact;
+    double msCompact = timeBest(repeats, [&] {
+        fromCompact.clear();
+        auto root = SimpleJSON::parseJSON(compactJson);
+        std::vector<std::string> users;
+        for (const auto& user : root->at("users")->getArray()) {
+            users.push_back(user->getString());
+        }
+        for (const auto& record : root->at("loans")->getArray()) {
+            const auto& fields = record->getArray();
+            LoanRecord loan(users[fields[1]->getInt()], fields[0]->getInt(),
+                            static_cast<time_t>(fields[2]->getNumber()), static_cast<time_t>(fields[3]->getNumber()));
+            loan.setReturnDate(static_cast<time_t>(fields[4]->getNumber()));
+            loan.setBarcode(fields[5]->getString());
+            fromCompact.push_back(loan);
+        }
+    });
+    printRow("compact JSON segment", compactJson.size(), n, msCompact, msJson);
+
+    std::vector<LoanRecord> fromCodec;
+    bool decodedOk = true;
+    double msCodec = timeBest(repeats, [&] {
+        fromCodec.clear();
+        decodedOk = LoanCodec::decode(encoded, fromCodec);
+    });
+    printRow("LoanCodec", encoded.size(), n, msCodec, msJson);
+
+    // 串流走訪：不建立 LoanRecord，只累加欄位
+    long long checksum = 0;
+    double msStream = timeBest(repeats, [&] {
+        checksum = 0;
+        LoanCodec::Reader reader(encoded);
+        LoanCodec::Entry entry;
+        while (reader.next(entry)) {
+            checksum += entry.bookId + (entry.returnDate - entry.borrowDate);
+        }
+    });
+    printRow("LoanCodec::Reader", encoded.size(), n, msStream, msJson);
+
+    // 比對：編碼後的順序為 (讀者, 借出時間, 書籍 ID)，原始資料依同樣順序排序後逐筆比較
+    SortUtil::sort(pointers, [](const LoanRecord* a, const LoanRecord* b) {
+        if (a->getUsername() != b->getUsername()) return a->getUsername() < b->getUsername();
+        if (a->getBorrowDate() != b->getBorrowDate()) return a->getBorrowDate() < b->getBorrowDate();
+        return a->getBookId() < b->getBookId();
+    });
+    bool roundTrip = decodedOk && fromCodec.size() == n && fromJson.size() == n && fromCompact.size() == n;
+    long long expectedChecksum = 0;
+    for (size_t i = 0; roundTrip && i < n; ++i) {
+        roundTrip = sameLoan(*pointers[i], fromCodec[i]) && sameLoan(loans[i], fromJson[i]) &&
+                    sameLoan(loans[i], fromCompact[i]);
+        expectedChecksum += loans[i].getBookId() + (loans[i].getReturnDate() - loans[i].getBorrowDate());
+    }
+    roundTrip = roundTrip && checksum == expectedChecksum;
+
+    std::cout << "\nRound trip: " << (roundTrip ? "ok" : "FAIL") << "\n";
+    return roundTrip ? 0 : 1;
+}
@@ -0,0 +1,150 @@
+// 借閱彙總效能量測：逐筆走訪 LoanRecord 指標（原本儀表板的作法）與 LoanColumns 欄式核心比較
+// 用法：bin/bench_LoanColumnBench [借閱筆數=2000000] [重複次數=5] [讀者數=5000] [書籍數=20000]
+#include "../include/LoanColumns.h"
+#include "BenchUtil.h"
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using BenchUtil::nextRandom;
+using BenchUtil::printRow;
+using BenchUtil::timeBest;
+
+int main(int argc, char* argv[]) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000;
+    int repeats = argc > 2 ? std::atoi(argv[2]) : 5;
+    int userTotal = argc > 3 ? std::atoi(argv[3]) : 5000;
+    int bookTotal = argc > 4 ? std::atoi(argv[4]) : 20000;
+    if (repeats <= 0) repeats = 1;
+    if (userTotal <= 0) userTotal = 1;
+    if (bookTotal <= 0) bookTotal = 1;
+
+    // 五年內依時間遞增的借閱；借期 14 天，最近 60 天內借出的約半數尚未歸還
+    const time_t day = 24 * 60 * 60;
+    time_t now = time(nullptr);
+    time_t begin = now - 5 * 365 * day;
+    std::deque<LoanRecord> loans;
+    unsigned int state = 11u;
+    for (size_t i = 0; i < n; ++i) {
+        time_t borrow = begin + static_cast<time_t>((5 * 365 * day) * (static_cast<double>(i) / n));
+        std::string user = "reader" + std::to_string(nextRandom(state) % userTotal);
+        LoanRecord loan(user, 1 + static_cast<int>(nextRandom(state) % bookTotal), borrow, borrow + 14 * day);
+        if (borrow < now - 60 * day || nextRandom(state) % 2 == 0) {
+            loan.setReturnDate(borrow + static_cast<time_t>(nextRandom(state) % (20 * day)));
+        }
+        loans.push_back(loan);
+    }
+    std::vector<LoanRecord*> pointers;
+    for (auto& loan : loans) {
+        pointers.push_back(&loan);
+    }
+
+    LoanColumns columns;
+    auto buildStart = std::chrono::steady_clock::now();
+    columns.rebuild(loans);
+    auto buildStop = std::chrono::steady_clock::now();
+
+    std::cout << n << " loans, " << userTotal << " readers, " << bookTotal << " books, milliseconds, best of "
+              << repeats << "\n";
+    std::cout << "Columns built in " << std::fixed << std::setprecision(2)
+              << std::chrono::duration<double, std::milli>(buildStop - buildStart).count() << " ms, "
+              << columns.size() * 6 * sizeof(int32_t) / (1024.0 * 1024.0) << " MiB\n\n";
+    std::cout << std::left << std::setw(BenchUtil::NAME_WIDTH) << "method" << std::right << std::setw(12) << "ms"
+              << std::setw(14) << "M rows/s" << std::setw(10) << "speedup" << std::setw(8) << "check" << "\n";
+
+    time_t weekAgo = now - 7 * day;
+    time_t monthAgo = now - 30 * day;
+    time_t forever = std::numeric_limits<time_t>::max();
+
+    // 近期活動：7／30 天內的借出與歸還次數
+    size_t expected[4] = {0, 0, 0, 0};
+    double msScan = timeBest(repeats, [&] {
+        size_t counts[4] = {0, 0, 0, 0};
+        for (const auto* loan : pointers) {
+            if (loan->getBorrowDate() >= weekAgo) counts[0]++;
+            if (loan->getBorrowDate() >= monthAgo) counts[1]++;
+            if (loan->isReturned()) {
+                if (loan->getReturnDate() >= weekAgo) counts[2]++;
+                if (loan->getReturnDate() >= monthAgo) counts[3]++;
+            }
+        }
+        for (int k = 0; k < 4; ++k) expected[k] = counts[k];
+    });
+    printRow("recent activity: pointers", msScan, n, msScan, true);
+
+    size_t actual[4] = {0, 0, 0, 0};
+    double msColumns = timeBest(repeats, [&] {
+        actual[0] = columns.countBorrowedBetween(weekAgo, forever);
+        actual[1] = columns.countBorrowedBetween(monthAgo, forever);
+        actual[2] = columns.countReturnedBetween(weekAgo, forever);
+        actual[3] = columns.countReturnedBetween(monthAgo, forever);
+    });
+    bool activityOk = true;
+    for (int k = 0; k < 4; ++k) activityOk = activityOk && expected[k] == actual[k];
+    printRow("recent activity: columns", msColumns, n, msScan, activityOk);
+
+    // 逾期筆數
+    size_t overdueScan = 0;
+    double msOverdueScan = timeBest(repeats, [&] {
+        overdueScan = 0;
+        for (const auto* loan : pointers) {
+            if (!loan->isReturned() && loan->getDueDate() < now) overdueScan++;
+        }
+    });
+    printRow("overdue: pointers", msOverdueScan, n, msOverdueScan, true);
+
+    size_t overdueColumns = 0;
+    double msOverdueColumns = timeBest(repeats, [&] { overdueColumns = columns.countOverdue(now); });
+    printRow("overdue: columns", msOverdueColumns, n, msOverdueScan, overdueScan == overdueColumns);
+
+    // 30 天內依讀者分組
+    std::unordered_map<std::string, int> byName;
+    double msGroupScan = timeBest(repeats, [&] {
+        byName.clear();
+        for (const auto* loan : pointers) {
+            if (loan->getBorrowDate() >= monthAgo) byName[loan->getUsername()]++;
+        }
+    });
+    printRow("30d by reader: pointers+hash", msGroupScan, n, msGroupScan, true);
+
+    std::vector<int> byOrdinal;
+    double msGroupColumns = timeBest(repeats, [&] { byOrdinal = columns.borrowsByUser(monthAgo, forever); });
+    bool groupOk = true;
+    size_t nonZero = 0;
+    for (size_t u = 0; u < byOrdinal.size(); ++u) {
+        if (byOrdinal[u] == 0) continue;
+        ++nonZero;
+        auto it = byName.find(columns.usernameAt(static_cast<int32_t>(u)));
+        groupOk = groupOk && it != byName.end() && it->second == byOrdinal[u];
+    }
+    groupOk = groupOk && nonZero == byName.size();
+    printRow("30d by reader: columns", msGroupColumns, n, msGroupScan, groupOk);
+
+    // 全期間依書籍分組（整段區間都命中，量測分組累加本身）
+    std::unordered_map<int, int> byBookId;
+    double msBookScan = timeBest(repeats, [&] {
+        byBookId.clear();
+        for (const auto* loan : pointers) byBookId[loan->getBookId()]++;
+    });
+    printRow("all-time by book: pointers", msBookScan, n, msBookScan, true);
+
+    std::vector<int> byBook;
+    time_t never = std::numeric_limits<time_t>::min();
+    double msBookColumns = timeBest(repeats, [&] { byBook = columns.borrowsByBook(never, forever); });
+    bool bookOk = byBook.size() == byBookId.size();
+    for (size_t b = 0; bookOk && b < byBook.size(); ++b) {
+        bookOk = byBookId[columns.bookIdAt(static_cast<int32_t>(b))] == byBook[b];
+    }
+    printRow("all-time by book: columns", msBookColumns, n, msBookScan, bookOk);
+
+    bool ok = activityOk && overdueScan == overdueColumns && groupOk && bookOk;
+    std::cout << "\nAll results match: " << (ok ? "ok" : "FAIL") << "\n";
+    return ok ? 0 : 1;
+}
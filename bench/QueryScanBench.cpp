@@ -0,0 +1,113 @@
+// 平行掃描效能量測：產生合成館藏，對無法使用索引的欄位條件以不同執行緒數計時
+// 用法：bin/bench_QueryScanBench [書籍數量=1000000] [重複次數=5]
+#include "../include/BookManager.h"
+#include "../include/WorkerPool.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+    const char* WORDS[] = {
+        "river", "shadow", "garden", "machine", "empire", "winter", "signal", "harbor",
+        "silent", "orbit", "lantern", "forest", "glass", "memory", "thunder", "paper"
+    };
+    const size_t WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+    // 固定種子的線性同餘產生器，確保每次產生相同的館藏
+    unsigned int nextRandom(unsigned int& state) {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    std::string makeText(unsigned int& state, int words) {
+        std::string text;
+        for (int i = 0; i < words; ++i) {
+            if (i > 0) {
+                text += ' ';
+            }
+            text += WORDS[nextRandom(state) % WORD_COUNT];
+        }
+        return text;
+    }
+
+    void buildCatalog(BookManager& manager, size_t count) {
+        unsigned int state = 12345u;
+        for (size_t i = 0; i < count; ++i) {
+            Book book(0,
+                      makeText(state, 3),
+                      "Author " + std::to_string(nextRandom(state) % 5000),
+                      1900 + static_cast<int>(nextRandom(state) % 125),
+                      1 + static_cast<int>(nextRandom(state) % 5),
+                      "978" + std::to_string(1000000 + i),
+                      "Publisher " + std::to_string(nextRandom(state) % 300),
+                      (nextRandom(state) % 2) ? "English" : "中文",
+                      50 + static_cast<int>(nextRandom(state) % 900),
+                      makeText(state, 24));
+            manager.addBook(book);
+        }
+    }
+
+    double timeQuery(BookManager& manager, const std::string& query, int repeats, size_t& matches) {
+        double best = 0.0;
+        for (int r = 0; r < repeats; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            matches = manager.advancedSearch(query).size();
+            auto stop = std::chrono::steady_clock::now();
+            double ms = std::chrono::duration<double, std::milli>(stop - start).count();
+            if (r == 0 || ms < best) {
+                best = ms;
+            }
+        }
+        return best;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t bookCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    int repeats = argc > 2 ? std::atoi(argv[2]) : 5;
+    if (repeats <= 0) {
+        repeats = 1;
+    }
+
+    std::cout << "Building synthetic catalog of " << bookCount << " books..." << std::endl;
+    BookManager manager;
+    buildCatalog(manager, bookCount);
+    // 關閉結果快取，每次查詢都實際掃描
+    manager.setQueryCacheCapacity(0);
+
+    const std::vector<std::string> queries = {
+        "synopsis~\"lantern thunder\"",
+        "publisher>\"Publisher 150\"",
+        "pagecount>=500 AND NOT synopsis~orbit",
+        "isbn~\"99\" OR language=English"
+    };
+    const size_t threadCounts[] = {1, 2, 4, 8};
+
+    std::cout << "Hardware threads: " << WorkerPool::defaultThreadCount() << "\n\n";
+    std::cout << std::left << std::setw(40) << "query" << std::right
+              << std::setw(8) << "threads" << std::setw(12) << "best ms"
+              << std::setw(10) << "speedup" << std::setw(10) << "matches" << "\n";
+
+    for (const auto& query : queries) {
+        double baseline = 0.0;
+        for (size_t threads : threadCounts) {
+            manager.setScanThreadCount(threads);
+            size_t matches = 0;
+            double ms = timeQuery(manager, query, repeats, matches);
+            if (threads == 1) {
+                baseline = ms;
+            }
+            std::cout << std::left << std::setw(40) << query << std::right
+                      << std::setw(8) << threads
+                      << std::setw(12) << std::fixed << std::setprecision(2) << ms
+                      << std::setw(9) << std::setprecision(2) << (ms > 0.0 ? baseline / ms : 0.0) << "x"
+                      << std::setw(10) << matches << "\n";
+        }
+        std::cout << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+// 基數排序效能量測：SortUtil::radixSort 與比較式 SortUtil::sort 在整數鍵上的比較
+// 用法：bin/bench_RadixBench [最大元素數量=10000000] [重複次數=3]
+#include "../include/SortUtil.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+    struct LoanEntry {
+        long long dueDate;
+        int bookId;
+    };
+
+    unsigned int nextRandom(unsigned int& state) {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    template<typename T, typename Fn, typename Check>
+    double timeBest(const std::vector<T>& input, int repeats, Fn sortFn, Check isSorted, bool& ok) {
+        double best = 0.0;
+        ok = true;
+        for (int r = 0; r < repeats; ++r) {
+            std::vector<T> data = input;
+            auto start = std::chrono::steady_clock::now();
+            sortFn(data);
+            auto stop = std::chrono::steady_clock::now();
+            double ms = std::chrono::duration<double, std::milli>(stop - start).count();
+            if (r == 0 || ms < best) best = ms;
+            ok = ok && isSorted(data);
+        }
+        return best;
+    }
+
+    template<typename T, typename KeyFn>
+    void runCase(const std::string& name, const std::vector<T>& input, int repeats, KeyFn key) {
+        auto less = [&key](const T& a, const T& b) { return key(a) < key(b); };
+        auto isSorted = [&key](const std::vector<T>& data) {
+            for (size_t i = 1; i < data.size(); ++i) {
+                if (key(data[i]) < key(data[i - 1])) return false;
+            }
+            return true;
+        };
+        bool okSort = false, okRadix = false;
+
+        double msSort = timeBest(input, repeats, [&](std::vector<T>& d) { SortUtil::sort(d, less); }, isSorted, okSort);
+        double msRadix = timeBest(input, repeats, [&](std::vector<T>& d) { SortUtil::radixSort(d, key); }, isSorted, okRadix);
+
+        std::cout << std::left << std::setw(12) << input.size() << std::setw(16) << name << std::right
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(12) << msSort << std::setw(12) << msRadix
+                  << std::setw(10) << (msRadix > 0 ? msSort / msRadix : 0.0)
+                  << std::setw(8) << ((okSort && okRadix) ? "ok" : "FAIL") << "\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t maxN = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000000;
+    int repeats = argc > 2 ? std::atoi(argv[2]) : 3;
+    if (repeats <= 0) repeats = 1;
+
+    std::cout << "Milliseconds, best of " << repeats << "\n\n";
+    std::cout << std::left << std::setw(12) << "elements" << std::setw(16) << "keys" << std::right
+              << std::setw(12) << "SortUtil" << std::setw(12) << "radix" << std::setw(10) << "speedup"
+              << std::setw(8) << "check" << "\n";
+
+    for (size_t n = 100000; n <= maxN; n *= 10) {
+        unsigned int state = 11u;
+
+        std::vector<int> ids(n);
+        std::vector<int> years(n);
+        std::vector<LoanEntry> loans(n);
+        for (size_t i = 0; i < n; ++i) {
+            ids[i] = static_cast<int>(nextRandom(state));
+            years[i] = 1900 + static_cast<int>(nextRandom(state) % 125);
+            loans[i].dueDate = 1600000000LL + static_cast<long long>(nextRandom(state) % 200000000u);
+            loans[i].bookId = static_cast<int>(i);
+        }
+
+        auto intKey = [](int value) { return value; };
+        runCase("int32 random", ids, repeats, intKey);
+        runCase("int32 years", years, repeats, intKey);
+        runCase("int64 due date", loans, repeats, [](const LoanEntry& loan) { return loan.dueDate; });
+    }
+
+    return 0;
+}
@@ -0,0 +1,141 @@
+// 子字串搜尋效能量測：以合成的書籍簡介文字比較純量、SSE2、AVX2 實作
+// 用法：bin/bench_SearchBench [簡介數量=20000] [重複次數=5]
+#include "../include/SearchUtil.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+    const char* ENGLISH_WORDS[] = {
+        "the", "a", "young", "detective", "returns", "to", "Taipei", "after", "years",
+        "abroad", "and", "uncovers", "family", "secret", "that", "changes", "everything",
+        "in", "this", "moving", "story", "of", "love", "loss", "history", "memory",
+        "river", "city", "war", "Journey", "across", "mountains", "with", "her", "old", "friend"
+    };
+    const char* CHINESE_WORDS[] = {
+        "一位", "年輕的", "偵探", "回到", "台北", "多年後", "揭開", "家族", "秘密",
+        "這是", "關於", "愛情", "失去", "歷史", "記憶", "的故事", "，", "。"
+    };
+    const size_t ENGLISH_COUNT = sizeof(ENGLISH_WORDS) / sizeof(ENGLISH_WORDS[0]);
+    const size_t CHINESE_COUNT = sizeof(CHINESE_WORDS) / sizeof(CHINESE_WORDS[0]);
+
+    unsigned int nextRandom(unsigned int& state) {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    // 約 3/4 英文簡介（150~400 位元組）、1/4 中文簡介
+    std::vector<std::string> makeSynopses(size_t count) {
+        std::vector<std::string> synopses;
+        synopses.reserve(count);
+        unsigned int state = 2024u;
+        for (size_t i = 0; i < count; ++i) {
+            std::string text;
+            bool chinese = nextRandom(state) % 4 == 0;
+            int words = 25 + static_cast<int>(nextRandom(state) % 45);
+            for (int w = 0; w < words; ++w) {
+                if (chinese) {
+                    text += CHINESE_WORDS[nextRandom(state) % CHINESE_COUNT];
+                } else {
+                    if (w > 0) text += ' ';
+                    text += ENGLISH_WORDS[nextRandom(state) % ENGLISH_COUNT];
+                }
+            }
+            synopses.push_back(text);
+        }
+        return synopses;
+    }
+
+    const char* levelName(SearchUtil::SimdLevel level) {
+        switch (level) {
+            case SearchUtil::SimdLevel::AVX2: return "AVX2";
+            case SearchUtil::SimdLevel::SSE2: return "SSE2";
+            default:                          return "scalar";
+        }
+    }
+
+    template <typename Fn>
+    double timeBest(int repeats, Fn fn, size_t& matches) {
+        double best = 0.0;
+        for (int r = 0; r < repeats; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            matches = fn();
+            auto stop = std::chrono::steady_clock::now();
+            double ms = std::chrono::duration<double, std::milli>(stop - start).count();
+            if (r == 0 || ms < best) best = ms;
+        }
+        return best;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    int repeats = argc > 2 ? std::atoi(argv[2]) : 5;
+    if (repeats <= 0) repeats = 1;
+
+    std::vector<std::string> synopses = makeSynopses(count);
+    size_t totalBytes = 0;
+    for (const auto& text : synopses) totalBytes += text.size();
+
+    std::cout << "Synopses: " << count << " (" << totalBytes / 1024 << " KiB), detected SIMD: "
+              << levelName(SearchUtil::detectedSimdLevel()) << "\n\n";
+
+    const std::vector<std::string> patterns = {"x", "love", "Journey", "family secret", "台北", "家族秘密"};
+    const SearchUtil::SimdLevel levels[] = {
+        SearchUtil::SimdLevel::SCALAR, SearchUtil::SimdLevel::SSE2, SearchUtil::SimdLevel::AVX2
+    };
+
+    std::cout << std::left << std::setw(16) << "pattern" << std::setw(22) << "mode" << std::right
+              << std::setw(10) << "ms" << std::setw(10) << "GB/s" << std::setw(10) << "matches" << "\n";
+
+    for (const auto& pattern : patterns) {
+        for (SearchUtil::SimdLevel requested : levels) {
+            SearchUtil::SimdLevel level = SearchUtil::setSimdLevel(requested);
+            if (level != requested) continue;
+
+            for (int ignoreCase = 0; ignoreCase <= 1; ++ignoreCase) {
+                size_t matches = 0;
+                double ms = timeBest(repeats, [&]() {
+                    size_t found = 0;
+                    for (const auto& text : synopses) {
+                        bool hit = ignoreCase ? SearchUtil::containsIgnoreCase(text, pattern)
+                                              : SearchUtil::contains(text, pattern);
+                        if (hit) ++found;
+                    }
+                    return found;
+                }, matches);
+
+                std::string mode = std::string(levelName(level)) + (ignoreCase ? " ignore-case" : "");
+                std::cout << std::left << std::setw(16) << pattern << std::setw(22) << mode << std::right
+                          << std::setw(10) << std::fixed << std::setprecision(2) << ms
+                          << std::setw(10) << std::setprecision(2) << (totalBytes / (ms * 1e6))
+                          << std::setw(10) << matches << "\n";
+            }
+        }
+
+        // 對照：舊做法先建立小寫副本再搜尋
+        SearchUtil::setSimdLevel(SearchUtil::SimdLevel::SCALAR);
+        size_t matches = 0;
+        double ms = timeBest(repeats, [&]() {
+            size_t found = 0;
+            std::string loweredPattern = pattern;
+            for (char& c : loweredPattern) if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
+            for (const auto& text : synopses) {
+                std::string lowered = text;
+                for (char& c : lowered) if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
+                if (SearchUtil::contains(lowered, loweredPattern)) ++found;
+            }
+            return found;
+        }, matches);
+        std::cout << std::left << std::setw(16) << pattern << std::setw(22) << "scalar lower-copy" << std::right
+                  << std::setw(10) << std::fixed << std::setprecision(2) << ms
+                  << std::setw(10) << std::setprecision(2) << (totalBytes / (ms * 1e6))
+                  << std::setw(10) << matches << "\n\n";
+        SearchUtil::setSimdLevel(SearchUtil::detectedSimdLevel());
+    }
+
+    return 0;
+}
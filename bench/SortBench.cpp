@@ -0,0 +1,186 @@
+// 排序效能量測：SortUtil::sort（pdqsort）、SortUtil::parallelSort 與舊版 Lomuto 快速排序、
+// std::sort 在各種輸入分佈下的比較，以及排行榜用的 SortUtil::topK 與完整排序的比較
+// 用法：bin/bench_SortBench [元素數量=200000] [重複次數=3] [平行排序執行緒數=0（硬體執行緒數）]
+#include "../include/SortUtil.h"
+#include "../include/WorkerPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+    // 舊版實作（改版前的 SortUtil::sort），作為對照組
+    template<typename T, typename Compare>
+    int legacyPartition(std::vector<T>& arr, int low, int high, Compare comp) {
+        T pivot = arr[high];
+        int i = low - 1;
+        for (int j = low; j < high; j++) {
+            if (comp(arr[j], pivot)) {
+                i++;
+                std::swap(arr[i], arr[j]);
+            }
+        }
+        std::swap(arr[i + 1], arr[high]);
+        return i + 1;
+    }
+
+    template<typename T, typename Compare>
+    void legacyQuickSort(std::vector<T>& arr, int low, int high, Compare comp) {
+        if (low < high) {
+            int mid = low + (high - low) / 2;
+            if (comp(arr[mid], arr[low])) std::swap(arr[low], arr[mid]);
+            if (comp(arr[high], arr[low])) std::swap(arr[low], arr[high]);
+            if (comp(arr[high], arr[mid])) std::swap(arr[mid], arr[high]);
+            std::swap(arr[mid], arr[high]);
+
+            int pi = legacyPartition(arr, low, high, comp);
+            legacyQuickSort(arr, low, pi - 1, comp);
+            legacyQuickSort(arr, pi + 1, high, comp);
+        }
+    }
+
+    unsigned int nextRandom(unsigned int& state) {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    std::vector<int> makeInts(const std::string& pattern, size_t n) {
+        std::vector<int> data(n);
+        unsigned int state = 7u;
+        for (size_t i = 0; i < n; ++i) {
+            if (pattern == "random")         data[i] = static_cast<int>(nextRandom(state));
+            else if (pattern == "sorted")    data[i] = static_cast<int>(i);
+            else if (pattern == "reverse")   data[i] = static_cast<int>(n - i);
+            else if (pattern == "duplicates") data[i] = static_cast<int>(nextRandom(state) % 16);
+            else if (pattern == "organ-pipe") data[i] = static_cast<int>(i < n / 2 ? i : n - i);
+        }
+        if (pattern == "nearly-sorted") {
+            for (size_t i = 0; i < n; ++i) data[i] = static_cast<int>(i);
+            for (size_t k = 0; k < n / 100; ++k) {
+                std::swap(data[nextRandom(state) % n], data[nextRandom(state) % n]);
+            }
+        }
+        return data;
+    }
+
+    std::vector<std::string> makeStrings(const std::vector<int>& keys) {
+        std::vector<std::string> data;
+        data.reserve(keys.size());
+        for (int key : keys) {
+            data.push_back("book-title-" + std::to_string(key) + "-of-the-library-catalog");
+        }
+        return data;
+    }
+
+    template<typename T, typename Fn>
+    double timeBest(const std::vector<T>& input, int repeats, Fn sortFn, bool& ok) {
+        double best = 0.0;
+        ok = true;
+        for (int r = 0; r < repeats; ++r) {
+            std::vector<T> data = input;
+            auto start = std::chrono::steady_clock::now();
+            sortFn(data);
+            auto stop = std::chrono::steady_clock::now();
+            double ms = std::chrono::duration<double, std::milli>(stop - start).count();
+            if (r == 0 || ms < best) best = ms;
+            ok = ok && std::is_sorted(data.begin(), data.end());
+        }
+        return best;
+    }
+
+    template<typename T>
+    void runCase(const std::string& type, const std::string& pattern,
+                 const std::vector<T>& input, int repeats, size_t legacyLimit) {
+        auto less = [](const T& a, const T& b) { return a < b; };
+        bool okNew = false, okParallel = false, okStd = false, okLegacy = true;
+
+        double msNew = timeBest(input, repeats, [&](std::vector<T>& d) { SortUtil::sort(d, less); }, okNew);
+        double msParallel = timeBest(input, repeats, [&](std::vector<T>& d) { SortUtil::parallelSort(d, less); }, okParallel);
+        double msStd = timeBest(input, repeats, [&](std::vector<T>& d) { std::sort(d.begin(), d.end(), less); }, okStd);
+
+        std::cout << std::left << std::setw(8) << type << std::setw(15) << pattern << std::right
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(12) << msNew << std::setw(12) << msParallel << std::setw(12) << msStd;
+
+        // 舊版在大量重複鍵時退化為 O(n^2) 且遞迴深度為 O(n)，超過上限就不執行
+        bool degenerate = pattern == "duplicates";
+        if (input.size() <= legacyLimit || !degenerate) {
+            double msLegacy = timeBest(input, 1,
+                [&](std::vector<T>& d) { legacyQuickSort(d, 0, static_cast<int>(d.size()) - 1, less); }, okLegacy);
+            std::cout << std::setw(12) << msLegacy;
+        } else {
+            std::cout << std::setw(12) << "skipped";
+        }
+
+        std::cout << std::setw(8) << ((okNew && okParallel && okStd && okLegacy) ? "ok" : "FAIL") << "\n";
+    }
+
+    // 前 k 名：完整排序後截斷 vs. SortUtil::topK（降序，與排行榜相同）
+    void runTopKCase(const std::vector<int>& input, size_t k, int repeats) {
+        auto greater = [](int a, int b) { return a > b; };
+        double bestFull = 0.0, bestTopK = 0.0;
+        bool ok = true;
+
+        for (int r = 0; r < repeats; ++r) {
+            std::vector<int> full = input;
+            auto start = std::chrono::steady_clock::now();
+            SortUtil::sort(full, greater);
+            if (full.size() > k) full.resize(k);
+            auto mid = std::chrono::steady_clock::now();
+
+            std::vector<int> top = input;
+            auto startTopK = std::chrono::steady_clock::now();
+            SortUtil::topK(top, k, greater);
+            auto stop = std::chrono::steady_clock::now();
+
+            double msFull = std::chrono::duration<double, std::milli>(mid - start).count();
+            double msTopK = std::chrono::duration<double, std::milli>(stop - startTopK).count();
+            if (r == 0 || msFull < bestFull) bestFull = msFull;
+            if (r == 0 || msTopK < bestTopK) bestTopK = msTopK;
+            ok = ok && full == top;
+        }
+
+        std::cout << std::left << std::setw(23) << ("top-" + std::to_string(k)) << std::right
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(12) << bestFull << std::setw(12) << bestTopK
+                  << std::setw(8) << (ok ? "ok" : "FAIL") << "\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    int repeats = argc > 2 ? std::atoi(argv[2]) : 3;
+    if (repeats <= 0) repeats = 1;
+    size_t threads = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 0;
+    const size_t legacyLimit = 20000;
+    WorkerPool::shared().setThreadCount(threads);
+
+    const std::vector<std::string> patterns = {
+        "random", "sorted", "reverse", "nearly-sorted", "organ-pipe", "duplicates"
+    };
+
+    std::cout << "Elements: " << n << " (milliseconds, best of " << repeats << "), parallel threads: "
+              << WorkerPool::shared().getThreadCount() << "\n\n";
+    std::cout << std::left << std::setw(8) << "type" << std::setw(15) << "input" << std::right
+              << std::setw(12) << "SortUtil" << std::setw(12) << "parallel" << std::setw(12) << "std::sort"
+              << std::setw(12) << "legacy" << std::setw(8) << "check" << "\n";
+
+    for (const auto& pattern : patterns) {
+        runCase<int>("int", pattern, makeInts(pattern, n), repeats, legacyLimit);
+    }
+    for (const auto& pattern : patterns) {
+        runCase<std::string>("string", pattern, makeStrings(makeInts(pattern, n)), repeats, legacyLimit);
+    }
+
+    std::cout << "\n" << std::left << std::setw(23) << "random int" << std::right
+              << std::setw(12) << "full sort" << std::setw(12) << "topK" << std::setw(8) << "check" << "\n";
+    std::vector<int> randomInts = makeInts("random", n);
+    for (size_t k : {size_t(5), size_t(15), size_t(1000), n / 4}) {
+        runTopKCase(randomInts, k, repeats);
+    }
+
+    return 0;
+}
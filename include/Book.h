@@ -30,16 +30,16 @@ public:
     
     // 取值方法
     int getId() const;
-    std::string getTitle() const;
-    std::string getAuthor() const;
+    const std::string& getTitle() const;
+    const std::string& getAuthor() const;
     int getYear() const;
     int getAvailableCopies() const;
     int getTotalCopies() const;
-    std::string getIsbn() const;
-    std::string getPublisher() const;
-    std::string getLanguage() const;
+    const std::string& getIsbn() const;
+    const std::string& getPublisher() const;
+    const std::string& getLanguage() const;
     int getPageCount() const;
-    std::string getSynopsis() const;
+    const std::string& getSynopsis() const;
     const std::vector<std::string>& getCategories() const;
     
     // 設值方法
@@ -0,0 +1,47 @@
+#ifndef BOOK_CURSOR_H
+#define BOOK_CURSOR_H
+
+#include <vector>
+#include "Book.h"
+#include "CollationKey.h"
+
+class BookManager;
+
+// 搜尋游標：只保存命中表（或命中位置）與總數，分頁取用時才轉為書籍指標
+// 館藏異動後游標失效，fetch 回傳空結果
+class BookCursor {
+private:
+    const BookManager* manager;
+    unsigned long epoch;
+    mutable std::vector<char> hits;     // 以書籍在館藏中的位置為索引
+    mutable std::vector<int> ordinals;  // 命中位置（已排序）；useOrdinals 為真時取代 hits
+    mutable bool useOrdinals;
+    size_t totalCount;
+    BookSortKey sortKey;
+    bool descending;
+    mutable bool sorted;
+
+    // 循序翻頁時從上一頁結束處繼續掃描命中表
+    mutable size_t resumeOffset;
+    mutable size_t resumeOrdinal;
+
+    BookCursor(const BookManager* manager, BookSortKey sortKey, bool descending);
+    void materializeSorted() const;
+
+public:
+    BookCursor(); // 空結果
+
+    static BookCursor fromHits(const BookManager* manager, std::vector<char> hits,
+                               BookSortKey sortKey = BookSortKey::NONE, bool descending = false);
+    // ordinals 須為遞增的館藏位置
+    static BookCursor fromOrdinals(const BookManager* manager, std::vector<int> ordinals,
+                                   BookSortKey sortKey = BookSortKey::NONE, bool descending = false);
+
+    size_t getTotalCount() const;
+    bool isValid() const;
+
+    // 取出第 offset 筆開始的至多 limit 筆結果
+    std::vector<Book*> fetch(size_t offset, size_t limit) const;
+};
+
+#endif // BOOK_CURSOR_H
@@ -7,14 +7,48 @@
 #include <string>
 #include "Book.h"
 #include "QueryParser.h"
+#include "QueryProgram.h"
+#include "QueryCache.h"
+#include "BookShadow.h"
+#include "BookCursor.h"
+#include "CopyInventory.h"
 
 class BookManager {
 private:
     std::vector<Book> books;
+    std::vector<BookShadow> shadows; // 與 books 同索引的正規化欄位，供所有搜尋路徑比對
     std::unordered_map<int, int> bookIdMap; // id -> index in vector
     std::unordered_map<std::string, std::unordered_set<int>> invertedIndex; // term -> set of book ids
     std::unordered_map<std::string, std::unordered_set<int>> titleIndex; // title term -> set of book ids
     int nextId;
+    
+    // 逐冊館藏：書籍的總冊數與可借冊數由此推得，每次借還後同步回 Book
+    CopyInventory inventory;
+    void syncCopyCounts(Book& book) const;
+    
+    // 查詢結果快取：任何館藏異動都會遞增 catalogEpoch，使快取失效
+    mutable QueryCache queryCache;
+    unsigned long catalogEpoch;
+    void bumpEpoch();
+    
+    // 各排序鍵的升序排列（書籍在 books 中的位置，鍵值相同時依位置），
+    // 新增／修改／刪除時增量維護；降序時反向讀取
+    std::vector<std::vector<int>> sortPermutations;
+    bool sortKeyLess(BookSortKey key, int a, int b) const;
+    void insertIntoPermutations(int ordinal);
+    void removeFromPermutations(int ordinal, bool shiftLater);
+    void rebuildPermutations();
+    
+    // 多重排序：每本書先計算一次二進位排序鍵，再排序 (鍵, 位置)；結果依 epoch 快取最近一組規格
+    mutable std::vector<int> compositePermutation;
+    mutable std::vector<SortKeyPart> compositeSpec;
+    mutable unsigned long compositeEpoch;
+    mutable bool compositeValid;
+    std::vector<int> buildCompositePermutation(const std::vector<SortKeyPart>& spec) const;
+    
+    // 館藏數量達到門檻時，掃描切成固定大小的區塊交給共享工作池平行處理
+    static const size_t PARALLEL_SCAN_THRESHOLD = 16384;
+    static const size_t SCAN_MORSEL_SIZE = 4096;
 
     // 索引建構與維護
     void buildInvertedIndex();
@@ -30,9 +64,9 @@ private:
     std::vector<std::string> tokenize(const std::string& text) const;
     std::unordered_set<int> searchInTitle(const std::string& query) const;
     
-    // 查詢評估
-    std::unordered_set<int> evaluateFieldQuery(const std::shared_ptr<QueryNode>& node) const;
-    bool bookMatchesFieldQuery(const Book& book, const std::shared_ptr<QueryNode>& node) const;
+    // 查詢評估（回傳以書籍在 books 中的位置為索引的命中表）
+    std::vector<char> evaluateProgram(const QueryProgram& program) const;
+    std::vector<char> evaluateTerm(const std::string& term) const;
 
 public:
     BookManager();
@@ -43,8 +77,15 @@ public:
     bool deleteBook(int bookId);
     Book* getBook(int bookId);
     const Book* getBook(int bookId) const;
-    bool borrowBook(int bookId);
-    bool returnBook(int bookId);
+    // 批次檢查可借冊數（deltas：bookId -> 淨變化，歸還為正、借出為負）
+    bool canApplyCopyDeltas(const std::unordered_map<int, int>& deltas, std::vector<std::string>& errors) const;
+    
+    // 逐冊借還：barcode 為空時由空閒串列取任一可借的冊，回傳借出的條碼（失敗時為空字串）
+    std::string checkoutCopy(int bookId, const std::string& barcode = "");
+    bool releaseCopy(const std::string& barcode);
+    bool setCopyStatus(const std::string& barcode, CopyStatus status);
+    bool setCopyLocation(const std::string& barcode, const std::string& location);
+    const CopyInventory& getInventory() const;
     
     // 搜尋功能
     std::vector<Book*> searchBooks(const std::string& query) const;
@@ -52,10 +93,36 @@ public:
     std::vector<Book*> filterByCategory(const std::string& category) const;
     std::vector<Book*> advancedSearch(const std::string& query) const;
     
+    // 游標版本：不建立完整結果陣列，由呼叫端以 fetch(offset, limit) 分頁取用
+    BookCursor searchBooksCursor(const std::string& query,
+                                 BookSortKey sortKey = BookSortKey::NONE, bool descending = false) const;
+    BookCursor filterByYearCursor(int year, const std::string& op,
+                                  BookSortKey sortKey = BookSortKey::NONE, bool descending = false) const;
+    BookCursor filterByCategoryCursor(const std::string& category,
+                                      BookSortKey sortKey = BookSortKey::NONE, bool descending = false) const;
+    BookCursor advancedSearchCursor(const std::string& query,
+                                    BookSortKey sortKey = BookSortKey::NONE, bool descending = false) const;
+    
     // 資料取得
     const std::vector<Book>& getAllBooks() const;
     int getTotalBooks() const;
     std::unordered_map<std::string, int> getCategoryStats() const;
+    unsigned long getCatalogEpoch() const;
+    QueryCacheStats getQueryCacheStats() const;
+    void setQueryCacheCapacity(size_t capacity);
+    
+    // 排序後的書籍列表：直接從排列中切出一頁，不複製也不重新排序（NONE 為館藏順序）
+    const std::vector<int>& getSortPermutation(BookSortKey key) const;
+    std::vector<const Book*> getBookPage(BookSortKey key, bool descending,
+                                         size_t offset, size_t limit) const;
+    // 多重排序（例如作者、年份、書名），各欄位可分別指定方向；單一欄位時直接使用上面的排列
+    const std::vector<int>& getSortPermutation(const std::vector<SortKeyPart>& spec) const;
+    std::vector<const Book*> getBookPage(const std::vector<SortKeyPart>& spec,
+                                         size_t offset, size_t limit) const;
+    
+    // 平行掃描設定（0 = 使用硬體執行緒數）
+    void setScanThreadCount(size_t threads);
+    size_t getScanThreadCount() const;
     
     // 檔案操作
     bool loadFromFile(const std::string& filename);
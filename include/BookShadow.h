@@ -0,0 +1,25 @@
+#ifndef BOOK_SHADOW_H
+#define BOOK_SHADOW_H
+
+#include <string>
+#include <vector>
+#include "Book.h"
+
+// 書籍可搜尋欄位的正規化副本（TextUtils::normalizeForSearch），
+// 於載入與編輯時建立一次，搜尋時直接比對，不必每次轉換大小寫
+struct BookShadow {
+    std::string title;
+    std::string author;
+    std::string isbn;
+    std::string publisher;
+    std::string language;
+    std::string synopsis;
+    std::vector<std::string> categories;
+
+    static BookShadow fromBook(const Book& book);
+
+    // 與 Book::matchesKeyword 搜尋相同的欄位
+    bool containsKeyword(const std::string& normalizedKeyword) const;
+};
+
+#endif // BOOK_SHADOW_H
@@ -0,0 +1,86 @@
+#ifndef CALENDAR_UTIL_H
+#define CALENDAR_UTIL_H
+
+#include <vector>
+#include <string>
+#include <ctime>
+
+/* -----------------------------------------------------------
+ * 日曆分桶工具
+ *    - 以算術將 epoch 秒數換算為當地時間的日序／週序／月序，不必每筆呼叫 localtime
+ *    - 當地時間 = UTC + 偏移量；偏移量來自預先建立的時區轉換表（涵蓋日光節約時間）
+ *    - 日序：1970-01-01 為 0；週序：以週一為一週開始；月序：年 * 12 + 月 - 1
+ *    - DenseSeries 以連續的整數陣列保存每個序號的計數，查詢與累加皆為 O(1)
+ * ---------------------------------------------------------- */
+namespace CalendarUtil {
+
+    struct CivilDate {
+        int year;
+        int month;  // 1-12
+        int day;    // 1-31
+    };
+
+    // 西曆日期與 1970-01-01 起算日數的互換（proleptic Gregorian）
+    long long daysFromCivil(int year, int month, int day);
+    CivilDate civilFromDays(long long days);
+
+    // UTC 偏移量轉換表：記錄每次偏移量改變的 UTC 時刻，查詢為二分搜尋
+    // 建立時以每天一次的 localtime 取樣，發現改變後再二分找出確切的轉換秒數；
+    // 範圍外的時間直接呼叫 localtime
+    class OffsetTable {
+    private:
+        struct Transition {
+            long long utc;      // 自此時刻起採用 offset
+            int offset;         // 當地時間 - UTC（秒）
+        };
+
+        std::vector<Transition> transitions;
+        long long rangeBegin;
+        long long rangeEnd;
+
+        static int probe(long long t);
+
+    public:
+        OffsetTable(int firstYear, int lastYear);
+
+        int offsetAt(long long t) const;
+        size_t transitionCount() const;
+    };
+
+    // 目前時區（TZ）的轉換表，首次使用時建立（1970-2100），之後唯讀
+    const OffsetTable& localZone();
+
+    long long localSeconds(time_t t);
+    long long dayOrdinal(time_t t);
+    long long weekOrdinal(time_t t);
+    int monthOrdinal(time_t t);
+    int monthOrdinal(int year, int month);
+    CivilDate localDate(time_t t);
+
+    long long weekOfDay(long long dayOrdinal);
+    int monthOfDay(long long dayOrdinal);
+    int yearOfMonth(int monthOrdinal);
+    int monthOfMonth(int monthOrdinal);   // 1-12
+    std::string formatMonth(int monthOrdinal);    // "YYYY-MM"
+
+    // 以序號為索引的稠密計數陣列，範圍隨資料自動延伸
+    class DenseSeries {
+    private:
+        long long first;
+        std::vector<int> counts;
+
+    public:
+        DenseSeries();
+
+        void add(long long ordinal, int delta = 1);
+        int get(long long ordinal) const;
+        void clear();
+
+        bool empty() const;
+        long long firstOrdinal() const;
+        long long endOrdinal() const;     // 最後一個序號 + 1
+        const std::vector<int>& values() const;
+    };
+}
+
+#endif // CALENDAR_UTIL_H
@@ -0,0 +1,92 @@
+#ifndef CHECKOUT_STATION_H
+#define CHECKOUT_STATION_H
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include "CirculationService.h"
+#include "UserManager.h"
+
+// 自助借還站設定
+struct StationConfig {
+    std::string inputPath;      // 空字串表示標準輸入，也可以是 FIFO
+    size_t maxBatch = 1024;     // 每個微批次最多幾筆事件
+    int flushMillis = 2;        // 第一筆事件到達後最多等待多久就送出批次
+};
+
+// 執行摘要（延遲為事件讀入到結果輸出的時間，單位微秒）
+struct StationReport {
+    size_t events = 0;
+    size_t succeeded = 0;
+    size_t failed = 0;
+    size_t batches = 0;
+    size_t commitFailures = 0;
+    size_t unsaved = 0;         // 已套用到記憶體但沒有存檔的借還
+    double seconds = 0.0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double maxLatency = 0.0;
+};
+
+/* -----------------------------------------------------------
+ * 自助借還站：以非互動方式處理掃描事件
+ *    - 讀取執行緒逐行讀入事件放進佇列；處理端一次取出一個微批次
+ *      （達到 maxBatch 筆或第一筆等待超過 flushMillis）
+ *    - 事件格式（每行一筆，指令不分大小寫，空行與 # 開頭的行略過）：
+ *        USER <讀者>      開始一位讀者的工作階段（別名 U）
+ *        BORROW <條碼>    借出該冊給目前讀者（別名 ITEM、B、I）
+ *        RETURN <條碼>    歸還該冊，不需要讀者（別名 R）
+ *        END              結束工作階段（別名 E）
+ *    - 讀者、條碼、未歸還借閱都以雜湊索引解析；整批借還在同一把鎖內逐筆套用，
+ *      之後只存檔一次（group commit），存檔完成才輸出該批的結果
+ *    - 存檔重試後仍失敗：該批已套用的借還回覆 unsaved（已套用但未存檔），借還站隨即停止，
+ *      之後的事件都回覆錯誤且不再存檔，記憶體中未存檔的借還不會被之後的存檔寫入
+ *    - 每筆事件輸出一行 JSON 結果，結束時輸出一行 summary（含延遲百分位數）
+ * ---------------------------------------------------------- */
+class CheckoutStation {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct ScanEvent {
+        size_t seq;             // 行號，從 1 起算
+        std::string line;
+        Clock::time_point arrived;
+    };
+
+    CirculationService& circulation;
+    const UserManager& userManager;
+    std::function<bool()> commit;   // 持久化一次；回傳 false 表示存檔失敗
+    std::ostream& out;
+    StationConfig config;
+
+    std::deque<ScanEvent> queue;
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    bool inputDone;
+    bool halted;                    // 存檔失敗後停止套用與存檔
+
+    std::string currentUser;        // 目前工作階段的讀者，空字串表示沒有
+    std::vector<double> latencies;
+
+    void readLoop(std::istream& in);
+    bool takeBatch(std::vector<ScanEvent>& batch);
+    void processBatch(const std::vector<ScanEvent>& batch, StationReport& report);
+
+public:
+    CheckoutStation(CirculationService& circulation, const UserManager& userManager,
+                    std::function<bool()> commit, std::ostream& out, const StationConfig& config);
+
+    CheckoutStation(const CheckoutStation&) = delete;
+    CheckoutStation& operator=(const CheckoutStation&) = delete;
+
+    StationReport run(std::istream& in);
+    static void writeSummary(std::ostream& out, const StationReport& report);
+};
+
+#endif // CHECKOUT_STATION_H
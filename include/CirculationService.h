@@ -0,0 +1,89 @@
+#ifndef CIRCULATION_SERVICE_H
+#define CIRCULATION_SERVICE_H
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <ctime>
+#include "BookManager.h"
+#include "LoanManager.h"
+#include "UserManager.h"
+
+// 單本書的不一致紀錄
+struct CirculationDrift {
+    int bookId;
+    std::string title;
+    int totalCopies;
+    int availableCopies;
+    int loggedActive;       // 借閱紀錄中未歸還的筆數
+    int indexedActive;      // 未歸還借閱索引中的筆數
+    int loggedBorrows;      // 借閱紀錄（含封存摘要）中的總借閱次數
+    int countedBorrows;     // 借閱統計中的總借閱次數
+    int copyRecords;        // 逐冊館藏的冊數
+    int copiesOnLoan;       // 逐冊館藏中借出中的冊數
+};
+
+// 一致性檢查結果
+struct CirculationAudit {
+    size_t booksChecked;
+    size_t loansChecked;
+    size_t activeLoans;
+    size_t orphanLoans;                         // 借閱紀錄指向已不在館藏中的書
+    std::vector<CirculationDrift> drifts;       // 依 bookId 排序
+    std::vector<std::string> userMismatches;    // 讀者的未歸還筆數與索引不符
+    bool dueIndexMismatch;                      // 到期日索引的筆數與未歸還筆數不符
+    double milliseconds;
+
+    bool ok() const;
+};
+
+// 逐筆套用的結果
+struct CirculationResult {
+    bool ok;
+    std::string error;      // 失敗原因，多項時以「；」連接
+    int bookId;
+    std::string username;
+    std::string barcode;    // 借出／歸還的冊
+    time_t dueDate;
+    double fine;            // 歸還時的逾期罰款
+};
+
+/* -----------------------------------------------------------
+ * 借還流通服務：同時負責館藏與借閱兩側
+ *    - 每次借出／歸還在同一把鎖內更新逐冊館藏、未歸還借閱索引與借閱統計，
+ *      整批先檢查再套用，任何一筆不可行就整批不套用；借出時配給一冊並記在借閱紀錄上，
+ *      歸還可只掃描條碼
+ *    - 不變式：每本書 總冊數 = 冊數，可借冊數 = 在架冊數，借出中冊數 = 未歸還借閱筆數，
+ *      總冊數 - 可借冊數 = 未歸還借閱筆數 + 維修／遺失冊數
+ *    - applyEach() 在同一把鎖內逐筆檢查並套用，每筆各自成功或失敗（自助借還站的微批次）
+ *    - verify() 平行掃描全部借閱紀錄，與逐冊館藏、索引、統計逐項比對並回報不一致
+ *    - reconcileCopies() 依未歸還借閱校正各冊的借出狀態，舊紀錄沒有條碼時依借出順序配給
+ * ---------------------------------------------------------- */
+class CirculationService {
+private:
+    BookManager& bookManager;
+    LoanManager& loanManager;
+    const UserManager* userManager;     // 為 nullptr 時不檢查讀者是否存在
+    mutable std::mutex mutex;
+
+    // 須持有 mutex；touched 不為 nullptr 時回傳每筆作業借出／歸還的紀錄
+    bool applyLocked(const std::vector<CirculationOp>& ops, time_t now,
+                     std::vector<std::string>& errors, std::vector<LoanRecord*>* touched);
+
+public:
+    CirculationService(BookManager& bookManager, LoanManager& loanManager,
+                       const UserManager* userManager = nullptr);
+
+    CirculationService(const CirculationService&) = delete;
+    CirculationService& operator=(const CirculationService&) = delete;
+
+    bool borrow(const std::string& username, int bookId, std::vector<std::string>& errors);
+    bool giveBack(const std::string& username, int bookId, std::vector<std::string>& errors);
+    bool apply(const std::vector<CirculationOp>& ops, std::vector<std::string>& errors);
+    std::vector<CirculationResult> applyEach(const std::vector<CirculationOp>& ops);
+
+    CirculationAudit verify() const;
+    size_t reconcileCopies();   // 回傳校正的書籍數
+};
+
+#endif // CIRCULATION_SERVICE_H
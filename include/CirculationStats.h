@@ -0,0 +1,91 @@
+#ifndef CIRCULATION_STATS_H
+#define CIRCULATION_STATS_H
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <map>
+#include <ctime>
+#include "LoanRecord.h"
+#include "CalendarUtil.h"
+
+// 一段借閱紀錄的彙總（例如封存區段的摘要）：不讀回紀錄即可併入統計
+struct LoanSummary {
+    size_t loans = 0;
+    size_t returns = 0;
+    time_t minDate = 0;     // 最早／最晚的借出時間
+    time_t maxDate = 0;
+    std::unordered_map<int, int> bookBorrows;
+    std::unordered_map<std::string, int> userBorrows;
+    std::map<long long, int> dailyBorrows;  // 日序 -> 借出次數
+    std::map<long long, int> dailyReturns;  // 日序 -> 歸還次數
+    // 讀者 -> (逾期天數 -> 筆數)；存天數而非金額，罰款依當下的罰款政策計算
+    std::unordered_map<std::string, std::map<int, int>> userOverdueDays;
+
+    void add(const LoanRecord& loan);
+};
+
+/* -----------------------------------------------------------
+ * 借閱統計（物化彙總）
+ *    - 每本書、每位讀者、每個分類、每個月份的借閱次數，借出／歸還時 O(1) 更新
+ *    - 每月／每週／每日借閱次數以 CalendarUtil 的序號為索引存於稠密陣列，
+ *      歸還另計於歸還月份
+ *    - 分類計數由每本書的借閱次數推得：書籍分類變更時只移動該書的次數，
+ *      不必重新掃描借閱紀錄；不在館藏中的書不計入任何分類
+ *    - rebuild() 由完整借閱紀錄重新計算書籍／讀者／月份計數，分類沿用已登記的對應
+ *    - addSummary() 併入已封存紀錄的彙總；週／月序列由日序推得，與逐筆計數結果相同
+ * ---------------------------------------------------------- */
+class CirculationStats {
+public:
+    static const char* const UNCATEGORIZED; // 沒有分類的書計入此項
+
+private:
+    std::unordered_map<int, int> bookBorrows;
+    std::unordered_map<std::string, int> userBorrows;
+    std::unordered_map<std::string, int> categoryBorrows;
+    CalendarUtil::DenseSeries monthlyBorrows;
+    CalendarUtil::DenseSeries weeklyBorrows;
+    CalendarUtil::DenseSeries dailyBorrows;
+    CalendarUtil::DenseSeries monthlyReturns;
+    std::unordered_map<int, std::vector<std::string>> bookCategories; // bookId -> 計數用的分類
+    long long totalBorrows;
+    long long totalReturns;
+
+    void addToCategories(const std::vector<std::string>& categories, int delta);
+    void countBorrow(const LoanRecord& loan);
+
+public:
+    CirculationStats();
+
+    // 增量維護
+    void recordBorrow(const LoanRecord& loan);
+    void recordReturn(const LoanRecord& loan);
+    void rebuild(const std::deque<LoanRecord>& loans);
+    void addSummary(const LoanSummary& summary);
+    void clear();
+
+    // 書籍分類對應（新增／編輯書籍時更新，刪除書籍時移除）
+    void setBookCategories(int bookId, const std::vector<std::string>& categories);
+    void removeBook(int bookId);
+
+    // O(1) 查詢
+    int getBookBorrows(int bookId) const;
+    int getUserBorrows(const std::string& username) const;
+    int getCategoryBorrows(const std::string& category) const;
+    int getMonthBorrows(int year, int month) const;
+    int getMonthReturns(int year, int month) const;
+    long long getTotalBorrows() const;
+    long long getTotalReturns() const;
+
+    // 完整彙總（供排行榜、圖表使用）
+    const std::unordered_map<int, int>& getBookCounts() const;
+    const std::unordered_map<std::string, int>& getUserCounts() const;
+    const std::unordered_map<std::string, int>& getCategoryCounts() const;
+    const CalendarUtil::DenseSeries& getMonthlyBorrows() const;  // 以月序為索引
+    const CalendarUtil::DenseSeries& getWeeklyBorrows() const;   // 以週序為索引
+    const CalendarUtil::DenseSeries& getDailyBorrows() const;    // 以日序為索引
+    const CalendarUtil::DenseSeries& getMonthlyReturns() const;
+};
+
+#endif // CIRCULATION_STATS_H
@@ -0,0 +1,39 @@
+#ifndef COLLATION_KEY_H
+#define COLLATION_KEY_H
+
+#include <string>
+#include <vector>
+
+class Book;
+struct BookShadow;
+
+// 排序鍵欄位（編號與書籍列表的排序選項一致）
+enum class BookSortKey {
+    NONE,
+    TITLE,
+    AUTHOR,
+    YEAR,
+    PAGES
+};
+
+// 多重排序中的一個欄位及其方向
+struct SortKeyPart {
+    BookSortKey field;
+    bool descending;
+};
+
+/* -----------------------------------------------------------
+ * 二進位排序鍵：每本書只計算一次，之後以位元組比較（memcmp 語意）即可排序
+ *    - 字串：使用正規化副本（大小寫、全形半形視為相同），其餘依 Unicode 碼位；
+ *      中文字在 CJK 統一表意文字區中依部首、筆畫排列
+ *      0x00 轉義為 0x00 0xFF，並以 0x00 0x00 結尾，多個欄位串接後仍保持順序
+ *    - 整數：翻轉符號位元後以大端序寫入
+ *    - 降序欄位：將該欄位的所有位元組取反
+ * ---------------------------------------------------------- */
+namespace CollationKey {
+    void appendString(std::string& key, const std::string& normalized, bool descending);
+    void appendInt(std::string& key, int value, bool descending);
+    std::string forBook(const Book& book, const BookShadow& shadow, const std::vector<SortKeyPart>& spec);
+}
+
+#endif // COLLATION_KEY_H
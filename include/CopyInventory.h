@@ -0,0 +1,90 @@
+#ifndef COPY_INVENTORY_H
+#define COPY_INVENTORY_H
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+// 單冊狀態
+enum class CopyStatus : unsigned char {
+    AVAILABLE,  // 在架可借
+    ON_LOAN,    // 借出中
+    REPAIR,     // 維修中，不可借
+    LOST        // 遺失，不可借
+};
+
+// 單冊紀錄：同一本書的所有冊以陣列連續存放，可借的冊另以雙向鏈結串成空閒串列
+struct BookCopy {
+    std::string barcode;
+    std::string location;
+    CopyStatus status;
+    int prevFree;   // 空閒串列中的前一冊（陣列位置，-1 表示無）
+    int nextFree;
+};
+
+/* -----------------------------------------------------------
+ * 逐冊館藏
+ *    - 每本書一個 BookCopy 陣列，可借的冊串成空閒串列：借出時取串列開頭，
+ *      指定條碼借出或歸還時依陣列位置直接摘除／插入，皆為 O(1)
+ *    - 條碼 -> (bookId, 陣列位置) 雜湊索引：歸還掃描條碼時不必逐本搜尋
+ *    - 每本書另記可借與借出中的冊數，查詢 O(1)
+ *    - 條碼預設格式 B<六位書號>-<三位流水號>，例如 B000012-003
+ * ---------------------------------------------------------- */
+class CopyInventory {
+public:
+    struct CopyRef {
+        int bookId;
+        int index;
+    };
+
+private:
+    struct CopyList {
+        std::vector<BookCopy> copies;
+        int freeHead;
+        int available;
+        int onLoan;
+        int nextSerial;
+    };
+
+    std::unordered_map<int, CopyList> lists;
+    std::unordered_map<std::string, CopyRef> barcodeIndex;
+
+    CopyList& listFor(int bookId);
+    void pushFree(CopyList& list, int index);
+    void unlinkFree(CopyList& list, int index);
+    void changeStatus(CopyList& list, int index, CopyStatus status);
+    void eraseCopy(int bookId, CopyList& list, int index);
+    std::string nextBarcode(int bookId, CopyList& list);
+    BookCopy* resolve(const std::string& barcode, CopyList** list = nullptr);
+
+public:
+    static std::string makeBarcode(int bookId, int serial);
+    static const char* statusName(CopyStatus status);   // 存檔用的英文代碼
+    static const char* statusLabel(CopyStatus status);  // 顯示用
+    static bool parseStatus(const std::string& name, CopyStatus& status);
+
+    // 建立／調整
+    bool addCopy(int bookId, const std::string& barcode, CopyStatus status = CopyStatus::AVAILABLE,
+                 const std::string& location = "");     // 條碼重複時回傳 false
+    int resize(int bookId, int total);  // 增加時產生新條碼；減少時只移除可借的冊，回傳調整後的冊數
+    void removeBook(int bookId);
+    void clear();
+
+    // 借出／歸還
+    std::string checkout(int bookId);               // 取任一可借的冊，沒有時回傳空字串
+    bool checkout(const std::string& barcode);      // 指定條碼，須為可借狀態
+    bool release(const std::string& barcode);       // 借出中 -> 可借
+    bool setStatus(const std::string& barcode, CopyStatus status);  // 借出中的冊只能經由 release 變更
+    bool setLocation(const std::string& barcode, const std::string& location);
+
+    // 查詢
+    bool find(const std::string& barcode, CopyRef& ref) const;
+    const BookCopy* findCopy(const std::string& barcode) const;
+    const std::vector<BookCopy>& getCopies(int bookId) const;
+    int copyCount(int bookId) const;
+    int availableCount(int bookId) const;
+    int onLoanCount(int bookId) const;
+    size_t totalCopies() const;
+};
+
+#endif // COPY_INVENTORY_H
@@ -1,12 +1,21 @@
 #ifndef FINE_POLICY_H
 #define FINE_POLICY_H
 
+#include <vector>
+#include <memory>
+
 class FinePolicy {
 private:
     int graceDays;    // Days before fines start
     double fixedRate;    // Fixed fine amount per day
     double incrementalFactor; // Incremental factor for increasing fines
 
+    // 目前政策的罰款前綴表：fineTable[n] 為計費 n 天的罰款，超過表長改用封閉形式
+    // 政策變更時重建；以 shared_ptr 共用，複製政策不必複製整張表
+    static const int TABLE_DAYS = 1024;
+    std::shared_ptr<const std::vector<double>> fineTable;
+    void rebuildTable();
+
 public:
     FinePolicy();
     FinePolicy(int graceDays, double fixedRate, double incrementalFactor);
@@ -22,7 +31,12 @@ public:
     void setIncrementalFactor(double factor);
     
     // Calculate fine amount
-    double calculateFine(int overdueDays) const;
+    double calculateFine(int overdueDays) const;              // 查表，超出範圍時用封閉形式
+    double calculateFineClosedForm(int overdueDays) const;    // 等比級數公式 O(1)
+    double calculateFineIterative(int overdueDays) const;     // 逐日累加（原始定義，供比對）
+    
+    // 批次計算：fines[i] 對應 overdueDays[i]
+    void calculateFines(const std::vector<int>& overdueDays, std::vector<double>& fines) const;
     
     // Display policy
     void display() const;
@@ -9,6 +9,8 @@
 #include "UserManager.h"
 #include "LoanManager.h"
 #include "RecommendationEngine.h"
+#include "CirculationService.h"
+#include "CheckoutStation.h"
 #include "FinePolicy.h"
 
 class Library {
@@ -17,11 +19,16 @@ private:
     UserManager userManager;
     LoanManager loanManager;
     RecommendationEngine recommendationEngine;
+    CirculationService circulation;     // 借還一律經由此服務，保持可借冊數與借閱紀錄一致
     
     // 檔案路徑
     std::string bookFile;
     std::string userFile;
     std::string loanFile;
+    std::string loanEventFile;  // 到期提醒／逾期事件 outbox
+    static const int LOAN_EVENT_INTERVAL_SECONDS = 60;
+    static std::string deriveLoanEventFile(const std::string& loanFile);
+    static std::string deriveLoanArchiveDirectory(const std::string& loanFile);
     
     // 輔助結構
     struct BookInfo {
@@ -32,6 +39,7 @@ private:
     // 核心初始化和運行邏輯
     void createDataDirectory();
     void loadAllData();
+    void startLoanEventScheduler();
     bool performLogin();
     void runMainLoop();
     
@@ -61,12 +69,12 @@ private:
     void viewBookDetails();
     BookInfo getBookInfoFromUser();
     void addBookCategories(Book& book);
-    std::vector<Book*> performSearch(int searchType);
-    std::vector<Book*> searchByYear();
-    void displaySearchResults(const std::vector<Book*>& results);
+    BookCursor performSearch(int searchType);
+    BookCursor searchByYear();
+    void displaySearchResults(const BookCursor& results);
     void displayBookSummary(const Book* book);
     void displayBookSummaryDetailed(const Book* book);
-    void offerBookDetails(const std::vector<Book*>& results);
+    void offerBookDetails();
     
     // 書籍詳細資訊顯示
     void displayBookDetailsHeader(const Book* book);
@@ -90,17 +98,17 @@ private:
     
     // 書籍列表功能
     void viewBookList();
-    void displayBookPage(const std::vector<Book>& books, int page, int booksPerPage,
+    void displayBookPage(const std::vector<const Book*>& pageBooks, int startIndex, size_t totalBooks,
                         int currentSortField, int currentSortOrder);
     bool handleBookListNavigation(int choice, int& currentPage, int totalPages, 
-                                 const std::vector<Book>& books, 
                                  const std::vector<std::string>& navOptions,
                                  int& currentSortField, int& currentSortOrder);
     void jumpToPage(int& currentPage, int totalPages);
     void viewBookDetailsFromList();
     
-    // 排序輔助函數
-    void applySorting(std::vector<Book>& books, int sortField, int sortOrder);
+    // 排序輔助函數（MULTI_SORT_FIELD 為依作者、年份、書名的多重排序）
+    static const int MULTI_SORT_FIELD = 5;
+    std::vector<SortKeyPart> getSortSpec(int currentSortField, int currentSortOrder);
     std::string getSortArrow(int currentSortField, int currentSortOrder, int fieldId);
     void showSortMenu(int& currentSortField, int& currentSortOrder);
     void setSortField(int& currentSortField, int& currentSortOrder, int newField);
@@ -114,7 +122,7 @@ private:
         size_t pagesWidth;
         size_t statusWidth;
     };
-    ColumnWidths calculateColumnWidths(const std::vector<Book>& books, int startIndex, int endIndex);
+    ColumnWidths calculateColumnWidths(const std::vector<const Book*>& books);
     
     // 中文字符顯示寬度處理
     size_t getDisplayWidth(const std::string& str);
@@ -123,12 +131,13 @@ private:
     // 借閱操作
     void borrowBook();
     void returnBook();
+    void circulationCart();
     void displayUserLoans();
     void displayOverdueLoans();
     
     // 借閱輔助方法
-    std::vector<Book> getAvailableBooks();
-    void displayAvailableBooks(const std::vector<Book>& books);
+    std::vector<const Book*> getAvailableBooks();
+    void displayAvailableBooks(const std::vector<const Book*>& books);
     int getBookIdChoice(const std::string& prompt);
     std::string getBorrowerUsername();
     std::string getTargetUserForReturn();
@@ -138,12 +147,22 @@ private:
     void displayLoanRecord(const LoanRecord* loan, const Book* book, bool showUsername);
     void showFineIfAny(const std::string& username, int bookId);
     
+    // 借還交易：交由 CirculationService 整批檢查並套用，完成後存檔一次
+    bool commitCirculation(const std::vector<CirculationOp>& ops, std::vector<std::string>& errors);
+    bool runCirculation(const std::vector<CirculationOp>& ops);   // 失敗時顯示錯誤訊息
+    void displayCart(const std::vector<CirculationOp>& cart);
+    void addBorrowToCart(std::vector<CirculationOp>& cart, const std::string& username);
+    void addReturnToCart(std::vector<CirculationOp>& cart, const std::string& username);
+    void removeFromCart(std::vector<CirculationOp>& cart);
+    
     // 編輯圖書輔助方法
     void runEditMenu(Book& book);
     std::vector<std::string> createEditOptions(const Book& book);
     void editBookField(Book& book, int field);
     void updateBookCopies(Book& book);
     void manageBookCategories(Book& book);
+    void manageBookCopies(Book& book);
+    void displayBookCopies(int bookId);
     void displayCurrentCategories(const Book& book);
     void removeCategoryFromBook(Book& book);
     bool saveBookChanges(Book& book);
@@ -189,12 +208,18 @@ private:
     // 逾期圖書輔助方法
     void displayReaderOverdueLoans(const std::vector<LoanRecord*>& overdueLoans);
     void displayAllOverdueLoans(const std::vector<LoanRecord*>& overdueLoans);
+    void showLoansDueSoon(bool currentUserOnly);
     
     // 統計功能
     void showStatistics();
     void showBorrowStats();
     void showCategoryStats();
     void showMonthlyStats();
+    void showQueryCacheStats();
+    void showCirculationAudit();
+    void showLoanArchive();
+    void displayLoanArchive();
+    void displayCirculationAudit(const CirculationAudit& audit);
     
     // 統計輔助方法
     void showQuickStatsSummary();
@@ -225,6 +250,8 @@ public:
     
     // 主要進入點
     void run();
+    // 自助借還站模式：不登入、不顯示選單，讀取掃描事件直到輸入結束；回傳程式結束碼
+    int runStation(const StationConfig& config);
     
     // 儲存所有資料
     bool saveAllData() const;
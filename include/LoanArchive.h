@@ -0,0 +1,77 @@
+#ifndef LOAN_ARCHIVE_H
+#define LOAN_ARCHIVE_H
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <map>
+#include <ctime>
+#include "LoanRecord.h"
+#include "CirculationStats.h"
+
+// 一個封存區段：同一個借出月份的一批已歸還紀錄，寫入後不再修改
+struct ArchiveSegment {
+    std::string file;       // 相對於封存目錄的檔名
+    int month;              // 分區：借出月份的月序（CalendarUtil::monthOrdinal）
+    size_t bytes;
+    LoanSummary summary;
+};
+
+/* -----------------------------------------------------------
+ * 借閱歷史封存（冷資料層）
+ *    - 已歸還且歸還時間早於水位的紀錄依借出月份寫成區段檔，每次封存都寫新檔，
+ *      既有區段不會被改寫
+ *    - manifest.json 記錄水位與每個區段的摘要（借出時間範圍、每本書／每位讀者／每日計數、
+ *      每位讀者的逾期天數）；啟動時只讀 manifest，統計與罰款直接併入摘要
+ *    - 區段只在需要明細時才開啟，並先依摘要略過不相關的區段
+ *    - 水位：歸還時間早於 archivedBefore 的紀錄都已封存；載入熱資料時據此剔除
+ *      封存後尚未寫回 loans.json 的重複紀錄
+ *    - 區段檔以 LoanCodec 編碼（.lhb）；較早寫成的精簡 JSON 區段（.json）仍可讀取
+ * ---------------------------------------------------------- */
+class LoanArchive {
+private:
+    std::string directory;
+    std::vector<ArchiveSegment> segments;
+    time_t archivedBefore;
+    std::unordered_map<int, int> bookTotals;    // 所有區段合計的每本書借閱次數
+    std::unordered_map<std::string, std::map<int, int>> overdueTotals;  // 所有區段合計的讀者逾期天數
+    size_t loanTotal;
+    mutable size_t segmentsOpened;
+
+    std::string pathOf(const std::string& file) const;
+    bool ensureDirectory() const;
+    bool writeManifest() const;
+    bool writeSegment(const std::string& file, const std::vector<const LoanRecord*>& loans, size_t& bytes) const;
+    bool readSegmentData(const ArchiveSegment& segment, std::string& data) const;
+    bool parseJsonSegment(const std::string& data, std::vector<LoanRecord>& loans) const;
+    void addTotals(const ArchiveSegment& segment);
+
+public:
+    LoanArchive();
+
+    void setDirectory(const std::string& directory);
+    const std::string& getDirectory() const;
+    bool load();    // 只讀取 manifest；目錄或 manifest 不存在時視為空的封存
+    void clear();
+
+    // 寫入新區段並把水位推進到 cutoff；loans 須全部已歸還且歸還時間早於 cutoff
+    bool append(const std::vector<const LoanRecord*>& loans, time_t cutoff);
+    bool isArchived(const LoanRecord& loan) const;
+    time_t getArchivedBefore() const;
+
+    // 摘要（不開啟區段）
+    const std::vector<ArchiveSegment>& getSegments() const;
+    const std::unordered_map<int, int>& getBookCounts() const;
+    const std::map<int, int>* getOverdueDays(const std::string& username) const;  // 逾期天數 -> 筆數，沒有時為 nullptr
+    size_t getLoanCount() const;
+    size_t getByteCount() const;
+    size_t getSegmentsOpened() const;
+
+    // 明細（依摘要挑出相關區段後才開啟）
+    bool readSegment(const ArchiveSegment& segment, std::vector<LoanRecord>& loans) const;
+    std::vector<LoanRecord> loansForUser(const std::string& username) const;
+    std::vector<LoanRecord> loansForBook(int bookId) const;
+    std::vector<LoanRecord> loansBorrowedBetween(time_t from, time_t to) const;
+};
+
+#endif // LOAN_ARCHIVE_H
@@ -0,0 +1,77 @@
+#ifndef LOAN_CODEC_H
+#define LOAN_CODEC_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <ctime>
+#include "LoanRecord.h"
+
+/* -----------------------------------------------------------
+ * 借閱紀錄的二進位編碼（封存區段使用）
+ *    - 紀錄依 (讀者, 借出時間, 書籍 ID) 排序；讀者名稱依字典順序編成字典，紀錄只存位置差
+ *    - 整數皆為 LEB128 varint；可能為負的差值先做 zigzag
+ *    - 借出時間存與上一筆的差（換讀者時改與區段最早借出時間相差），
+ *      借期存與上一筆借期的差，歸還時間存與借出時間的差
+ *    - 條碼為 CopyInventory::makeBarcode(bookId, 序號) 的形式時只存序號
+ *
+ *    格式：
+ *      "LHB1"
+ *      varint 讀者數，每位：varint 長度 + 位元組
+ *      varint 紀錄數，zigzag 最早借出時間
+ *      每筆：varint 讀者位置差、zigzag 借出時間差、varint bookId、
+ *            1 位元組旗標（bit0-1 條碼型式：0 無／1 序號／2 原字串；bit2 已歸還）、
+ *            zigzag 借期差、[zigzag 歸還 - 借出]、[varint 序號 | varint 長度 + 條碼]
+ * ---------------------------------------------------------- */
+namespace LoanCodec {
+
+    // 解碼出的一筆紀錄；讀者以字典位置表示，需要時再轉成 LoanRecord
+    struct Entry {
+        uint32_t user = 0;
+        int bookId = 0;
+        time_t borrowDate = 0;
+        time_t dueDate = 0;
+        time_t returnDate = 0;      // 0 表示未歸還
+        int barcodeSerial = 0;      // 條碼為標準形式時的冊序號，0 表示沒有
+        std::string rawBarcode;     // 非標準形式的條碼
+    };
+
+    std::string encode(const std::vector<const LoanRecord*>& loans);
+    bool isEncoded(const std::string& data);
+    bool decode(const std::string& data, std::vector<LoanRecord>& loans);
+
+    // 串流解碼：一次解出一筆，不建立整個紀錄陣列；data 須在 Reader 使用期間保持有效
+    class Reader {
+    private:
+        const unsigned char* cursor;
+        const unsigned char* end;
+        std::vector<std::string> users;
+        size_t total;
+        size_t decoded;
+        bool failed;
+
+        // 差分解碼的狀態
+        uint32_t user;
+        time_t base;
+        time_t borrow;
+        time_t dueSpan;
+
+        bool readVarint(uint64_t& value);
+        bool readSigned(int64_t& value);
+        bool fail();
+
+    public:
+        explicit Reader(const std::string& data);
+
+        bool next(Entry& entry);        // 沒有下一筆或資料損毀時回傳 false
+        LoanRecord toRecord(const Entry& entry) const;
+
+        size_t size() const;            // 紀錄總數
+        size_t remaining() const;
+        bool ok() const;                // 表頭與已讀取的紀錄都完整
+        const std::vector<std::string>& getUsers() const;
+        int64_t findUser(const std::string& username) const;   // 字典位置，不存在時為 -1
+    };
+}
+
+#endif // LOAN_CODEC_H
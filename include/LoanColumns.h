@@ -0,0 +1,82 @@
+#ifndef LOAN_COLUMNS_H
+#define LOAN_COLUMNS_H
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include <ctime>
+#include "LoanRecord.h"
+
+/* -----------------------------------------------------------
+ * 借閱紀錄的欄式儲存（與 LoanManager 的 loans 同列序，只含熱資料）
+ *    - 每個欄位是一條連續的 int32 陣列：書籍序號、讀者序號、借出／到期／歸還時間、借出日序
+ *    - 書籍 ID 與讀者名稱以字典編成從 0 起算的序號，分組計數直接以序號索引稠密陣列
+ *    - 時間存為相對 2000-01-01 UTC 的秒數（約 1931 至 2068 年，範圍外截斷），
+ *      未歸還的歸還時間為 NOT_RETURNED，任何區間條件都不會命中
+ *    - 彙總核心以固定長度的區塊處理：區塊內只做比較與加總、沒有分支，
+ *      編譯器在 -O2 就能向量化；分組時再依區塊的命中遮罩累加
+ * ---------------------------------------------------------- */
+class LoanColumns {
+public:
+    static const int32_t NOT_RETURNED = INT32_MIN;
+    static const time_t EPOCH = 946684800;  // 2000-01-01 00:00:00 UTC
+
+    static int32_t encodeTime(time_t t);
+    static time_t decodeTime(int32_t value);
+
+private:
+    std::vector<int32_t> bookColumn;
+    std::vector<int32_t> userColumn;
+    std::vector<int32_t> borrowColumn;
+    std::vector<int32_t> dueColumn;
+    std::vector<int32_t> returnColumn;
+    std::vector<int32_t> borrowDayColumn;   // CalendarUtil::dayOrdinal(借出時間)
+
+    std::vector<int> bookIds;                       // 序號 -> bookId
+    std::unordered_map<int, int32_t> bookOrdinals;
+    std::vector<std::string> usernames;             // 序號 -> 讀者
+    std::unordered_map<std::string, int32_t> userOrdinals;
+
+    int32_t internBook(int bookId);
+    int32_t internUser(const std::string& username);
+
+    // 命中 [from, to) 的列，依序回呼 visit(row)
+    template<typename Visit>
+    void forEachInRange(const std::vector<int32_t>& column, int32_t from, int32_t to, Visit visit) const;
+
+public:
+    // 維護（由 LoanManager 在借出、歸還、載入、封存時呼叫）
+    size_t append(const LoanRecord& loan);  // 回傳新列的列號
+    void setReturnDate(size_t row, time_t returnDate);
+    void rebuild(const std::deque<LoanRecord>& loans);
+    void clear();
+
+    size_t size() const;
+    size_t bookCount() const;
+    size_t userCount() const;
+    int32_t bookOrdinal(int bookId) const;                  // 不存在時為 -1
+    int32_t userOrdinal(const std::string& username) const;
+    int bookIdAt(int32_t ordinal) const;
+    const std::string& usernameAt(int32_t ordinal) const;
+
+    // 原始欄位（供另外撰寫的核心使用）
+    const std::vector<int32_t>& books() const;
+    const std::vector<int32_t>& users() const;
+
+    // 計數：時間區間皆為 [from, to)
+    size_t countBorrowedBetween(time_t from, time_t to) const;
+    size_t countReturnedBetween(time_t from, time_t to) const;
+    size_t countOverdue(time_t asOf) const;     // 未歸還且到期時間早於 asOf
+
+    // 篩選：回傳列號
+    std::vector<uint32_t> rowsBorrowedBetween(time_t from, time_t to) const;
+
+    // 分組計數：以書籍／讀者序號為索引；以日序分組時索引為 dayOrdinal - firstDay
+    std::vector<int> borrowsByBook(time_t from, time_t to) const;
+    std::vector<int> borrowsByUser(time_t from, time_t to) const;
+    std::vector<int> borrowsByDay(long long firstDay, int days) const;
+};
+
+#endif // LOAN_COLUMNS_H
@@ -2,52 +2,166 @@
 #define LOAN_MANAGER_H
 
 #include <vector>
+#include <deque>
+#include <map>
 #include <unordered_map>
 #include <string>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 #include "LoanRecord.h"
+#include "TimingWheel.h"
+#include "CirculationStats.h"
+#include "LoanArchive.h"
+#include "LoanColumns.h"
 #include "FinePolicy.h"
 #include "Book.h"
 #include "BookManager.h"
 
+// 批次借還的單筆作業；有條碼時指定該冊，歸還可只給條碼
+struct CirculationOp {
+    enum class Type { BORROW, RETURN };
+    Type type;
+    std::string username;
+    int bookId;
+    std::string barcode = "";
+};
+
 class LoanManager {
 private:
-    std::vector<LoanRecord> loans;
+    std::deque<LoanRecord> loans; // deque：新增紀錄時既有紀錄的位址不變，索引中的指標保持有效
     std::unordered_map<int, std::vector<LoanRecord*>> bookLoans;    // bookId -> loans
     std::unordered_map<std::string, std::vector<LoanRecord*>> userLoans; // username -> loans
     FinePolicy finePolicy;
 
+    // 未歸還借閱索引：username -> bookId -> 借閱紀錄（依借出順序，通常只有一筆）
+    // 借出／歸還時增量維護，查詢與歸還不必掃描借閱歷史
+    std::unordered_map<std::string, std::unordered_map<int, std::vector<LoanRecord*>>> activeLoans;
+    std::unordered_map<std::string, int> activeCountByUser;
+    std::unordered_map<int, int> activeCountByBook;
+    // 未歸還借閱依到期日排序：逾期查詢為前綴範圍，即將到期為區間查詢；歸還時移除
+    std::multimap<time_t, LoanRecord*> dueIndex;
+    // 條碼 -> 未歸還借閱：掃描歸還時直接找到紀錄
+    std::unordered_map<std::string, LoanRecord*> activeByBarcode;
+    void indexActiveLoan(LoanRecord* loan);
+    void unindexActiveLoan(LoanRecord* loan);
+    void rebuildIndexes();
+
+    // 物化的借閱統計：借出／歸還時增量更新，載入時由借閱紀錄重建，再併入封存區段的摘要
+    CirculationStats stats;
+
+    // 欄式副本：與 loans 同列序，借出時附加一列、歸還時更新該列；近期活動等彙總直接掃描欄位
+    LoanColumns columns;
+    std::unordered_map<const LoanRecord*, size_t> columnRows;
+
+    // 冷資料層：歸還超過 archiveHorizonDays 天的紀錄移入封存區段，loans 只保留熱資料（0 表示停用）
+    LoanArchive archive;
+    int archiveHorizonDays;
+
+    // 到期提醒與逾期事件：依到期日排入階層式時間輪，由排程執行緒推進並以一行一筆 JSON 寫入 outbox 檔
+    // outbox 未設定時不排程；上次處理到的時間記在 <outbox>.state，重新啟動時補發離線期間的事件
+    struct DueEvent {
+        std::string type;           // "reminder" 或 "overdue"
+        const LoanRecord* loan;
+        std::string username;
+        int bookId;
+        time_t dueDate;
+    };
+    TimingWheel dueWheel;
+    std::unordered_map<unsigned long, DueEvent> dueEvents;  // 歸還時移除，對應的計時器觸發時直接略過
+    std::unordered_map<const LoanRecord*, std::vector<unsigned long>> loanTimers;
+    unsigned long nextTimerId;
+    std::string outboxFile;
+    time_t reminderLeadSeconds;
+    std::mutex schedulerMutex;      // 保護上述事件狀態；排程執行緒不會讀取 loans
+    std::condition_variable schedulerWake;
+    std::thread schedulerThread;
+    bool schedulerStopping;
+    void resetDueEvents();
+    void scheduleDueEvents(const LoanRecord* loan);
+    void cancelDueEvents(const LoanRecord* loan);
+    void addDueTimer(const std::string& type, const LoanRecord* loan, time_t deadline); // 須持有 schedulerMutex
+    time_t readLastEventRun() const;
+    void schedulerLoop(int intervalSeconds);
+
 public:
     LoanManager();
     LoanManager(const std::string& filename);
+    ~LoanManager();
+
+    LoanManager(const LoanManager&) = delete;
+    LoanManager& operator=(const LoanManager&) = delete;
 
     void setFilename(const std::string& filename);
 
     // 借閱操作
     bool borrowBook(const std::string& username, int bookId, int graceDays = 0);
     bool returnBook(const std::string& username, int bookId);
+    bool borrowBook(const std::string& username, int bookId, time_t now, int graceDays,
+                    const std::string& barcode = "");
+    bool returnBook(const std::string& username, int bookId, time_t now);
+    bool returnLoan(LoanRecord* loan, time_t now);
     bool extendLoan(const std::string& username, int bookId, int days);
+    
+    // 批次借還檢查：每筆歸還對應到一筆不重複的未歸還紀錄（returnTargets 與 ops 同索引，借出為 nullptr）
+    // 有條碼的歸還先認領該冊的紀錄，其餘再依借出順序認領同一讀者、同一本書尚未被認領的紀錄
+    bool validateBatch(const std::vector<CirculationOp>& ops, std::vector<LoanRecord*>& returnTargets,
+                       std::vector<std::string>& errors) const;
 
     // 取得借閱記錄
     std::vector<LoanRecord*> getLoansForUser(const std::string& username) const;
     std::vector<LoanRecord*> getLoansForBook(int bookId) const;
     std::vector<LoanRecord*> getAllLoans() const;
     std::vector<LoanRecord*> getOverdueLoans() const;
+    std::vector<LoanRecord*> getOverdueLoans(time_t asOf) const;
+    std::vector<LoanRecord*> getLoansDueBetween(time_t from, time_t to) const; // 到期日介於 [from, to]
+    std::vector<LoanRecord*> getLoansDueWithin(int days) const;               // 尚未逾期、days 天內到期
     LoanRecord* findActiveLoan(const std::string& username, int bookId) const;
+    LoanRecord* findActiveLoanByBarcode(const std::string& barcode) const;
+    std::vector<LoanRecord*> getActiveLoans() const;    // 依到期日排序
+    void assignBarcode(LoanRecord* loan, const std::string& barcode);   // 校正舊紀錄借出的冊
+    std::vector<LoanRecord*> getActiveLoansForUser(const std::string& username) const;
+    int getActiveLoanCount(const std::string& username) const;
+    int getActiveBorrowerCount(int bookId) const;
+    size_t getActiveLoanTotal() const;
 
     // 罰款政策
     void setFinePolicy(const FinePolicy& policy);
     FinePolicy getFinePolicy() const;
     double calculateFine(const LoanRecord& loan) const;
-    double calculateUserFines(const std::string& username) const;
+    double calculateUserFines(const std::string& username) const;   // 該讀者所有逾期紀錄的罰款總和
+    // 批次計算：以同一個時間點算出每筆紀錄的逾期天數，再一次查表得到罰款
+    std::vector<double> calculateFines(const std::vector<LoanRecord*>& loanList, time_t asOf) const;
+
+    // 到期提醒／逾期事件（outbox 為空字串時停用）
+    void setOutboxFile(const std::string& filename);
+    void setReminderLeadDays(int days);
+    size_t processDueEvents(time_t now);   // 觸發到 now 為止的事件並寫入 outbox，回傳寫入筆數
+    size_t catchUpDueEvents();             // 一次補發上次執行後到現在的所有事件
+    void startScheduler(int intervalSeconds = 60);
+    void stopScheduler();
+
+    // 借閱歷史封存
+    static const int MIN_ARCHIVE_HORIZON_DAYS = 30;    // 近 30 天的活動摘要只需熱資料
+    void setArchiveDirectory(const std::string& directory);   // 須在 loadFromFile 之前設定
+    void setArchiveHorizonDays(int days);   // 0 停用；其餘至少 MIN_ARCHIVE_HORIZON_DAYS
+    int getArchiveHorizonDays() const;
+    size_t archiveReturnedLoans(time_t now);    // 回傳封存筆數；呼叫端之後存檔一次
+    const LoanArchive& getArchive() const;
 
     // 檔案操作
     bool loadFromFile(const std::string& filename);
     bool saveToFile(const std::string& filename) const;
 
-    // 統計與視覺化
-    std::unordered_map<int, int> getBookBorrowStats() const;
-    std::unordered_map<std::string, int> getUserBorrowStats() const;
+    // 統計與視覺化（直接回傳物化彙總，不重新掃描借閱紀錄）
+    const CirculationStats& getCirculationStats() const;
+    const LoanColumns& getLoanColumns() const;
+    const std::unordered_map<int, int>& getBookBorrowStats() const;
+    const std::unordered_map<std::string, int>& getUserBorrowStats() const;
     std::vector<std::pair<std::string, int>> getMonthlyStats() const;
+    // 分類統計需要書籍的分類；由持有館藏的一方在新增、編輯、刪除書籍時同步
+    void setBookCategories(int bookId, const std::vector<std::string>& categories);
+    void removeBookCategories(int bookId);
 
     // 顯示功能
     void displayUserLoans(const std::string& username) const;
@@ -11,7 +11,7 @@ private:
     time_t borrowDate;
     time_t dueDate;
     time_t returnDate; // 如果尚未歸還則為 0
-    int fineAmount;
+    std::string barcode; // 借出的冊；逐冊館藏之前的紀錄可能為空
 
 public:
     LoanRecord();
@@ -20,12 +20,13 @@ public:
     
     // 取值方法
     int getBookId() const;
-    std::string getUsername() const;
+    const std::string& getUsername() const;
     time_t getBorrowDate() const;
     time_t getDueDate() const;
     time_t getReturnDate() const;
     bool isReturned() const;
     int getGraceDays() const;
+    const std::string& getBarcode() const;
     
     // 設值方法
     void setBookId(int bookId);
@@ -35,6 +36,7 @@ public:
     void setReturnDate(time_t returnDate);
     void setReturned(bool returned);
     void setGraceDays(int graceDays);
+    void setBarcode(const std::string& barcode);
     
     // 操作方法
     void markAsReturned();
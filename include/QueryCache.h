@@ -0,0 +1,54 @@
+#ifndef QUERY_CACHE_H
+#define QUERY_CACHE_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+
+struct QueryCacheStats {
+    size_t hits;
+    size_t misses;
+    size_t evictions;       // 因容量不足被淘汰的項目
+    size_t invalidations;   // 因館藏異動（epoch 改變）而失效的項目
+    size_t entries;
+    size_t capacity;
+    size_t memoryBytes;     // 估計值：鍵、結果與節點開銷
+};
+
+// 以正規化查詢樹為鍵的 LRU 結果快取；結果為書籍在館藏陣列中的位置
+class QueryCache {
+private:
+    struct Entry {
+        std::string key;
+        std::vector<int> ordinals;
+    };
+
+    std::list<Entry> lru; // 最近使用的在前
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    size_t capacity;
+    unsigned long epoch;
+
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+    size_t invalidations;
+    size_t memoryBytes;
+
+    static size_t entryBytes(const Entry& entry);
+    void syncEpoch(unsigned long catalogEpoch);
+    void evictLast();
+
+public:
+    explicit QueryCache(size_t capacity = 64);
+
+    // 命中時回傳結果並移至最前；館藏 epoch 改變時整個快取失效
+    const std::vector<int>* lookup(const std::string& key, unsigned long catalogEpoch);
+    void store(const std::string& key, unsigned long catalogEpoch, std::vector<int> ordinals);
+
+    void clear();
+    void setCapacity(size_t newCapacity);
+    QueryCacheStats getStats() const;
+};
+
+#endif // QUERY_CACHE_H
@@ -0,0 +1,86 @@
+#ifndef QUERY_PROGRAM_H
+#define QUERY_PROGRAM_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include "Book.h"
+#include "BookShadow.h"
+#include "QueryParser.h"
+
+// 可查詢的書籍欄位（編譯時由欄位名稱與中英文別名解析而來）
+enum class BookField {
+    TITLE,
+    AUTHOR,
+    YEAR,
+    ISBN,
+    PUBLISHER,
+    LANGUAGE,
+    PAGE_COUNT,
+    CATEGORY,
+    SYNOPSIS,
+    TOTAL_COPIES,
+    AVAILABLE_COPIES,
+    UNKNOWN
+};
+
+// 已編譯的欄位條件：欄位已解析、字面值已正規化、數值已預先解析
+struct FieldPredicate {
+    BookField field;
+    FieldOperator op;
+    std::string value;      // 比對用的字面值（已經過 TextUtils::normalizeForSearch）
+    int number;             // 數值欄位的預先解析結果
+    bool numberValid;       // 字面值能否解析為數字
+
+    bool isNumeric() const;
+    // 字串欄位與 shadow 中的正規化副本比對，數值欄位直接讀取 book
+    bool matches(const Book& book, const BookShadow& shadow) const;
+};
+
+// 後序（postfix）指令
+enum class QueryOpCode : unsigned char {
+    PUSH_FALSE,   // 無法解析的子樹，結果為空集合
+    TEST_FIELD,   // operand = predicates 索引
+    TEST_TERM,    // operand = terms 索引（由索引查詢預先求得的結果）
+    AND,
+    OR,
+    NOT
+};
+
+struct QueryInstruction {
+    QueryOpCode op;
+    int operand;
+};
+
+// 將 QueryNode 樹編譯為扁平的後序指令序列，於掃描時逐本書執行
+class QueryProgram {
+private:
+    std::vector<QueryInstruction> code;
+    std::vector<FieldPredicate> predicates;
+    std::vector<std::string> terms;
+    int maxStackDepth;
+
+    int emit(const std::shared_ptr<QueryNode>& node, int depth);
+
+public:
+    QueryProgram();
+
+    static QueryProgram compile(const std::shared_ptr<QueryNode>& root);
+    static BookField resolveField(const std::string& fieldName);
+
+    // 正規化查詢樹：AND/OR 攤平並排序運算元、字面值正規化，語意相同的查詢得到相同的鍵
+    static std::string canonicalKey(const std::shared_ptr<QueryNode>& root);
+
+    const std::vector<QueryInstruction>& getCode() const;
+    const std::vector<FieldPredicate>& getPredicates() const;
+    const std::vector<std::string>& getTerms() const;
+    int getMaxStackDepth() const;
+    bool empty() const;
+
+    // termHits[i][ordinal] 為第 i 個詞彙在該書的命中結果；stack 由呼叫端配置並重複使用
+    bool matches(const Book& book, const BookShadow& shadow, size_t ordinal,
+                 const std::vector<std::vector<char>>& termHits,
+                 std::vector<char>& stack) const;
+};
+
+#endif // QUERY_PROGRAM_H
@@ -12,9 +12,12 @@ namespace SearchUtil {
  * ❶ 字串 / 字元 搜尋
  *    - indexOf : 回傳第一個匹配位置，找不到 → -1
  *    - contains: bool 版捷徑
+ *    - IgnoreCase 版本只轉換 ASCII 英文字母，不配置小寫副本
+ *    子字串搜尋依 CPU 支援自動選用 AVX2 / SSE2 / 純量實作
  * ---------------------------------------------------------- */
 int indexOf(const std::string& text, const std::string& pattern);
 int indexOf(const std::string& text, char ch);
+int indexOfIgnoreCase(const std::string& text, const std::string& pattern);
 
 inline bool contains(const std::string& text, const std::string& pattern) {
     return indexOf(text, pattern) != -1;
@@ -22,6 +25,15 @@ inline bool contains(const std::string& text, const std::string& pattern) {
 inline bool contains(const std::string& text, char ch) {
     return indexOf(text, ch) != -1;
 }
+inline bool containsIgnoreCase(const std::string& text, const std::string& pattern) {
+    return indexOfIgnoreCase(text, pattern) != -1;
+}
+
+// 子字串搜尋使用的指令集（依序遞增；設定值不會超過 CPU 實際支援的等級）
+enum class SimdLevel { SCALAR, SSE2, AVX2 };
+SimdLevel detectedSimdLevel();
+SimdLevel getSimdLevel();
+SimdLevel setSimdLevel(SimdLevel level);   // 回傳實際採用的等級
 
 /* -----------------------------------------------------------
  * ❷ 已排序序列 → 二分搜尋 (O(log n))
@@ -235,7 +235,7 @@ namespace SimpleJSON {
                     sortedObject.push_back(pair);
                 }
 
-                SortUtil::sort(sortedObject, [](const auto& a, const auto& b) {
+                SortUtil::parallelSort(sortedObject, [](const auto& a, const auto& b) {
                     return a.first < b.first;
                     });
 
@@ -3,6 +3,10 @@
 
 #include <vector>
 #include <functional>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <memory>
 
 namespace SortUtil {
     template<typename InputIterator, typename OutputIterator, typename UnaryOperation>
@@ -57,57 +61,407 @@ namespace SortUtil {
         return result;
     }
     
-    template<typename T, typename Compare>
-    int medianOfThreeIndex(std::vector<T>& arr, int low, int high, Compare comp) {
-        int mid = low + (high - low) / 2;
-        
-        if (comp(arr[mid], arr[low])) {
-            std::swap(arr[low], arr[mid]);
+    /* -----------------------------------------------------------
+     * pattern-defeating quicksort（pdqsort）
+     *    - 樞紐：中位數三取一，大區間用九取一（ninther）
+     *    - 小區間（< 24）改用插入排序
+     *    - 連續出現嚴重不平衡的切分時改用堆積排序，保證 O(n log n)
+     *    - 已排序／反向排序／大量重複鍵的輸入都接近 O(n)
+     *    - 算術型別使用區塊式（branchless）切分
+     *    全程以 move 搬移元素，不複製樞紐
+     * ---------------------------------------------------------- */
+    namespace detail {
+        const std::ptrdiff_t INSERTION_SORT_THRESHOLD = 24;
+        const std::ptrdiff_t NINTHER_THRESHOLD = 128;
+        const std::ptrdiff_t PARTIAL_INSERTION_SORT_LIMIT = 8;
+        const std::ptrdiff_t BLOCK_SIZE = 64;
+
+        template<typename T>
+        inline void swapElements(T* a, T* b) {
+            T tmp(std::move(*a));
+            *a = std::move(*b);
+            *b = std::move(tmp);
         }
-        if (comp(arr[high], arr[low])) {
-            std::swap(arr[low], arr[high]);
+
+        template<typename T, typename Compare>
+        void insertionSort(T* begin, T* end, Compare& comp) {
+            if (begin == end) return;
+
+            for (T* cur = begin + 1; cur != end; ++cur) {
+                T* sift = cur;
+                T* sift1 = cur - 1;
+                if (comp(*sift, *sift1)) {
+                    T tmp(std::move(*sift));
+                    do {
+                        *sift-- = std::move(*sift1);
+                    } while (sift != begin && comp(tmp, *--sift1));
+                    *sift = std::move(tmp);
+                }
+            }
         }
-        if (comp(arr[high], arr[mid])) {
-            std::swap(arr[mid], arr[high]);
+
+        // 前提：begin 左側存在一個不大於區間內任何元素的元素，因此不必檢查邊界
+        template<typename T, typename Compare>
+        void unguardedInsertionSort(T* begin, T* end, Compare& comp) {
+            if (begin == end) return;
+
+            for (T* cur = begin + 1; cur != end; ++cur) {
+                T* sift = cur;
+                T* sift1 = cur - 1;
+                if (comp(*sift, *sift1)) {
+                    T tmp(std::move(*sift));
+                    do {
+                        *sift-- = std::move(*sift1);
+                    } while (comp(tmp, *--sift1));
+                    *sift = std::move(tmp);
+                }
+            }
         }
-        
-        return mid;
-    }
-    
-    template<typename T, typename Compare>
-    int partition(std::vector<T>& arr, int low, int high, Compare comp) {
-        T pivot = arr[high];
-        int i = low - 1;
-        
-        for (int j = low; j < high; j++) {
-            if (comp(arr[j], pivot)) {
-                i++;
-                std::swap(arr[i], arr[j]);
+
+        // 搬移次數超過上限就放棄並回傳 false
+        template<typename T, typename Compare>
+        bool partialInsertionSort(T* begin, T* end, Compare& comp) {
+            if (begin == end) return true;
+
+            std::ptrdiff_t moved = 0;
+            for (T* cur = begin + 1; cur != end; ++cur) {
+                T* sift = cur;
+                T* sift1 = cur - 1;
+                if (comp(*sift, *sift1)) {
+                    T tmp(std::move(*sift));
+                    do {
+                        *sift-- = std::move(*sift1);
+                    } while (sift != begin && comp(tmp, *--sift1));
+                    *sift = std::move(tmp);
+                    moved += cur - sift;
+                }
+                if (moved > PARTIAL_INSERTION_SORT_LIMIT) return false;
             }
+            return true;
+        }
+
+        template<typename T, typename Compare>
+        inline void sort2(T* a, T* b, Compare& comp) {
+            if (comp(*b, *a)) swapElements(a, b);
+        }
+
+        template<typename T, typename Compare>
+        inline void sort3(T* a, T* b, T* c, Compare& comp) {
+            sort2(a, b, comp);
+            sort2(b, c, comp);
+            sort2(a, b, comp);
+        }
+
+        template<typename T, typename Compare>
+        void siftDown(T* base, std::ptrdiff_t start, std::ptrdiff_t size, Compare& comp) {
+            T value(std::move(base[start]));
+            std::ptrdiff_t hole = start;
+            std::ptrdiff_t child = 2 * hole + 1;
+
+            while (child < size) {
+                if (child + 1 < size && comp(base[child], base[child + 1])) {
+                    ++child;
+                }
+                if (!comp(value, base[child])) break;
+                base[hole] = std::move(base[child]);
+                hole = child;
+                child = 2 * hole + 1;
+            }
+            base[hole] = std::move(value);
+        }
+
+        template<typename T, typename Compare>
+        void heapSort(T* begin, T* end, Compare& comp) {
+            std::ptrdiff_t size = end - begin;
+            for (std::ptrdiff_t i = size / 2 - 1; i >= 0; --i) {
+                siftDown(begin, i, size, comp);
+            }
+            for (std::ptrdiff_t last = size - 1; last > 0; --last) {
+                swapElements(begin, begin + last);
+                siftDown(begin, 0, last, comp);
+            }
+        }
+
+        // 以 *begin 為樞紐，與樞紐相等的元素放到右側；回傳樞紐位置與輸入是否原本就已切分好
+        template<typename T, typename Compare>
+        std::pair<T*, bool> partitionRight(T* begin, T* end, Compare& comp) {
+            T pivot(std::move(*begin));
+            T* first = begin;
+            T* last = end;
+
+            // 樞紐是三個樣本的中位數，兩側迴圈必定會停下
+            while (comp(*++first, pivot));
+            if (first - 1 == begin) {
+                while (first < last && !comp(*--last, pivot));
+            } else {
+                while (!comp(*--last, pivot));
+            }
+
+            bool alreadyPartitioned = first >= last;
+            while (first < last) {
+                swapElements(first, last);
+                while (comp(*++first, pivot));
+                while (!comp(*--last, pivot));
+            }
+
+            T* pivotPos = first - 1;
+            *begin = std::move(*pivotPos);
+            *pivotPos = std::move(pivot);
+            return std::make_pair(pivotPos, alreadyPartitioned);
+        }
+
+        // 交換兩側區塊中記錄的錯位元素；兩側數量相同時逐一交換，否則以循環搬移減少寫入
+        template<typename T>
+        void swapOffsets(T* first, T* last, const unsigned char* offsetsLeft,
+                         const unsigned char* offsetsRight, size_t num, bool useSwaps) {
+            if (useSwaps) {
+                for (size_t i = 0; i < num; ++i) {
+                    swapElements(first + offsetsLeft[i], last - offsetsRight[i]);
+                }
+            } else if (num > 0) {
+                T* l = first + offsetsLeft[0];
+                T* r = last - offsetsRight[0];
+                T tmp(std::move(*l));
+                *l = std::move(*r);
+                for (size_t i = 1; i < num; ++i) {
+                    l = first + offsetsLeft[i];
+                    *r = std::move(*l);
+                    r = last - offsetsRight[i];
+                    *l = std::move(*r);
+                }
+                *r = std::move(tmp);
+            }
+        }
+
+        // 區塊式切分（BlockQuicksort）：先把比較結果寫成位移表，再批次交換，比較時不產生分支
+        template<typename T, typename Compare>
+        std::pair<T*, bool> partitionRightBranchless(T* begin, T* end, Compare& comp) {
+            T pivot(std::move(*begin));
+            T* first = begin;
+            T* last = end;
+
+            while (comp(*++first, pivot));
+            if (first - 1 == begin) {
+                while (first < last && !comp(*--last, pivot));
+            } else {
+                while (!comp(*--last, pivot));
+            }
+
+            bool alreadyPartitioned = first >= last;
+            if (!alreadyPartitioned) {
+                swapElements(first, last);
+                ++first;
+
+                unsigned char offsetsLeft[BLOCK_SIZE];
+                unsigned char offsetsRight[BLOCK_SIZE];
+                T* offsetsLeftBase = first;
+                T* offsetsRightBase = last;
+                size_t numLeft = 0, numRight = 0, startLeft = 0, startRight = 0;
+
+                while (first < last) {
+                    std::ptrdiff_t numUnknown = last - first;
+                    std::ptrdiff_t leftSplit = numLeft == 0 ? (numRight == 0 ? numUnknown / 2 : numUnknown) : 0;
+                    std::ptrdiff_t rightSplit = numRight == 0 ? (numUnknown - leftSplit) : 0;
+
+                    if (leftSplit >= BLOCK_SIZE) {
+                        for (std::ptrdiff_t i = 0; i < BLOCK_SIZE; ++i) {
+                            offsetsLeft[numLeft] = static_cast<unsigned char>(i);
+                            numLeft += !comp(*first, pivot);
+                            ++first;
+                        }
+                    } else {
+                        for (std::ptrdiff_t i = 0; i < leftSplit; ++i) {
+                            offsetsLeft[numLeft] = static_cast<unsigned char>(i);
+                            numLeft += !comp(*first, pivot);
+                            ++first;
+                        }
+                    }
+
+                    if (rightSplit >= BLOCK_SIZE) {
+                        for (std::ptrdiff_t i = 0; i < BLOCK_SIZE; ) {
+                            offsetsRight[numRight] = static_cast<unsigned char>(++i);
+                            numRight += comp(*--last, pivot);
+                        }
+                    } else {
+                        for (std::ptrdiff_t i = 0; i < rightSplit; ) {
+                            offsetsRight[numRight] = static_cast<unsigned char>(++i);
+                            numRight += comp(*--last, pivot);
+                        }
+                    }
+
+                    size_t num = numLeft < numRight ? numLeft : numRight;
+                    swapOffsets(offsetsLeftBase, offsetsRightBase,
+                                offsetsLeft + startLeft, offsetsRight + startRight,
+                                num, numLeft == numRight);
+                    numLeft -= num;
+                    numRight -= num;
+                    startLeft += num;
+                    startRight += num;
+
+                    if (numLeft == 0) {
+                        startLeft = 0;
+                        offsetsLeftBase = first;
+                    }
+                    if (numRight == 0) {
+                        startRight = 0;
+                        offsetsRightBase = last;
+                    }
+                }
+
+                // 剩下單側的錯位元素，直接與中間交界處交換
+                if (numLeft) {
+                    const unsigned char* offsets = offsetsLeft + startLeft;
+                    while (numLeft--) swapElements(offsetsLeftBase + offsets[numLeft], --last);
+                    first = last;
+                }
+                if (numRight) {
+                    const unsigned char* offsets = offsetsRight + startRight;
+                    while (numRight--) {
+                        swapElements(offsetsRightBase - offsets[numRight], first);
+                        ++first;
+                    }
+                    last = first;
+                }
+            }
+
+            T* pivotPos = first - 1;
+            *begin = std::move(*pivotPos);
+            *pivotPos = std::move(pivot);
+            return std::make_pair(pivotPos, alreadyPartitioned);
+        }
+
+        // 與樞紐相等的元素放到左側；用於左側邊界元素與樞紐相等（大量重複鍵）的情況
+        template<typename T, typename Compare>
+        T* partitionLeft(T* begin, T* end, Compare& comp) {
+            T pivot(std::move(*begin));
+            T* first = begin;
+            T* last = end;
+
+            while (comp(pivot, *--last));
+            if (last + 1 == end) {
+                while (first < last && !comp(pivot, *++first));
+            } else {
+                while (!comp(pivot, *++first));
+            }
+
+            while (first < last) {
+                swapElements(first, last);
+                while (comp(pivot, *--last));
+                while (!comp(pivot, *++first));
+            }
+
+            T* pivotPos = last;
+            *begin = std::move(*pivotPos);
+            *pivotPos = std::move(pivot);
+            return pivotPos;
+        }
+
+        // 選擇樞紐並放到 begin：大區間用九數中位數（ninther），否則三數中位數
+        template<typename T, typename Compare>
+        void choosePivot(T* begin, T* end, Compare& comp) {
+            std::ptrdiff_t size = end - begin;
+            std::ptrdiff_t half = size / 2;
+            if (size > NINTHER_THRESHOLD) {
+                sort3(begin, begin + half, end - 1, comp);
+                sort3(begin + 1, begin + (half - 1), end - 2, comp);
+                sort3(begin + 2, begin + (half + 1), end - 3, comp);
+                sort3(begin + (half - 1), begin + half, begin + (half + 1), comp);
+                swapElements(begin, begin + half);
+            } else {
+                sort3(begin + half, begin, end - 1, comp);
+            }
+        }
+
+        template<bool Branchless, typename T, typename Compare>
+        void pdqsortLoop(T* begin, T* end, Compare& comp, int badAllowed, bool leftmost) {
+            // 右半部以迴圈處理（尾遞迴消除）
+            while (true) {
+                std::ptrdiff_t size = end - begin;
+
+                if (size < INSERTION_SORT_THRESHOLD) {
+                    if (leftmost) {
+                        insertionSort(begin, end, comp);
+                    } else {
+                        unguardedInsertionSort(begin, end, comp);
+                    }
+                    return;
+                }
+
+                choosePivot(begin, end, comp);
+
+                // 左鄰元素（上一層的樞紐）與本次樞紐相等：相等元素全部放左側且不必再排序
+                if (!leftmost && !comp(*(begin - 1), *begin)) {
+                    begin = partitionLeft(begin, end, comp) + 1;
+                    continue;
+                }
+
+                std::pair<T*, bool> result = Branchless ? partitionRightBranchless(begin, end, comp)
+                                                        : partitionRight(begin, end, comp);
+                T* pivotPos = result.first;
+                bool alreadyPartitioned = result.second;
+
+                std::ptrdiff_t leftSize = pivotPos - begin;
+                std::ptrdiff_t rightSize = end - (pivotPos + 1);
+                bool highlyUnbalanced = leftSize < size / 8 || rightSize < size / 8;
+
+                if (highlyUnbalanced) {
+                    if (--badAllowed == 0) {
+                        heapSort(begin, end, comp);
+                        return;
+                    }
+
+                    // 打散固定模式，避免下一輪再選到差的樞紐
+                    if (leftSize >= INSERTION_SORT_THRESHOLD) {
+                        swapElements(begin, begin + leftSize / 4);
+                        swapElements(pivotPos - 1, pivotPos - leftSize / 4);
+                        if (leftSize > NINTHER_THRESHOLD) {
+                            swapElements(begin + 1, begin + (leftSize / 4 + 1));
+                            swapElements(begin + 2, begin + (leftSize / 4 + 2));
+                            swapElements(pivotPos - 2, pivotPos - (leftSize / 4 + 1));
+                            swapElements(pivotPos - 3, pivotPos - (leftSize / 4 + 2));
+                        }
+                    }
+                    if (rightSize >= INSERTION_SORT_THRESHOLD) {
+                        swapElements(pivotPos + 1, pivotPos + (1 + rightSize / 4));
+                        swapElements(end - 1, end - rightSize / 4);
+                        if (rightSize > NINTHER_THRESHOLD) {
+                            swapElements(pivotPos + 2, pivotPos + (2 + rightSize / 4));
+                            swapElements(pivotPos + 3, pivotPos + (3 + rightSize / 4));
+                            swapElements(end - 2, end - (1 + rightSize / 4));
+                            swapElements(end - 3, end - (2 + rightSize / 4));
+                        }
+                    }
+                } else if (alreadyPartitioned &&
+                           partialInsertionSort(begin, pivotPos, comp) &&
+                           partialInsertionSort(pivotPos + 1, end, comp)) {
+                    // 切分平衡且原本就已切分好：多半是近乎有序的輸入，插入排序即可收尾
+                    return;
+                }
+
+                pdqsortLoop<Branchless>(begin, pivotPos, comp, badAllowed, leftmost);
+                begin = pivotPos + 1;
+                leftmost = false;
+            }
+        }
+
+        inline int floorLog2(std::ptrdiff_t n) {
+            int log = 0;
+            while (n >>= 1) ++log;
+            return log;
         }
-        
-        std::swap(arr[i + 1], arr[high]);
-        return i + 1;
     }
-    
+
     template<typename T, typename Compare>
-    void quickSort(std::vector<T>& arr, int low, int high, Compare comp) {
-        if (low < high) {
-            int median = medianOfThreeIndex(arr, low, high, comp);
-            
-            std::swap(arr[median], arr[high]);
-            
-            int pi = partition(arr, low, high, comp);
-            
-            quickSort(arr, low, pi - 1, comp);
-            quickSort(arr, pi + 1, high, comp);
-        }
+    void sort(T* first, T* last, Compare comp) {
+        if (last - first <= 1) return;
+        detail::pdqsortLoop<std::is_arithmetic<T>::value>(first, last, comp,
+                                                          detail::floorLog2(last - first), true);
     }
-    
+
     template<typename T, typename Compare>
     void sort(std::vector<T>& arr, Compare comp) {
         if (arr.size() <= 1) return;
-        quickSort(arr, 0, arr.size() - 1, comp);
+        sort(arr.data(), arr.data() + arr.size(), comp);
     }
     
     template<typename T>
@@ -115,6 +469,363 @@ namespace SortUtil {
         sort(arr, [](const T& a, const T& b) { return a < b; });
     }
     
+    /* -----------------------------------------------------------
+     * 平行合併排序（共享工作池）
+     *    - 元素數少於門檻或只有一個執行緒時直接呼叫 sort()
+     *    - 先把資料切成數段各自排序，再兩兩合併；每輪合併依 merge path
+     *      切成多個互不重疊的輸出區段，讓所有執行緒都分到工作
+     *    - 合併時相等元素保留左段在前；T 須可預設建構（作為暫存緩衝區）
+     * ---------------------------------------------------------- */
+    namespace detail {
+        const size_t PARALLEL_SORT_THRESHOLD = 1 << 15;
+
+        // 共享工作池的介面，實作在 WorkerPool.cpp；標頭不必引入執行緒相關的標頭
+        size_t poolThreadCount();
+        void poolParallelFor(size_t count, size_t morselSize,
+                             const std::function<void(size_t, size_t, size_t)>& task);
+
+        // 一個合併輸出區段：left[leftBegin, leftEnd) 與 right[rightBegin, rightEnd) 合併到 out
+        template<typename T>
+        struct MergeTask {
+            T* left;
+            size_t leftBegin;
+            size_t leftEnd;
+            T* right;
+            size_t rightBegin;
+            size_t rightEnd;
+            T* out;
+        };
+
+        // 合併後前 k 個輸出中來自左段的數量（相等時左段優先）
+        template<typename T, typename Compare>
+        size_t mergeCoRank(size_t k, const T* left, size_t leftSize,
+                           const T* right, size_t rightSize, Compare& comp) {
+            size_t lo = k > rightSize ? k - rightSize : 0;
+            size_t hi = k < leftSize ? k : leftSize;
+            while (lo < hi) {
+                size_t mid = lo + (hi - lo) / 2;
+                if (!comp(right[k - mid - 1], left[mid])) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
+            }
+            return lo;
+        }
+
+        template<typename T, typename Compare>
+        void runMergeTask(const MergeTask<T>& task, Compare& comp) {
+            size_t i = task.leftBegin, j = task.rightBegin;
+            T* out = task.out;
+
+            while (i < task.leftEnd && j < task.rightEnd) {
+                if (comp(task.right[j], task.left[i])) {
+                    *out++ = std::move(task.right[j++]);
+                } else {
+                    *out++ = std::move(task.left[i++]);
+                }
+            }
+            while (i < task.leftEnd) *out++ = std::move(task.left[i++]);
+            while (j < task.rightEnd) *out++ = std::move(task.right[j++]);
+        }
+    }
+
+    template<typename T, typename Compare>
+    void parallelSort(std::vector<T>& arr, Compare comp) {
+        size_t threads = detail::poolThreadCount();
+        size_t n = arr.size();
+
+        if (n < detail::PARALLEL_SORT_THRESHOLD || threads <= 1) {
+            sort(arr, comp);
+            return;
+        }
+
+        // 段數取不小於執行緒數的 2 的次方，且每段至少數千個元素
+        size_t runs = 1;
+        while (runs < threads && n / (runs * 2) >= detail::PARALLEL_SORT_THRESHOLD / 8) {
+            runs *= 2;
+        }
+        if (runs == 1) {
+            sort(arr, comp);
+            return;
+        }
+
+        std::vector<size_t> bounds(runs + 1);
+        for (size_t r = 0; r <= runs; ++r) {
+            bounds[r] = n * r / runs;
+        }
+
+        T* data = arr.data();
+        detail::poolParallelFor(runs, 1, [data, &bounds, &comp](size_t begin, size_t end, size_t) {
+            for (size_t r = begin; r < end; ++r) {
+                Compare local = comp;
+                sort(data + bounds[r], data + bounds[r + 1], local);
+            }
+        });
+
+        std::vector<T> buffer(n);
+        T* source = data;
+        T* target = buffer.data();
+
+        while (runs > 1) {
+            size_t pairs = runs / 2;
+            size_t piecesPerPair = (threads + pairs - 1) / pairs;
+            std::vector<detail::MergeTask<T>> tasks;
+            tasks.reserve(pairs * piecesPerPair);
+
+            // 切分點須在任何元素被搬移前全部算好，否則相鄰區段會讀到已搬走的元素
+            for (size_t p = 0; p < pairs; ++p) {
+                T* left = source + bounds[2 * p];
+                T* right = source + bounds[2 * p + 1];
+                size_t leftSize = bounds[2 * p + 1] - bounds[2 * p];
+                size_t rightSize = bounds[2 * p + 2] - bounds[2 * p + 1];
+                size_t total = leftSize + rightSize;
+
+                size_t prevLeft = 0;
+                for (size_t piece = 0; piece < piecesPerPair; ++piece) {
+                    size_t outBegin = total * piece / piecesPerPair;
+                    size_t outEnd = total * (piece + 1) / piecesPerPair;
+                    size_t nextLeft = piece + 1 == piecesPerPair
+                        ? leftSize
+                        : detail::mergeCoRank(outEnd, left, leftSize, right, rightSize, comp);
+                    tasks.push_back({left, prevLeft, nextLeft,
+                                     right, outBegin - prevLeft, outEnd - nextLeft,
+                                     target + bounds[2 * p] + outBegin});
+                    prevLeft = nextLeft;
+                }
+            }
+
+            detail::poolParallelFor(tasks.size(), 1, [&tasks, &comp](size_t begin, size_t end, size_t) {
+                Compare local = comp;
+                for (size_t t = begin; t < end; ++t) {
+                    detail::runMergeTask(tasks[t], local);
+                }
+            });
+
+            std::vector<size_t> merged(pairs + 1);
+            for (size_t p = 0; p <= pairs; ++p) {
+                merged[p] = bounds[2 * p];
+            }
+            bounds.swap(merged);
+            runs = pairs;
+
+            T* swapTemp = source;
+            source = target;
+            target = swapTemp;
+        }
+
+        // 最後一輪結果若在緩衝區，搬回原陣列
+        if (source != data) {
+            detail::poolParallelFor(n, detail::PARALLEL_SORT_THRESHOLD / 4, [source, data](size_t begin, size_t end, size_t) {
+                for (size_t i = begin; i < end; ++i) {
+                    data[i] = std::move(source[i]);
+                }
+            });
+        }
+    }
+
+    template<typename T>
+    void parallelSort(std::vector<T>& arr) {
+        parallelSort(arr, [](const T& a, const T& b) { return a < b; });
+    }
+    
+    /* -----------------------------------------------------------
+     * 前 k 名選擇（排行榜只顯示前幾名時不必排序全部資料）
+     *    - nthElement：introselect，切分後只往第 nth 個元素所在的一側繼續，平均 O(n)；
+     *      切分不平衡次數過多時改用堆積排序，最壞情況仍為 O(n log n)
+     *    - partialSort：以大小為 k 的堆積掃過其餘元素，O(n log k)
+     *    - topK：只保留依 comp 排在最前的 k 個元素（已排序）；k 遠小於 n 時用堆積，
+     *      否則先 nthElement 再排序前 k 個
+     * ---------------------------------------------------------- */
+    namespace detail {
+        const size_t TOPK_HEAP_FACTOR = 16;
+
+        template<typename T, typename Compare>
+        void selectLoop(T* begin, T* nth, T* end, Compare& comp) {
+            T* const first = begin;
+            int badAllowed = floorLog2(end - begin);
+
+            while (end - begin >= INSERTION_SORT_THRESHOLD) {
+                std::ptrdiff_t size = end - begin;
+                choosePivot(begin, end, comp);
+
+                // 左鄰元素（上一輪的樞紐）與本次樞紐相等：相等元素全部放左側，整段都是答案
+                if (begin != first && !comp(*(begin - 1), *begin)) {
+                    T* equalEnd = partitionLeft(begin, end, comp);
+                    if (nth <= equalEnd) return;
+                    begin = equalEnd + 1;
+                    continue;
+                }
+
+                T* pivotPos = partitionRight(begin, end, comp).first;
+                if (pivotPos == nth) return;
+
+                std::ptrdiff_t leftSize = pivotPos - begin;
+                std::ptrdiff_t rightSize = end - (pivotPos + 1);
+                if ((leftSize < size / 8 || rightSize < size / 8) && --badAllowed == 0) {
+                    heapSort(begin, end, comp);
+                    return;
+                }
+
+                if (nth < pivotPos) {
+                    end = pivotPos;
+                } else {
+                    begin = pivotPos + 1;
+                }
+            }
+
+            insertionSort(begin, end, comp);
+        }
+
+        // 以 [first, middle) 為最大堆積保留目前最小的 k 個元素，最後就地排序
+        template<typename T, typename Compare>
+        void heapSelectSort(T* first, T* middle, T* last, Compare& comp) {
+            std::ptrdiff_t k = middle - first;
+            for (std::ptrdiff_t i = k / 2 - 1; i >= 0; --i) {
+                siftDown(first, i, k, comp);
+            }
+            for (T* it = middle; it < last; ++it) {
+                if (comp(*it, *first)) {
+                    swapElements(it, first);
+                    siftDown(first, 0, k, comp);
+                }
+            }
+            for (std::ptrdiff_t end = k - 1; end > 0; --end) {
+                swapElements(first, first + end);
+                siftDown(first, 0, end, comp);
+            }
+        }
+    }
+
+    // 讓 arr[nth] 成為排序後應在的元素，左側都不大於它、右側都不小於它
+    template<typename T, typename Compare>
+    void nthElement(std::vector<T>& arr, size_t nth, Compare comp) {
+        if (nth >= arr.size()) return;
+        detail::selectLoop(arr.data(), arr.data() + nth, arr.data() + arr.size(), comp);
+    }
+
+    template<typename T>
+    void nthElement(std::vector<T>& arr, size_t nth) {
+        nthElement(arr, nth, [](const T& a, const T& b) { return a < b; });
+    }
+
+    // 排序後前 k 個元素放在 arr[0, k)，其餘元素順序不定
+    template<typename T, typename Compare>
+    void partialSort(std::vector<T>& arr, size_t k, Compare comp) {
+        if (k >= arr.size()) {
+            sort(arr, comp);
+            return;
+        }
+        if (k == 0) return;
+        detail::heapSelectSort(arr.data(), arr.data() + k, arr.data() + arr.size(), comp);
+    }
+
+    template<typename T, typename Compare>
+    void topK(std::vector<T>& arr, size_t k, Compare comp) {
+        if (k >= arr.size()) {
+            sort(arr, comp);
+            return;
+        }
+
+        if (k * detail::TOPK_HEAP_FACTOR <= arr.size()) {
+            partialSort(arr, k, comp);
+        } else {
+            nthElement(arr, k, comp);
+            sort(arr.data(), arr.data() + k, comp);
+        }
+        arr.erase(arr.begin() + k, arr.end());
+    }
+
+    /* -----------------------------------------------------------
+     * LSD 基數排序（整數鍵：年份、頁數、借閱次數、時間戳記、書籍 ID）
+     *    - key(element) 回傳 32 或 64 位元整數，每個元素只呼叫一次
+     *    - 每輪處理 8 位元，所有元素在該位元組相同的輪次直接略過
+     *    - 穩定排序：鍵值相同的元素保持原本順序；descending 時反轉鍵值，相同鍵仍保持原順序
+     *    - T 須可預設建構（作為暫存緩衝區）
+     * ---------------------------------------------------------- */
+    namespace detail {
+        const int RADIX_BITS = 8;
+        const size_t RADIX_BUCKETS = size_t(1) << RADIX_BITS;
+
+        // 有號整數翻轉符號位元，使無號比較的順序與原本相同
+        template<typename Key>
+        inline typename std::make_unsigned<Key>::type toRadixKey(Key key) {
+            using UKey = typename std::make_unsigned<Key>::type;
+            UKey bits = static_cast<UKey>(key);
+            if (std::is_signed<Key>::value) {
+                bits ^= UKey(1) << (sizeof(UKey) * 8 - 1);
+            }
+            return bits;
+        }
+    }
+
+    template<typename T, typename KeyFn>
+    void radixSort(std::vector<T>& arr, KeyFn key, bool descending = false) {
+        using Key = typename std::decay<decltype(key(arr[0]))>::type;
+        static_assert(std::is_integral<Key>::value && (sizeof(Key) == 4 || sizeof(Key) == 8),
+                      "radixSort requires a 32- or 64-bit integer key");
+        using UKey = typename std::make_unsigned<Key>::type;
+        const size_t passes = sizeof(UKey);
+
+        size_t n = arr.size();
+        if (n <= 1) return;
+
+        // 鍵與元素放在同一筆紀錄中一起搬移，每輪只有一組寫入串流
+        struct Entry {
+            UKey key;
+            T value;
+        };
+        std::unique_ptr<Entry[]> entries(new Entry[n]);
+        std::unique_ptr<Entry[]> buffer(new Entry[n]);
+
+        // 取鍵的同時建立所有位元組的直方圖
+        std::vector<size_t> counts(passes * detail::RADIX_BUCKETS, 0);
+        for (size_t i = 0; i < n; ++i) {
+            UKey bits = detail::toRadixKey<Key>(key(arr[i]));
+            if (descending) bits = static_cast<UKey>(~bits);
+            entries[i].key = bits;
+            entries[i].value = std::move(arr[i]);
+            for (size_t pass = 0; pass < passes; ++pass) {
+                ++counts[pass * detail::RADIX_BUCKETS + ((bits >> (pass * detail::RADIX_BITS)) & 0xFF)];
+            }
+        }
+
+        Entry* source = entries.get();
+        Entry* target = buffer.get();
+
+        for (size_t pass = 0; pass < passes; ++pass) {
+            size_t* bucket = counts.data() + pass * detail::RADIX_BUCKETS;
+            unsigned int shift = static_cast<unsigned int>(pass * detail::RADIX_BITS);
+
+            // 所有元素落在同一個桶：這一輪不改變順序
+            if (bucket[(source[0].key >> shift) & 0xFF] == n) {
+                continue;
+            }
+
+            size_t offset = 0;
+            for (size_t b = 0; b < detail::RADIX_BUCKETS; ++b) {
+                size_t count = bucket[b];
+                bucket[b] = offset;
+                offset += count;
+            }
+
+            for (size_t i = 0; i < n; ++i) {
+                size_t position = bucket[(source[i].key >> shift) & 0xFF]++;
+                target[position] = std::move(source[i]);
+            }
+            std::swap(source, target);
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            arr[i] = std::move(source[i].value);
+        }
+    }
+
+    template<typename T>
+    void radixSort(std::vector<T>& arr, bool descending = false) {
+        radixSort(arr, [](const T& value) { return value; }, descending);
+    }
+
     template<typename T>
     struct DefaultComparator {
         bool operator()(const T& a, const T& b) const {
@@ -124,16 +835,8 @@ namespace SortUtil {
     
     template<typename T, typename Compare>
     void insertionSort(std::vector<T>& arr, Compare comp) {
-        for (size_t i = 1; i < arr.size(); ++i) {
-            T key = arr[i];
-            int j = i - 1;
-            
-            while (j >= 0 && comp(key, arr[j])) {
-                arr[j + 1] = arr[j];
-                j--;
-            }
-            arr[j + 1] = key;
-        }
+        if (arr.empty()) return;
+        detail::insertionSort(arr.data(), arr.data() + arr.size(), comp);
     }
     
     template<typename T, typename Compare>
@@ -15,6 +15,9 @@ public:
                                                            const std::string& author,
                                                            const std::string& synopsis,
                                                            const std::vector<std::string>& categories);
+    
+    // 搜尋用正規化：ASCII 轉小寫、全形 ASCII（U+FF01–U+FF5E）轉半形、全形空白（U+3000）轉空白
+    static std::string normalizeForSearch(const std::string& text);
 
 private:
     static int getUTF8CharLength(unsigned char firstByte);
@@ -0,0 +1,60 @@
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include <vector>
+#include <ctime>
+#include <functional>
+
+/* -----------------------------------------------------------
+ * 階層式時間輪（hierarchical timing wheel）
+ *    - 時間切成固定長度的 tick，共 LEVELS 層、每層 SLOTS 格；
+ *      第 L 層每格涵蓋 SLOTS^L 個 tick，超出最高層範圍的計時器放在 overflow
+ *    - 新增計時器 O(1)；每個計時器最多被下放 LEVELS 次，觸發為均攤 O(1)
+ *    - 計時器在 advance(now) 且 now >= deadline 時觸發，最多晚一個 tick，不會提早
+ *    - 第 0 層沒有計時器時整圈跳過，長時間離線後一次補跑（catch-up）也很快
+ * ---------------------------------------------------------- */
+class TimingWheel {
+public:
+    struct Timer {
+        time_t deadline;
+        unsigned long id;
+        long long tick;     // 觸發的 tick（deadline 無條件進位）
+    };
+
+    using FireCallback = std::function<void(const Timer&)>;
+
+private:
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const long long SLOTS = 1LL << SLOT_BITS;
+
+    time_t tickSeconds;
+    long long currentTick;  // 下一個要處理的 tick；之前的 tick 都已處理完畢
+    std::vector<std::vector<Timer>> slots[LEVELS];
+    size_t levelCounts[LEVELS];
+    std::vector<Timer> overflow;
+    std::vector<Timer> expired;   // 排入時已經過期，下一次 advance 立即觸發
+    size_t timerCount;
+
+    long long tickFor(time_t deadline) const;
+    void place(const Timer& timer);
+    void cascade(int level);
+
+public:
+    explicit TimingWheel(time_t tickSeconds = 60);
+
+    // 清空並把時間輪定位在 now：deadline <= getProcessedUntil() 的計時器視為已觸發
+    void reset(time_t now);
+
+    // 已經過期的計時器會在下一次 advance 時觸發
+    void schedule(time_t deadline, unsigned long id);
+
+    // 處理到 now 為止的所有 tick，依 tick 順序觸發計時器；回傳觸發數量
+    size_t advance(time_t now, const FireCallback& fire);
+
+    time_t getProcessedUntil() const;
+    time_t getTickSeconds() const;
+    size_t size() const;
+};
+
+#endif // TIMING_WHEEL_H
@@ -19,8 +19,10 @@ namespace VisualizationUtil {
     
     void drawPieChart(const std::unordered_map<std::string, int>& data, const std::string& title);
     
+    // limit > 0 時只選出並排序前 limit 筆
     template<typename K, typename V>
-    std::vector<std::pair<K, V>> sortMapByValue(const std::unordered_map<K, V>& map, bool ascending = false);
+    std::vector<std::pair<K, V>> sortMapByValue(const std::unordered_map<K, V>& map, bool ascending = false,
+                                                size_t limit = 0);
 }
 
 #endif // VISUALIZATION_UTIL_H 
\ No newline at end of file
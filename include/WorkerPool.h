@@ -0,0 +1,66 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <exception>
+
+// 固定大小的工作執行緒池：將 [0, count) 切成小區塊（morsel），由各執行緒動態領取
+class WorkerPool {
+public:
+    // fn(begin, end, workerIndex)；workerIndex 介於 0 與本次使用的執行緒數 - 1 之間
+    using RangeTask = std::function<void(size_t, size_t, size_t)>;
+    // prepare(threadCount)：在任何區塊執行前以本次使用的執行緒數呼叫一次（count 為 0 時也會呼叫），用來配置每個執行緒的暫存
+    using PrepareTask = std::function<void(size_t)>;
+
+private:
+    struct Job {
+        const RangeTask* task;
+        size_t count;
+        size_t morselSize;
+        std::atomic<size_t> next;
+        std::mutex errorMutex;
+        std::exception_ptr error;
+    };
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::mutex submitMutex; // 一次只執行一個 parallelFor
+    Job* job;
+    unsigned long generation;
+    size_t pending;
+    bool stopping;
+
+    void startWorkers(size_t threadCount);
+    void stopWorkers();
+    void workerLoop(size_t workerIndex, unsigned long startGeneration);
+    static void runMorsels(Job& job, size_t workerIndex);
+
+public:
+    // threadCount 為 0 時使用硬體執行緒數
+    explicit WorkerPool(size_t threadCount = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // 包含呼叫端執行緒在內的總執行緒數
+    size_t getThreadCount() const;
+    void setThreadCount(size_t threadCount);
+
+    // 呼叫端也參與運算，全部區塊完成後才返回；在工作執行緒內巢狀呼叫時直接循序執行
+    void parallelFor(size_t count, size_t morselSize, const RangeTask& task);
+    // 執行緒數在持有提交鎖時決定，同時進行的 setThreadCount 不會讓 workerIndex 超出 prepare 配置的範圍
+    void parallelFor(size_t count, size_t morselSize, const PrepareTask& prepare, const RangeTask& task);
+
+    static WorkerPool& shared();
+    static size_t defaultThreadCount();
+};
+
+#endif // WORKER_POOL_H
@@ -16,16 +16,16 @@ Book::Book(int id, const std::string& title, const std::string& author, int year
 
 // Getters
 int Book::getId() const { return id; }
-std::string Book::getTitle() const { return title; }
-std::string Book::getAuthor() const { return author; }
+const std::string& Book::getTitle() const { return title; }
+const std::string& Book::getAuthor() const { return author; }
 int Book::getYear() const { return year; }
 int Book::getAvailableCopies() const { return availableCopies; }
 int Book::getTotalCopies() const { return totalCopies; }
-std::string Book::getIsbn() const { return isbn; }
-std::string Book::getPublisher() const { return publisher; }
-std::string Book::getLanguage() const { return language; }
+const std::string& Book::getIsbn() const { return isbn; }
+const std::string& Book::getPublisher() const { return publisher; }
+const std::string& Book::getLanguage() const { return language; }
 int Book::getPageCount() const { return pageCount; }
-std::string Book::getSynopsis() const { return synopsis; }
+const std::string& Book::getSynopsis() const { return synopsis; }
 const std::vector<std::string>& Book::getCategories() const { return categories; }
 
 // Setters
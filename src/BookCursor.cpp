@@ -0,0 +1,108 @@
+#include "../include/BookCursor.h"
+#include "../include/BookManager.h"
+
+BookCursor::BookCursor()
+    : manager(nullptr), epoch(0), useOrdinals(true), totalCount(0),
+      sortKey(BookSortKey::NONE), descending(false), sorted(true), resumeOffset(0), resumeOrdinal(0) {}
+
+BookCursor::BookCursor(const BookManager* manager, BookSortKey sortKey, bool descending)
+    : manager(manager), epoch(manager ? manager->getCatalogEpoch() : 0), useOrdinals(false),
+      totalCount(0), sortKey(sortKey), descending(descending), sorted(sortKey == BookSortKey::NONE),
+      resumeOffset(0), resumeOrdinal(0) {}
+
+BookCursor BookCursor::fromHits(const BookManager* manager, std::vector<char> hits,
+                                BookSortKey sortKey, bool descending) {
+    BookCursor cursor(manager, sortKey, descending);
+    for (char hit : hits) {
+        cursor.totalCount += hit ? 1 : 0;
+    }
+    cursor.hits = std::move(hits);
+    return cursor;
+}
+
+BookCursor BookCursor::fromOrdinals(const BookManager* manager, std::vector<int> ordinals,
+                                    BookSortKey sortKey, bool descending) {
+    BookCursor cursor(manager, sortKey, descending);
+    cursor.totalCount = ordinals.size();
+    cursor.ordinals = std::move(ordinals);
+    cursor.useOrdinals = true;
+    return cursor;
+}
+
+size_t BookCursor::getTotalCount() const {
+    return totalCount;
+}
+
+bool BookCursor::isValid() const {
+    return manager != nullptr && manager->getCatalogEpoch() == epoch;
+}
+
+// 需要排序時沿著 BookManager 維護的排序排列走一次，挑出命中的位置（O(館藏數)，不必另外排序）
+void BookCursor::materializeSorted() const {
+    const std::vector<Book>& books = manager->getAllBooks();
+
+    if (useOrdinals) {
+        hits.assign(books.size(), 0);
+        for (int ordinal : ordinals) {
+            hits[ordinal] = 1;
+        }
+    }
+
+    const std::vector<int>& permutation = manager->getSortPermutation(sortKey);
+    ordinals.clear();
+    ordinals.reserve(totalCount);
+    for (size_t i = 0; i < permutation.size(); ++i) {
+        int ordinal = permutation[descending ? permutation.size() - 1 - i : i];
+        if (hits[ordinal]) {
+            ordinals.push_back(ordinal);
+        }
+    }
+
+    std::vector<char>().swap(hits);
+    useOrdinals = true;
+    sorted = true;
+}
+
+std::vector<Book*> BookCursor::fetch(size_t offset, size_t limit) const {
+    std::vector<Book*> page;
+    if (!isValid() || offset >= totalCount || limit == 0) {
+        return page;
+    }
+
+    if (!sorted) {
+        materializeSorted();
+    }
+
+    const std::vector<Book>& books = manager->getAllBooks();
+    size_t end = offset + limit < totalCount ? offset + limit : totalCount;
+    page.reserve(end - offset);
+
+    if (useOrdinals) {
+        for (size_t i = offset; i < end; ++i) {
+            page.push_back(const_cast<Book*>(&books[ordinals[i]]));
+        }
+        return page;
+    }
+
+    // 命中表：從最近的已知位置開始數，第一頁只需掃到第 limit 個命中為止
+    size_t seen = 0;
+    size_t ordinal = 0;
+    if (offset >= resumeOffset) {
+        seen = resumeOffset;
+        ordinal = resumeOrdinal;
+    }
+
+    for (; ordinal < hits.size() && seen < end; ++ordinal) {
+        if (!hits[ordinal]) {
+            continue;
+        }
+        if (seen >= offset) {
+            page.push_back(const_cast<Book*>(&books[ordinal]));
+        }
+        ++seen;
+    }
+
+    resumeOffset = seen;
+    resumeOrdinal = ordinal;
+    return page;
+}
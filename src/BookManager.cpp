@@ -2,6 +2,9 @@
 #include "../include/SortUtil.h"
 #include "../include/QueryParser.h"
 #include "../include/SearchUtil.h"
+#include "../include/WorkerPool.h"
+#include "../include/TextUtils.h"
+#include "../include/CollationKey.h"
 #include <fstream>
 #include <iostream>
 #include <cctype>
@@ -9,7 +12,14 @@
 
 using JSONValue = SimpleJSON::JSONValue;
 
-BookManager::BookManager() : nextId(1) {}
+BookManager::BookManager()
+    : nextId(1), queryCache(64), catalogEpoch(0),
+      sortPermutations(static_cast<int>(BookSortKey::PAGES) + 1),
+      compositeEpoch(0), compositeValid(false) {}
+
+void BookManager::bumpEpoch() {
+    ++catalogEpoch;
+}
 
 bool BookManager::addBook(Book& book) {
     if (book.getId() == 0) {
@@ -22,10 +32,15 @@ bool BookManager::addBook(Book& book) {
         nextId = std::max(nextId, book.getId() + 1);
     }
 
+    inventory.resize(book.getId(), book.getTotalCopies());
+    syncCopyCounts(book);
     books.push_back(book);
+    shadows.push_back(BookShadow::fromBook(book));
     bookIdMap[book.getId()] = books.size() - 1;
+    insertIntoPermutations(static_cast<int>(books.size() - 1));
 
     updateBookIndex(book.getId(), book);
+    bumpEpoch();
 
     return true;
 }
@@ -39,8 +54,15 @@ bool BookManager::updateBook(const Book& book) {
     removeFromIndex(book.getId());
     removeFromTitleIndex(book.getId());
 
+    removeFromPermutations(it->second, false);
     books[it->second] = book;
+    // 冊數變更時增減在架的冊，借出中與不可借的冊保留
+    inventory.resize(book.getId(), book.getTotalCopies());
+    syncCopyCounts(books[it->second]);
+    shadows[it->second] = BookShadow::fromBook(book);
+    insertIntoPermutations(it->second);
     updateBookIndex(book.getId(), book);
+    bumpEpoch();
 
     return true;
 }
@@ -55,16 +77,20 @@ bool BookManager::deleteBook(int bookId) {
     removeFromTitleIndex(bookId);
 
     int index = it->second;
+    removeFromPermutations(index, true);
     books.erase(books.begin() + index);
+    shadows.erase(shadows.begin() + index);
+    inventory.removeBook(bookId);
 
     // 重新建構 bookIdMap
     rebuildBookIdMap();
+    bumpEpoch();
 
     return true;
 }
 
 Book* BookManager::getBook(int bookId) {
-    auto it = SearchUtil::mapFind(bookIdMap, bookId);
+    auto it = bookIdMap.find(bookId);
     if (it == bookIdMap.end()) {
         return nullptr;
     }
@@ -73,7 +99,7 @@ Book* BookManager::getBook(int bookId) {
 }
 
 const Book* BookManager::getBook(int bookId) const {
-    auto it = SearchUtil::mapFind(bookIdMap, bookId);
+    auto it = bookIdMap.find(bookId);
     if (it == bookIdMap.end()) {
         return nullptr;
     }
@@ -81,22 +107,87 @@ const Book* BookManager::getBook(int bookId) const {
     return &books[it->second];
 }
 
-bool BookManager::borrowBook(int bookId) {
+bool BookManager::canApplyCopyDeltas(const std::unordered_map<int, int>& deltas,
+                                     std::vector<std::string>& errors) const {
+    bool ok = true;
+    for (const auto& entry : deltas) {
+        const Book* book = getBook(entry.first);
+        if (!book) {
+            errors.push_back("找不到圖書 ID " + std::to_string(entry.first));
+            ok = false;
+        } else if (book->getAvailableCopies() + entry.second < 0) {
+            errors.push_back("《" + book->getTitle() + "》可借冊數不足（剩 " +
+                             std::to_string(book->getAvailableCopies()) + " 本，需要 " +
+                             std::to_string(-entry.second) + " 本）");
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// 逐冊借還
+void BookManager::syncCopyCounts(Book& book) const {
+    book.setTotalCopies(inventory.copyCount(book.getId()));
+    book.setAvailableCopies(inventory.availableCount(book.getId()));
+}
+
+std::string BookManager::checkoutCopy(int bookId, const std::string& barcode) {
     Book* book = getBook(bookId);
     if (!book) {
+        return "";
+    }
+
+    std::string taken;
+    if (barcode.empty()) {
+        taken = inventory.checkout(bookId);
+    } else {
+        CopyInventory::CopyRef ref;
+        if (inventory.find(barcode, ref) && ref.bookId == bookId && inventory.checkout(barcode)) {
+            taken = barcode;
+        }
+    }
+
+    if (!taken.empty()) {
+        syncCopyCounts(*book);
+        bumpEpoch();
+    }
+    return taken;
+}
+
+bool BookManager::releaseCopy(const std::string& barcode) {
+    CopyInventory::CopyRef ref;
+    if (!inventory.find(barcode, ref) || !inventory.release(barcode)) {
         return false;
     }
 
-    return book->borrow();
+    Book* book = getBook(ref.bookId);
+    if (book) {
+        syncCopyCounts(*book);
+    }
+    bumpEpoch();
+    return true;
 }
 
-bool BookManager::returnBook(int bookId) {
-    Book* book = getBook(bookId);
-    if (!book) {
+bool BookManager::setCopyStatus(const std::string& barcode, CopyStatus status) {
+    CopyInventory::CopyRef ref;
+    if (!inventory.find(barcode, ref) || !inventory.setStatus(barcode, status)) {
         return false;
     }
 
-    return book->returnBook();
+    Book* book = getBook(ref.bookId);
+    if (book) {
+        syncCopyCounts(*book);
+    }
+    bumpEpoch();
+    return true;
+}
+
+bool BookManager::setCopyLocation(const std::string& barcode, const std::string& location) {
+    return inventory.setLocation(barcode, location);
+}
+
+const CopyInventory& BookManager::getInventory() const {
+    return inventory;
 }
 
 // Tokenize text into words
@@ -152,11 +243,11 @@ void BookManager::buildInvertedIndex() {
 void BookManager::buildTitleIndex() {
     titleIndex.clear();
 
-    for (const auto& book : books) {
-        // Add terms from title only
-        auto titleTokens = tokenize(book.getTitle());
+    for (size_t i = 0; i < books.size(); ++i) {
+        // Add terms from the normalized title only
+        auto titleTokens = tokenize(shadows[i].title);
         for (const auto& token : titleTokens) {
-            titleIndex[token].insert(book.getId());
+            titleIndex[token].insert(books[i].getId());
         }
     }
 }
@@ -188,43 +279,53 @@ void BookManager::removeFromTitleIndex(int bookId) {
 }
 
 std::vector<Book*> BookManager::searchBooks(const std::string& query) const {
-    std::vector<Book*> results;
+    BookCursor cursor = searchBooksCursor(query);
+    return cursor.fetch(0, cursor.getTotalCount());
+}
+
+std::vector<Book*> BookManager::filterByYear(int year, const std::string& op) const {
+    BookCursor cursor = filterByYearCursor(year, op);
+    return cursor.fetch(0, cursor.getTotalCount());
+}
+
+std::vector<Book*> BookManager::filterByCategory(const std::string& category) const {
+    BookCursor cursor = filterByCategoryCursor(category);
+    return cursor.fetch(0, cursor.getTotalCount());
+}
 
+BookCursor BookManager::searchBooksCursor(const std::string& query,
+                                          BookSortKey sortKey, bool descending) const {
     if (query.empty()) {
-        return results;
+        return BookCursor();
     }
 
-    for (auto& book : books) {
-        if (const_cast<Book&>(book).matchesKeyword(query)) {
-            results.push_back(const_cast<Book*>(&book));
-        }
+    std::string normalizedQuery = TextUtils::normalizeForSearch(query);
+    std::vector<char> hits(books.size(), 0);
+    for (size_t i = 0; i < books.size(); ++i) {
+        hits[i] = shadows[i].containsKeyword(normalizedQuery) ? 1 : 0;
     }
 
-    return results;
+    return BookCursor::fromHits(this, std::move(hits), sortKey, descending);
 }
 
-std::vector<Book*> BookManager::filterByYear(int year, const std::string& op) const {
-    std::vector<Book*> results;
-
-    for (auto& book : books) {
-        if (const_cast<Book&>(book).matchesYear(year, op)) {
-            results.push_back(const_cast<Book*>(&book));
-        }
+BookCursor BookManager::filterByYearCursor(int year, const std::string& op,
+                                           BookSortKey sortKey, bool descending) const {
+    std::vector<char> hits(books.size(), 0);
+    for (size_t i = 0; i < books.size(); ++i) {
+        hits[i] = books[i].matchesYear(year, op) ? 1 : 0;
     }
 
-    return results;
+    return BookCursor::fromHits(this, std::move(hits), sortKey, descending);
 }
 
-std::vector<Book*> BookManager::filterByCategory(const std::string& category) const {
-    std::vector<Book*> results;
-
-    for (auto& book : books) {
-        if (const_cast<Book&>(book).matchesCategory(category)) {
-            results.push_back(const_cast<Book*>(&book));
-        }
+BookCursor BookManager::filterByCategoryCursor(const std::string& category,
+                                               BookSortKey sortKey, bool descending) const {
+    std::vector<char> hits(books.size(), 0);
+    for (size_t i = 0; i < books.size(); ++i) {
+        hits[i] = books[i].matchesCategory(category) ? 1 : 0;
     }
 
-    return results;
+    return BookCursor::fromHits(this, std::move(hits), sortKey, descending);
 }
 
 // Get all books
@@ -244,9 +345,14 @@ bool BookManager::loadFromFile(const std::string& filename) {
         auto j = SimpleJSON::parseJSON(jsonStr);
         
         books.clear();
+        shadows.clear();
         bookIdMap.clear();
+        for (auto& permutation : sortPermutations) {
+            permutation.clear();
+        }
         invertedIndex.clear();
         titleIndex.clear();
+        inventory.clear();
         nextId = 1;
         
         if (!j->isArray()) {
@@ -291,7 +397,24 @@ bool BookManager::loadFromFile(const std::string& filename) {
                 }
             }
             
+            // 逐冊資料；舊格式沒有 copies 時依總冊數產生條碼，借出狀態由流通服務依借閱紀錄校正
+            if (bookJsonPtr->contains("copies")) {
+                const auto& copies = bookJsonPtr->at("copies")->getArray();
+                for (const auto& copyJson : copies) {
+                    CopyStatus status = CopyStatus::AVAILABLE;
+                    if (copyJson->contains("status")) {
+                        CopyInventory::parseStatus(copyJson->at("status")->getString(), status);
+                    }
+                    std::string location = copyJson->contains("location") ? copyJson->at("location")->getString() : "";
+                    inventory.addCopy(book.getId(), copyJson->at("barcode")->getString(), status, location);
+                }
+            } else {
+                inventory.resize(book.getId(), book.getTotalCopies());
+            }
+            syncCopyCounts(book);
+            
             books.push_back(book);
+            shadows.push_back(BookShadow::fromBook(book));
             bookIdMap[book.getId()] = books.size() - 1;
             
             // Update nextId
@@ -301,6 +424,8 @@ bool BookManager::loadFromFile(const std::string& filename) {
         // Build index
         buildInvertedIndex();
         buildTitleIndex();
+        rebuildPermutations();
+        bumpEpoch();
         
         return true;
     } catch (const std::exception& e) {
@@ -351,6 +476,18 @@ bool BookManager::saveToFile(const std::string& filename) const {
                 bookJson->set("categories", categoriesJson);
             }
             
+            auto copiesJson = SimpleJSON::JSONValue::createArray();
+            for (const auto& copy : inventory.getCopies(book.getId())) {
+                auto copyJson = SimpleJSON::JSONValue::createObject();
+                copyJson->set("barcode", copy.barcode);
+                copyJson->set("status", std::string(CopyInventory::statusName(copy.status)));
+                if (!copy.location.empty()) {
+                    copyJson->set("location", copy.location);
+                }
+                copiesJson->push_back(copyJson);
+            }
+            bookJson->set("copies", copiesJson);
+            
             j->push_back(bookJson);
         }
         
@@ -384,6 +521,220 @@ std::unordered_map<std::string, int> BookManager::getCategoryStats() const {
     return stats;
 }
 
+unsigned long BookManager::getCatalogEpoch() const {
+    return catalogEpoch;
+}
+
+QueryCacheStats BookManager::getQueryCacheStats() const {
+    return queryCache.getStats();
+}
+
+// 排序排列維護
+bool BookManager::sortKeyLess(BookSortKey key, int a, int b) const {
+    const Book& left = books[a];
+    const Book& right = books[b];
+    
+    // 字串欄位比較預先正規化的 shadow，與多重排序的排序鍵一致，比較時不配置記憶體
+    switch (key) {
+        case BookSortKey::TITLE: {
+            int order = shadows[a].title.compare(shadows[b].title);
+            if (order != 0) return order < 0;
+            break;
+        }
+        case BookSortKey::AUTHOR: {
+            int order = shadows[a].author.compare(shadows[b].author);
+            if (order != 0) return order < 0;
+            break;
+        }
+        case BookSortKey::YEAR:
+            if (left.getYear() != right.getYear()) return left.getYear() < right.getYear();
+            break;
+        case BookSortKey::PAGES:
+            if (left.getPageCount() != right.getPageCount()) return left.getPageCount() < right.getPageCount();
+            break;
+        case BookSortKey::NONE:
+            break;
+    }
+    
+    return a < b;
+}
+
+void BookManager::insertIntoPermutations(int ordinal) {
+    for (size_t k = 1; k < sortPermutations.size(); ++k) {
+        BookSortKey key = static_cast<BookSortKey>(k);
+        std::vector<int>& permutation = sortPermutations[k];
+        
+        // 二分搜尋插入位置
+        size_t lo = 0, hi = permutation.size();
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (sortKeyLess(key, permutation[mid], ordinal)) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        permutation.insert(permutation.begin() + lo, ordinal);
+    }
+}
+
+// shiftLater 為真時表示該書已從 books 移除，之後的位置都要往前移一格
+void BookManager::removeFromPermutations(int ordinal, bool shiftLater) {
+    for (size_t k = 1; k < sortPermutations.size(); ++k) {
+        std::vector<int>& permutation = sortPermutations[k];
+        size_t write = 0;
+        for (size_t read = 0; read < permutation.size(); ++read) {
+            int value = permutation[read];
+            if (value == ordinal) {
+                continue;
+            }
+            permutation[write++] = (shiftLater && value > ordinal) ? value - 1 : value;
+        }
+        permutation.resize(write);
+    }
+}
+
+void BookManager::rebuildPermutations() {
+    for (size_t k = 1; k < sortPermutations.size(); ++k) {
+        BookSortKey key = static_cast<BookSortKey>(k);
+        std::vector<int>& permutation = sortPermutations[k];
+        
+        permutation.resize(books.size());
+        for (size_t i = 0; i < books.size(); ++i) {
+            permutation[i] = static_cast<int>(i);
+        }
+        
+        // 整數鍵以穩定的基數排序處理，起始為位置順序，鍵值相同時自然依位置排列
+        if (key == BookSortKey::YEAR) {
+            SortUtil::radixSort(permutation, [this](int ordinal) { return books[ordinal].getYear(); });
+        } else if (key == BookSortKey::PAGES) {
+            SortUtil::radixSort(permutation, [this](int ordinal) { return books[ordinal].getPageCount(); });
+        } else {
+            SortUtil::parallelSort(permutation, [this, key](int a, int b) {
+                return sortKeyLess(key, a, b);
+            });
+        }
+    }
+}
+
+const std::vector<int>& BookManager::getSortPermutation(BookSortKey key) const {
+    return sortPermutations[static_cast<int>(key)];
+}
+
+std::vector<const Book*> BookManager::getBookPage(BookSortKey key, bool descending,
+                                                  size_t offset, size_t limit) const {
+    std::vector<const Book*> page;
+    if (offset >= books.size()) {
+        return page;
+    }
+    
+    size_t end = offset + limit < books.size() ? offset + limit : books.size();
+    page.reserve(end - offset);
+    
+    // NONE 依館藏順序，忽略 descending
+    if (key == BookSortKey::NONE) {
+        for (size_t i = offset; i < end; ++i) {
+            page.push_back(&books[i]);
+        }
+        return page;
+    }
+    
+    const std::vector<int>& permutation = sortPermutations[static_cast<int>(key)];
+    for (size_t i = offset; i < end; ++i) {
+        size_t position = descending ? books.size() - 1 - i : i;
+        page.push_back(&books[permutation[position]]);
+    }
+    
+    return page;
+}
+
+std::vector<int> BookManager::buildCompositePermutation(const std::vector<SortKeyPart>& spec) const {
+    struct KeyedOrdinal {
+        std::string key;
+        int ordinal;
+    };
+    
+    std::vector<KeyedOrdinal> keyed(books.size());
+    WorkerPool::shared().parallelFor(books.size(), SCAN_MORSEL_SIZE,
+        [this, &spec, &keyed](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; ++i) {
+                keyed[i].key = CollationKey::forBook(books[i], shadows[i], spec);
+                keyed[i].ordinal = static_cast<int>(i);
+            }
+        });
+    
+    // 鍵值相同時依位置，結果與單一欄位排列的穩定順序一致
+    SortUtil::parallelSort(keyed, [](const KeyedOrdinal& a, const KeyedOrdinal& b) {
+        int order = a.key.compare(b.key);
+        return order != 0 ? order < 0 : a.ordinal < b.ordinal;
+    });
+    
+    std::vector<int> permutation;
+    permutation.reserve(keyed.size());
+    for (const auto& entry : keyed) {
+        permutation.push_back(entry.ordinal);
+    }
+    return permutation;
+}
+
+const std::vector<int>& BookManager::getSortPermutation(const std::vector<SortKeyPart>& spec) const {
+    // 單一升序欄位直接使用增量維護的排列
+    if (spec.size() == 1 && !spec[0].descending && spec[0].field != BookSortKey::NONE) {
+        return sortPermutations[static_cast<int>(spec[0].field)];
+    }
+    
+    bool sameSpec = compositeValid && compositeEpoch == catalogEpoch &&
+                    compositeSpec.size() == spec.size();
+    for (size_t i = 0; sameSpec && i < spec.size(); ++i) {
+        sameSpec = compositeSpec[i].field == spec[i].field &&
+                   compositeSpec[i].descending == spec[i].descending;
+    }
+    
+    if (!sameSpec) {
+        compositePermutation = buildCompositePermutation(spec);
+        compositeSpec = spec;
+        compositeEpoch = catalogEpoch;
+        compositeValid = true;
+    }
+    return compositePermutation;
+}
+
+std::vector<const Book*> BookManager::getBookPage(const std::vector<SortKeyPart>& spec,
+                                                  size_t offset, size_t limit) const {
+    if (spec.empty()) {
+        return getBookPage(BookSortKey::NONE, false, offset, limit);
+    }
+    if (spec.size() == 1) {
+        return getBookPage(spec[0].field, spec[0].descending, offset, limit);
+    }
+    
+    std::vector<const Book*> page;
+    if (offset >= books.size()) {
+        return page;
+    }
+    
+    const std::vector<int>& permutation = getSortPermutation(spec);
+    size_t end = offset + limit < books.size() ? offset + limit : books.size();
+    page.reserve(end - offset);
+    for (size_t i = offset; i < end; ++i) {
+        page.push_back(&books[permutation[i]]);
+    }
+    
+    return page;
+}
+
+void BookManager::setQueryCacheCapacity(size_t capacity) {
+    queryCache.setCapacity(capacity);
+}
+
+void BookManager::setScanThreadCount(size_t threads) {
+    WorkerPool::shared().setThreadCount(threads);
+}
+
+size_t BookManager::getScanThreadCount() const {
+    return WorkerPool::shared().getThreadCount();
+}
+
 // Display
 void BookManager::displayAllBooks() const {
     std::cout << "===== Book List =====" << std::endl;
@@ -426,215 +777,123 @@ void BookManager::displayBooksByCategory() const {
 void BookManager::displayBooksByYear() const {
     std::cout << "===== Books by Year =====" << std::endl;
     
-    // Group books by year
-    std::unordered_map<int, std::vector<const Book*>> booksByYear;
-    
+    // Stable radix sort by year keeps catalog order within each year
+    std::vector<const Book*> byYear;
+    byYear.reserve(books.size());
     for (const auto& book : books) {
-        booksByYear[book.getYear()].push_back(&book);
-    }
-    
-    // Get sorted years
-    std::vector<int> years;
-    for (const auto& pair : booksByYear) {
-        years.push_back(pair.first);
+        byYear.push_back(&book);
     }
+    SortUtil::radixSort(byYear, [](const Book* book) { return book->getYear(); });
     
-    // Sort years
-    SortUtil::sort(years);
-    
-    // Display each year
-    for (int year : years) {
-        std::cout << "\n--- " << year << " (" << booksByYear[year].size() << " books) ---\n";
+    // Display each year group
+    size_t groupStart = 0;
+    while (groupStart < byYear.size()) {
+        int year = byYear[groupStart]->getYear();
+        size_t groupEnd = groupStart;
+        while (groupEnd < byYear.size() && byYear[groupEnd]->getYear() == year) {
+            ++groupEnd;
+        }
         
-        for (const auto* book : booksByYear[year]) {
-            book->displaySummary();
+        std::cout << "\n--- " << year << " (" << (groupEnd - groupStart) << " books) ---\n";
+        
+        for (size_t i = groupStart; i < groupEnd; ++i) {
+            byYear[i]->displaySummary();
         }
+        groupStart = groupEnd;
     }
     
     std::cout << std::string(30, '=') << std::endl;
 }
 
-// Advanced search (parse and evaluate boolean expressions)
+// Advanced search (parse, compile and evaluate boolean expressions)
 std::vector<Book*> BookManager::advancedSearch(const std::string& query) const {
+    BookCursor cursor = advancedSearchCursor(query);
+    return cursor.fetch(0, cursor.getTotalCount());
+}
+
+BookCursor BookManager::advancedSearchCursor(const std::string& query,
+                                             BookSortKey sortKey, bool descending) const {
     QueryParser parser;
-    std::vector<Book*> results;
     
     // Parse the query
     auto root = parser.parse(query);
     if (!root) {
         std::cerr << "Error parsing query" << std::endl;
-        return results;
+        return BookCursor();
     }
     
-    // Create a set of all book IDs
-    std::unordered_set<int> allBookIds;
-    for (const auto& pair : bookIdMap) {
-        allBookIds.insert(pair.first);
+    // Same canonical query under the same catalog epoch -> reuse the cached result
+    std::string cacheKey = QueryProgram::canonicalKey(root);
+    if (const auto* cached = queryCache.lookup(cacheKey, catalogEpoch)) {
+        return BookCursor::fromOrdinals(this, *cached, sortKey, descending);
     }
     
-    // Create a custom evaluate function that uses our field-specific query handler
-    std::function<std::unordered_set<int>(std::shared_ptr<QueryNode>)> evaluateNode = 
-        [this, &evaluateNode, &allBookIds](std::shared_ptr<QueryNode> node) -> std::unordered_set<int> {
-            if (!node) {
-                return {};
-            }
-            
-            switch (node->type) {
-                case NodeType::TERM: {
-                    // 沒有指定欄位的查詢，當作標題包含搜尋處理
-                    return searchInTitle(node->term);
-                }
-                
-                case NodeType::AND: {
-                    auto leftResults = evaluateNode(node->left);
-                    auto rightResults = evaluateNode(node->right);
-                    
-                    std::unordered_set<int> result;
-                    for (int id : leftResults) {
-                        if (rightResults.count(id) > 0) {
-                            result.insert(id);
-                        }
-                    }
-                    return result;
-                }
-                
-                case NodeType::OR: {
-                    auto leftResults = evaluateNode(node->left);
-                    auto rightResults = evaluateNode(node->right);
-                    
-                    std::unordered_set<int> result = leftResults;
-                    for (int id : rightResults) {
-                        result.insert(id);
-                    }
-                    return result;
-                }
-                
-                case NodeType::NOT: {
-                    auto childResults = evaluateNode(node->left);
-                    
-                    std::unordered_set<int> result;
-                    for (int id : allBookIds) {
-                        if (childResults.count(id) == 0) {
-                            result.insert(id);
-                        }
-                    }
-                    return result;
-                }
-                
-                case NodeType::FIELD_QUERY: {
-                    return evaluateFieldQuery(node);
-                }
-                
-                case NodeType::KEYWORD_QUERY: {
-                    // 關鍵字查詢，類似於 TERM 的處理
-                    return searchInTitle(node->term);
-                }
-            }
-            
-            return {};
-        };
-    
-    // Evaluate the query
-    auto resultIds = evaluateNode(root);
+    // Compile the tree into a flat postfix program and scan the catalog once
+    QueryProgram program = QueryProgram::compile(root);
+    auto hits = evaluateProgram(program);
     
-    // Convert IDs to Book pointers
-    for (int id : resultIds) {
-        auto bookIt = SearchUtil::mapFind(bookIdMap, id);
-        if (bookIt != bookIdMap.end()) {
-            results.push_back(const_cast<Book*>(&books[bookIt->second]));
+    std::vector<int> ordinals;
+    for (size_t i = 0; i < books.size(); ++i) {
+        if (hits[i]) {
+            ordinals.push_back(static_cast<int>(i));
         }
     }
     
-    return results;
+    queryCache.store(cacheKey, catalogEpoch, ordinals);
+    return BookCursor::fromOrdinals(this, std::move(ordinals), sortKey, descending);
 }
 
-// Evaluate a field-specific query against all books
-std::unordered_set<int> BookManager::evaluateFieldQuery(const std::shared_ptr<QueryNode>& node) const {
-    if (!node || node->type != NodeType::FIELD_QUERY) {
-        return {};
+// Run a compiled query program against every book
+std::vector<char> BookManager::evaluateProgram(const QueryProgram& program) const {
+    // 沒有指定欄位的詞彙先以標題索引求出命中表，掃描時只需查表
+    std::vector<std::vector<char>> termHits;
+    termHits.reserve(program.getTerms().size());
+    for (const auto& term : program.getTerms()) {
+        termHits.push_back(evaluateTerm(term));
     }
     
-    std::unordered_set<int> result;
+    std::vector<char> hits(books.size(), 0);
     
-    // Iterate through all books and check if they match the field query
-    for (const auto& book : books) {
-        if (bookMatchesFieldQuery(book, node)) {
-            result.insert(book.getId());
+    if (books.size() < PARALLEL_SCAN_THRESHOLD) {
+        std::vector<char> stack(program.getMaxStackDepth() + 1);
+        for (size_t i = 0; i < books.size(); ++i) {
+            hits[i] = program.matches(books[i], shadows[i], i, termHits, stack) ? 1 : 0;
         }
-    }
+        return hits;
+    }
+    
+    // 每個區塊只寫入命中表中屬於自己的範圍，各執行緒的結果直接合併在同一張表上
+    // 堆疊數依 parallelFor 實際使用的執行緒數配置，不受同時調整執行緒數影響
+    std::vector<std::vector<char>> stacks;
+    WorkerPool::shared().parallelFor(books.size(), SCAN_MORSEL_SIZE,
+        [&program, &stacks](size_t threads) {
+            stacks.assign(threads, std::vector<char>(program.getMaxStackDepth() + 1));
+        },
+        [this, &program, &termHits, &stacks, &hits](size_t begin, size_t end, size_t worker) {
+            std::vector<char>& stack = stacks[worker];
+            for (size_t i = begin; i < end; ++i) {
+                hits[i] = program.matches(books[i], shadows[i], i, termHits, stack) ? 1 : 0;
+            }
+        });
     
-    return result;
+    return hits;
 }
 
-// Check if a book matches a field-specific query
-bool BookManager::bookMatchesFieldQuery(const Book& book, const std::shared_ptr<QueryNode>& node) const {
-    if (!node || node->type != NodeType::FIELD_QUERY) {
-        return false;
+std::vector<char> BookManager::evaluateTerm(const std::string& term) const {
+    auto ids = searchInTitle(term);
+    std::vector<char> hits(books.size(), 0);
+    
+    if (ids.empty()) {
+        return hits;
     }
     
-    const std::string& field = node->field;
-    FieldOperator op = node->fieldOp;
-    const std::string& value = node->fieldValue;
-    
-    std::string fieldValue;
-    int numericValue = 0;
-    bool isNumeric = false;
-    
-    std::string lowerField = field;
-    for (char& c : lowerField) c = std::tolower(c);
-    
-    if (lowerField == "title" || lowerField == "標題") {
-        fieldValue = book.getTitle();
-    } 
-    else if (lowerField == "author" || lowerField == "作者") {
-        fieldValue = book.getAuthor();
-    } 
-    else if (lowerField == "year" || lowerField == "年份") {
-        numericValue = book.getYear();
-        isNumeric = true;
-    } 
-    else if (lowerField == "isbn") {
-        fieldValue = book.getIsbn();
-    } 
-    else if (lowerField == "publisher" || lowerField == "出版社") {
-        fieldValue = book.getPublisher();
-    } 
-    else if (lowerField == "language" || lowerField == "語言") {
-        fieldValue = book.getLanguage();
-    } 
-    else if (lowerField == "pagecount" || lowerField == "頁數") {
-        numericValue = book.getPageCount();
-        isNumeric = true;
-    } 
-    else if (lowerField == "category" || lowerField == "類別" || lowerField == "標籤") {
-        const auto& categories = book.getCategories();
-        
-        for (const auto& category : categories) {
-            if (QueryMatcher::matchString(category, op, value, false)) {
-                return true;
-            }
+    for (size_t i = 0; i < books.size(); ++i) {
+        if (ids.count(books[i].getId()) > 0) {
+            hits[i] = 1;
         }
-        
-        return false;
-    } 
-    else if (lowerField == "synopsis" || lowerField == "簡介" || lowerField == "概要") {
-        fieldValue = book.getSynopsis();
-    } 
-    else if (lowerField == "copies" || lowerField == "totalcopies" || lowerField == "總數量") {
-        numericValue = book.getTotalCopies();
-        isNumeric = true;
-    } 
-    else if (lowerField == "availablecopies" || lowerField == "可用數量") {
-        numericValue = book.getAvailableCopies();
-        isNumeric = true;
-    } 
-    else {
-        return false;
     }
     
-    return isNumeric ? 
-        QueryMatcher::matchNumber(numericValue, op, value) : 
-        QueryMatcher::matchString(fieldValue, op, value, true);
+    return hits;
 }
 
 std::unordered_set<int> BookManager::searchInTitle(const std::string& query) const {
@@ -645,7 +904,8 @@ std::unordered_set<int> BookManager::searchInTitle(const std::string& query) con
     
     // 對於中文或包含特殊字元的查詢，使用子字串匹配
     // 對於英文詞彙，使用分詞匹配
-    auto queryTokens = tokenize(query);
+    std::string normalizedQuery = TextUtils::normalizeForSearch(query);
+    auto queryTokens = tokenize(normalizedQuery);
     std::unordered_set<int> resultIds;
     
     // 先嘗試使用分詞進行精確匹配（適用於英文）
@@ -677,16 +937,10 @@ std::unordered_set<int> BookManager::searchInTitle(const std::string& query) con
     
     // 如果分詞匹配沒有結果，或查詢包含中文字元，使用子字串匹配
     if (resultIds.empty()) {
-        for (const auto& book : books) {
-            std::string title = book.getTitle();
-            std::string searchQuery = query;
-            
-            // 轉換為小寫進行不區分大小寫的比較
-            for (char& c : title) c = std::tolower(c);
-            for (char& c : searchQuery) c = std::tolower(c);
-            
-            if (SearchUtil::contains(title, searchQuery)) {
-                resultIds.insert(book.getId());
+        for (size_t i = 0; i < books.size(); ++i) {
+            // 與正規化後的標題比對，不另外配置小寫副本
+            if (SearchUtil::contains(shadows[i].title, normalizedQuery)) {
+                resultIds.insert(books[i].getId());
             }
         }
     }
@@ -700,7 +954,7 @@ void BookManager::updateBookIndex(int bookId, const Book& book) {
     for (const auto& category : book.getCategories()) {
         addToIndex(bookId, category);
     }
-    addToTitleIndex(bookId, book.getTitle());
+    addToTitleIndex(bookId, TextUtils::normalizeForSearch(book.getTitle()));
 }
 
 void BookManager::rebuildBookIdMap() {
@@ -0,0 +1,42 @@
+#include "../include/BookShadow.h"
+#include "../include/TextUtils.h"
+#include "../include/SearchUtil.h"
+
+BookShadow BookShadow::fromBook(const Book& book) {
+    BookShadow shadow;
+    shadow.title = TextUtils::normalizeForSearch(book.getTitle());
+    shadow.author = TextUtils::normalizeForSearch(book.getAuthor());
+    shadow.isbn = TextUtils::normalizeForSearch(book.getIsbn());
+    shadow.publisher = TextUtils::normalizeForSearch(book.getPublisher());
+    shadow.language = TextUtils::normalizeForSearch(book.getLanguage());
+    shadow.synopsis = TextUtils::normalizeForSearch(book.getSynopsis());
+
+    const auto& categories = book.getCategories();
+    shadow.categories.reserve(categories.size());
+    for (const auto& category : categories) {
+        shadow.categories.push_back(TextUtils::normalizeForSearch(category));
+    }
+
+    return shadow;
+}
+
+bool BookShadow::containsKeyword(const std::string& normalizedKeyword) const {
+    if (normalizedKeyword.empty()) {
+        return false;
+    }
+
+    if (SearchUtil::contains(title, normalizedKeyword) ||
+        SearchUtil::contains(author, normalizedKeyword) ||
+        SearchUtil::contains(synopsis, normalizedKeyword)) {
+        return true;
+    }
+
+    for (const auto& category : categories) {
+        if (SearchUtil::contains(category, normalizedKeyword)) {
+            return true;
+        }
+    }
+
+    return SearchUtil::contains(publisher, normalizedKeyword) ||
+           SearchUtil::contains(isbn, normalizedKeyword);
+}
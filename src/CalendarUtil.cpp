@@ -0,0 +1,210 @@
+#include "../include/CalendarUtil.h"
+#include <cstdio>
+
+namespace {
+    const long long SECONDS_PER_DAY = 24 * 60 * 60;
+
+    long long floorDiv(long long a, long long b) {
+        long long q = a / b;
+        if ((a % b != 0) && ((a < 0) != (b < 0))) {
+            --q;
+        }
+        return q;
+    }
+}
+
+namespace CalendarUtil {
+
+    // Howard Hinnant's days_from_civil / civil_from_days
+    long long daysFromCivil(int year, int month, int day) {
+        long long y = year - (month <= 2 ? 1 : 0);
+        long long era = (y >= 0 ? y : y - 399) / 400;
+        long long yoe = y - era * 400;
+        long long doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        long long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + doe - 719468;
+    }
+
+    CivilDate civilFromDays(long long days) {
+        long long z = days + 719468;
+        long long era = (z >= 0 ? z : z - 146096) / 146097;
+        long long doe = z - era * 146097;
+        long long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        long long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        long long mp = (5 * doy + 2) / 153;
+        int day = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+        int month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+        int year = static_cast<int>(yoe + era * 400 + (month <= 2 ? 1 : 0));
+        return {year, month, day};
+    }
+
+    // OffsetTable
+    int OffsetTable::probe(long long t) {
+        time_t value = static_cast<time_t>(t);
+        struct tm* timeInfo = localtime(&value);
+        if (!timeInfo) {
+            return 0;
+        }
+
+        long long local = daysFromCivil(timeInfo->tm_year + 1900, timeInfo->tm_mon + 1, timeInfo->tm_mday) * SECONDS_PER_DAY +
+                          timeInfo->tm_hour * 3600LL + timeInfo->tm_min * 60LL + timeInfo->tm_sec;
+        return static_cast<int>(local - t);
+    }
+
+    OffsetTable::OffsetTable(int firstYear, int lastYear) {
+        // 前後各留一天，使當地時間的年初／年底也落在表內
+        rangeBegin = daysFromCivil(firstYear, 1, 1) * SECONDS_PER_DAY - SECONDS_PER_DAY;
+        rangeEnd = daysFromCivil(lastYear + 1, 1, 1) * SECONDS_PER_DAY + SECONDS_PER_DAY;
+
+        int previous = probe(rangeBegin);
+        transitions.push_back({rangeBegin, previous});
+
+        // 每天取樣一次：兩次轉換相隔不到一天的時區極少，週取樣則會漏掉一週內來回的轉換
+        long long last = rangeBegin;
+        while (last < rangeEnd - 1) {
+            long long next = last + SECONDS_PER_DAY < rangeEnd - 1 ? last + SECONDS_PER_DAY : rangeEnd - 1;
+            if (probe(next) == previous) {
+                last = next;
+                continue;
+            }
+            // (low, high] 之間發生轉換：找出第一個不再採用舊偏移量的秒數
+            long long low = last;
+            long long high = next;
+            while (high - low > 1) {
+                long long mid = low + (high - low) / 2;
+                if (probe(mid) == previous) {
+                    low = mid;
+                } else {
+                    high = mid;
+                }
+            }
+            // 記錄該秒實際的偏移量，並從轉換點繼續取樣，同一天內的下一次轉換也會被找到
+            previous = probe(high);
+            transitions.push_back({high, previous});
+            last = high;
+        }
+    }
+
+    int OffsetTable::offsetAt(long long t) const {
+        if (t < rangeBegin || t >= rangeEnd) {
+            return probe(t);
+        }
+
+        // 最後一個 utc <= t 的轉換
+        size_t low = 0;
+        size_t high = transitions.size();
+        while (high - low > 1) {
+            size_t mid = low + (high - low) / 2;
+            if (transitions[mid].utc <= t) {
+                low = mid;
+            } else {
+                high = mid;
+            }
+        }
+        return transitions[low].offset;
+    }
+
+    size_t OffsetTable::transitionCount() const {
+        return transitions.size();
+    }
+
+    const OffsetTable& localZone() {
+        static const OffsetTable table(1970, 2100);
+        return table;
+    }
+
+    // 序號換算
+    long long localSeconds(time_t t) {
+        long long value = static_cast<long long>(t);
+        return value + localZone().offsetAt(value);
+    }
+
+    long long dayOrdinal(time_t t) {
+        return floorDiv(localSeconds(t), SECONDS_PER_DAY);
+    }
+
+    long long weekOrdinal(time_t t) {
+        return weekOfDay(dayOrdinal(t));
+    }
+
+    int monthOrdinal(time_t t) {
+        return monthOfDay(dayOrdinal(t));
+    }
+
+    int monthOrdinal(int year, int month) {
+        return year * 12 + (month - 1);
+    }
+
+    CivilDate localDate(time_t t) {
+        return civilFromDays(dayOrdinal(t));
+    }
+
+    long long weekOfDay(long long dayOrdinal) {
+        // 1970-01-01 為週四，往前三天（1969-12-29，週一）為第 0 週的開始
+        return floorDiv(dayOrdinal + 3, 7);
+    }
+
+    int monthOfDay(long long dayOrdinal) {
+        CivilDate date = civilFromDays(dayOrdinal);
+        return monthOrdinal(date.year, date.month);
+    }
+
+    int yearOfMonth(int monthOrdinal) {
+        return static_cast<int>(floorDiv(monthOrdinal, 12));
+    }
+
+    int monthOfMonth(int monthOrdinal) {
+        return monthOrdinal - yearOfMonth(monthOrdinal) * 12 + 1;
+    }
+
+    std::string formatMonth(int monthOrdinal) {
+        char buffer[32];  // 容得下兩個完整的 int 與分隔符號
+        snprintf(buffer, sizeof(buffer), "%04d-%02d", yearOfMonth(monthOrdinal), monthOfMonth(monthOrdinal));
+        return buffer;
+    }
+
+    // DenseSeries
+    DenseSeries::DenseSeries() : first(0) {}
+
+    void DenseSeries::add(long long ordinal, int delta) {
+        if (counts.empty()) {
+            first = ordinal;
+            counts.push_back(0);
+        } else if (ordinal < first) {
+            counts.insert(counts.begin(), static_cast<size_t>(first - ordinal), 0);
+            first = ordinal;
+        } else if (ordinal >= endOrdinal()) {
+            counts.resize(static_cast<size_t>(ordinal - first + 1), 0);
+        }
+
+        counts[static_cast<size_t>(ordinal - first)] += delta;
+    }
+
+    int DenseSeries::get(long long ordinal) const {
+        if (counts.empty() || ordinal < first || ordinal >= endOrdinal()) {
+            return 0;
+        }
+        return counts[static_cast<size_t>(ordinal - first)];
+    }
+
+    void DenseSeries::clear() {
+        counts.clear();
+        first = 0;
+    }
+
+    bool DenseSeries::empty() const {
+        return counts.empty();
+    }
+
+    long long DenseSeries::firstOrdinal() const {
+        return first;
+    }
+
+    long long DenseSeries::endOrdinal() const {
+        return first + static_cast<long long>(counts.size());
+    }
+
+    const std::vector<int>& DenseSeries::values() const {
+        return counts;
+    }
+}
@@ -0,0 +1,260 @@
+#include "../include/CheckoutStation.h"
+#include "../include/SimpleJSON.h"
+#include "../include/SortUtil.h"
+#include <thread>
+#include <cctype>
+
+namespace {
+    std::string trim(const std::string& text) {
+        size_t begin = 0;
+        size_t end = text.size();
+        while (begin < end && std::isspace(static_cast<unsigned char>(text[begin]))) ++begin;
+        while (end > begin && std::isspace(static_cast<unsigned char>(text[end - 1]))) --end;
+        return text.substr(begin, end - begin);
+    }
+
+    std::string upper(std::string text) {
+        for (char& c : text) {
+            c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+        return text;
+    }
+
+    // 最近排名法；values 須已排序
+    double percentile(const std::vector<double>& values, double fraction) {
+        if (values.empty()) {
+            return 0.0;
+        }
+        size_t rank = static_cast<size_t>(fraction * values.size());
+        if (rank >= values.size()) {
+            rank = values.size() - 1;
+        }
+        return values[rank];
+    }
+}
+
+CheckoutStation::CheckoutStation(CirculationService& circulation, const UserManager& userManager,
+                                 std::function<bool()> commit, std::ostream& out, const StationConfig& config)
+    : circulation(circulation), userManager(userManager), commit(commit), out(out), config(config),
+      inputDone(false), halted(false) {
+    if (this->config.maxBatch == 0) {
+        this->config.maxBatch = 1;
+    }
+    if (this->config.flushMillis < 0) {
+        this->config.flushMillis = 0;
+    }
+}
+
+void CheckoutStation::readLoop(std::istream& in) {
+    std::string line;
+    size_t seq = 0;
+    while (std::getline(in, line)) {
+        ++seq;
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queue.push_back({seq, line, Clock::now()});
+        queueReady.notify_one();
+    }
+
+    std::lock_guard<std::mutex> lock(queueMutex);
+    inputDone = true;
+    queueReady.notify_one();
+}
+
+bool CheckoutStation::takeBatch(std::vector<ScanEvent>& batch) {
+    batch.clear();
+    std::unique_lock<std::mutex> lock(queueMutex);
+    queueReady.wait(lock, [this] { return !queue.empty() || inputDone; });
+    if (queue.empty()) {
+        return false;
+    }
+
+    // 批次未滿時，最多等到第一筆事件到達後 flushMillis 毫秒
+    Clock::time_point deadline = queue.front().arrived + std::chrono::milliseconds(config.flushMillis);
+    queueReady.wait_until(lock, deadline, [this] { return queue.size() >= config.maxBatch || inputDone; });
+
+    size_t count = queue.size() < config.maxBatch ? queue.size() : config.maxBatch;
+    for (size_t i = 0; i < count; ++i) {
+        batch.push_back(std::move(queue.front()));
+        queue.pop_front();
+    }
+    return true;
+}
+
+void CheckoutStation::processBatch(const std::vector<ScanEvent>& batch, StationReport& report) {
+    using JSONValue = SimpleJSON::JSONValue;
+
+    // 依序解析；工作階段只影響借出的讀者，借還作業稍後整批逐筆套用，結果與逐筆處理相同
+    std::vector<std::shared_ptr<JSONValue>> results(batch.size());
+    std::vector<CirculationOp> ops;
+    std::vector<size_t> opEvent;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        std::string line = trim(batch[i].line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        size_t space = line.find_first_of(" \t");
+        std::string verb = upper(line.substr(0, space));
+        std::string argument = space == std::string::npos ? "" : trim(line.substr(space + 1));
+
+        auto result = JSONValue::createObject();
+        result->set("seq", static_cast<int>(batch[i].seq));
+        results[i] = result;
+        std::string error;
+
+        if (verb == "USER" || verb == "U") {
+            result->set("event", std::string("user"));
+            result->set("user", argument);
+            currentUser.clear();
+            if (argument.empty() || !userManager.findUser(argument)) {
+                error = "找不到讀者 " + argument;
+            } else {
+                currentUser = argument;
+            }
+        } else if (verb == "END" || verb == "E") {
+            result->set("event", std::string("end"));
+            result->set("user", currentUser);
+            currentUser.clear();
+        } else if (verb == "BORROW" || verb == "ITEM" || verb == "B" || verb == "I") {
+            result->set("event", std::string("borrow"));
+            result->set("barcode", argument);
+            if (currentUser.empty()) {
+                error = "沒有進行中的讀者工作階段";
+            } else if (argument.empty()) {
+                error = "缺少條碼";
+            } else {
+                ops.push_back({CirculationOp::Type::BORROW, currentUser, 0, argument});
+                opEvent.push_back(i);
+            }
+        } else if (verb == "RETURN" || verb == "R") {
+            result->set("event", std::string("return"));
+            result->set("barcode", argument);
+            if (argument.empty()) {
+                error = "缺少條碼";
+            } else {
+                ops.push_back({CirculationOp::Type::RETURN, "", 0, argument});
+                opEvent.push_back(i);
+            }
+        } else {
+            result->set("event", std::string("unknown"));
+            error = "無法辨識的指令 " + verb;
+        }
+
+        result->set("status", std::string(error.empty() ? "ok" : "error"));
+        if (!error.empty()) {
+            result->set("error", error);
+        }
+    }
+
+    if (halted) {
+        for (size_t k : opEvent) {
+            results[k]->set("status", std::string("error"));
+            results[k]->set("error", std::string("借還站已因存檔失敗停止"));
+        }
+        ops.clear();
+        opEvent.clear();
+    }
+
+    std::vector<CirculationResult> outcomes = circulation.applyEach(ops);
+    std::vector<size_t> applied;
+    for (size_t k = 0; k < outcomes.size(); ++k) {
+        const CirculationResult& outcome = outcomes[k];
+        auto& result = results[opEvent[k]];
+        if (!outcome.ok) {
+            result->set("status", std::string("error"));
+            result->set("error", outcome.error);
+            continue;
+        }
+
+        applied.push_back(opEvent[k]);
+        result->set("user", outcome.username);
+        result->set("bookId", outcome.bookId);
+        if (ops[k].type == CirculationOp::Type::BORROW) {
+            result->set("dueDate", static_cast<int>(outcome.dueDate));
+        } else {
+            result->set("fine", outcome.fine);
+        }
+    }
+
+    // group commit：整批只存檔一次，存檔成功後才回覆成功；失敗時重試一次。
+    // 仍失敗時借還已在記憶體中生效，如實回覆 unsaved 並停止，避免之後的存檔把它們寫入
+    if (!applied.empty() && commit && !commit() && !commit()) {
+        report.commitFailures++;
+        report.unsaved += applied.size();
+        halted = true;
+        std::cerr << "Error committing station batch " << report.batches + 1 << "; station halted" << std::endl;
+        for (size_t i : applied) {
+            results[i]->set("status", std::string("unsaved"));
+            results[i]->set("error", std::string("已套用但未儲存"));
+        }
+    }
+
+    std::string lines;
+    Clock::time_point now = Clock::now();
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (!results[i]) {
+            continue;
+        }
+        double micros = std::chrono::duration<double, std::micro>(now - batch[i].arrived).count();
+        latencies.push_back(micros);
+        results[i]->set("latencyUs", static_cast<int>(micros));
+
+        report.events++;
+        if (results[i]->at("status")->getString() == "ok") {
+            report.succeeded++;
+        } else {
+            report.failed++;
+        }
+        lines += SimpleJSON::stringifyJSON(results[i]) + "\n";
+    }
+    out << lines;
+    out.flush();
+    report.batches++;
+}
+
+StationReport CheckoutStation::run(std::istream& in) {
+    StationReport report;
+    latencies.clear();
+    currentUser.clear();
+    inputDone = false;
+
+    Clock::time_point start = Clock::now();
+    std::thread reader(&CheckoutStation::readLoop, this, std::ref(in));
+
+    std::vector<ScanEvent> batch;
+    while (takeBatch(batch)) {
+        processBatch(batch, report);
+    }
+    reader.join();
+
+    report.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    SortUtil::sort(latencies);
+    report.p50 = percentile(latencies, 0.50);
+    report.p90 = percentile(latencies, 0.90);
+    report.p99 = percentile(latencies, 0.99);
+    report.maxLatency = latencies.empty() ? 0.0 : latencies.back();
+    return report;
+}
+
+void CheckoutStation::writeSummary(std::ostream& out, const StationReport& report) {
+    using JSONValue = SimpleJSON::JSONValue;
+
+    auto latency = JSONValue::createObject();
+    latency->set("p50", report.p50);
+    latency->set("p90", report.p90);
+    latency->set("p99", report.p99);
+    latency->set("max", report.maxLatency);
+
+    auto summary = JSONValue::createObject();
+    summary->set("event", std::string("summary"));
+    summary->set("events", static_cast<int>(report.events));
+    summary->set("ok", static_cast<int>(report.succeeded));
+    summary->set("errors", static_cast<int>(report.failed));
+    summary->set("batches", static_cast<int>(report.batches));
+    summary->set("commitFailures", static_cast<int>(report.commitFailures));
+    summary->set("unsaved", static_cast<int>(report.unsaved));
+    summary->set("seconds", report.seconds);
+    summary->set("eventsPerSecond", report.seconds > 0 ? report.events / report.seconds : 0.0);
+    summary->set("latencyUs", latency);
+    out << SimpleJSON::stringifyJSON(summary) << std::endl;
+}
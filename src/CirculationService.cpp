@@ -0,0 +1,401 @@
+#include "../include/CirculationService.h"
+#include "../include/WorkerPool.h"
+#include "../include/SortUtil.h"
+#include <chrono>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+    const size_t AUDIT_MORSEL_SIZE = 8192;
+
+    // 每個工作執行緒各自累計，最後再合併，掃描時不需要同步
+    struct AuditPartial {
+        std::vector<int> active;    // 以館藏位置為索引
+        std::vector<int> borrows;
+        std::unordered_map<std::string, int> userActive;
+        size_t activeTotal = 0;
+        size_t orphans = 0;
+    };
+}
+
+bool CirculationAudit::ok() const {
+    return drifts.empty() && userMismatches.empty() && !dueIndexMismatch;
+}
+
+CirculationService::CirculationService(BookManager& bookManager, LoanManager& loanManager,
+                                       const UserManager* userManager)
+    : bookManager(bookManager), loanManager(loanManager), userManager(userManager) {}
+
+bool CirculationService::borrow(const std::string& username, int bookId, std::vector<std::string>& errors) {
+    return apply({{CirculationOp::Type::BORROW, username, bookId}}, errors);
+}
+
+bool CirculationService::giveBack(const std::string& username, int bookId, std::vector<std::string>& errors) {
+    return apply({{CirculationOp::Type::RETURN, username, bookId}}, errors);
+}
+
+bool CirculationService::apply(const std::vector<CirculationOp>& ops, std::vector<std::string>& errors) {
+    if (ops.empty()) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    return applyLocked(ops, time(nullptr), errors, nullptr);
+}
+
+std::vector<CirculationResult> CirculationService::applyEach(const std::vector<CirculationOp>& ops) {
+    std::vector<CirculationResult> results(ops.size());
+    std::lock_guard<std::mutex> lock(mutex);
+    time_t now = time(nullptr);
+
+    std::vector<LoanRecord*> touched;
+    std::vector<std::string> errors;
+    for (size_t i = 0; i < ops.size(); ++i) {
+        CirculationResult& result = results[i];
+        errors.clear();
+        result.ok = applyLocked({ops[i]}, now, errors, &touched);
+        result.bookId = ops[i].bookId;
+        result.username = ops[i].username;
+        result.barcode = ops[i].barcode;
+        result.dueDate = 0;
+        result.fine = 0.0;
+
+        if (!result.ok) {
+            for (size_t e = 0; e < errors.size(); ++e) {
+                result.error += (e > 0 ? "；" : "") + errors[e];
+            }
+            continue;
+        }
+
+        const LoanRecord* loan = touched[0];
+        if (loan) {
+            result.bookId = loan->getBookId();
+            result.username = loan->getUsername();
+            result.barcode = loan->getBarcode();
+            result.dueDate = loan->getDueDate();
+            if (ops[i].type == CirculationOp::Type::RETURN) {
+                result.fine = loanManager.calculateFine(*loan);
+            }
+        }
+    }
+    return results;
+}
+
+bool CirculationService::applyLocked(const std::vector<CirculationOp>& ops, time_t now,
+                                     std::vector<std::string>& errors, std::vector<LoanRecord*>* touched) {
+    const CopyInventory& inventory = bookManager.getInventory();
+
+    // 指定條碼的借出由逐冊館藏補上書號；解析失敗的作業已有錯誤，不再計入冊數與架上檢查
+    bool ok = true;
+    std::vector<CirculationOp> resolved(ops);
+    std::vector<bool> unresolved(resolved.size(), false);
+    for (size_t i = 0; i < resolved.size(); ++i) {
+        CirculationOp& op = resolved[i];
+        if (op.type != CirculationOp::Type::BORROW || op.barcode.empty()) {
+            continue;
+        }
+        CopyInventory::CopyRef ref;
+        if (!inventory.find(op.barcode, ref)) {
+            errors.push_back("找不到條碼 " + op.barcode);
+            unresolved[i] = true;
+            ok = false;
+        } else if (op.bookId != 0 && op.bookId != ref.bookId) {
+            errors.push_back("條碼 " + op.barcode + " 不屬於圖書 ID " + std::to_string(op.bookId));
+            unresolved[i] = true;
+            ok = false;
+        } else {
+            op.bookId = ref.bookId;
+        }
+    }
+
+    std::vector<LoanRecord*> returnTargets;
+    ok = loanManager.validateBatch(resolved, returnTargets, errors) && ok;
+
+    std::unordered_map<int, int> copyDeltas;
+    std::unordered_set<std::string> checkedUsers;
+    std::unordered_set<std::string> releasedBarcodes;
+    std::unordered_set<std::string> claimedBarcodes;
+    for (size_t i = 0; i < resolved.size(); ++i) {
+        CirculationOp& op = resolved[i];
+        if (op.type == CirculationOp::Type::RETURN) {
+            LoanRecord* loan = returnTargets[i];
+            if (!loan) {
+                continue;
+            }
+            op.username = loan->getUsername();
+            op.bookId = loan->getBookId();
+            // 沒有對應冊的舊紀錄、或書已刪除時仍可歸還，只是沒有冊放回架上
+            if (!loan->getBarcode().empty() && bookManager.getBook(op.bookId)) {
+                releasedBarcodes.insert(loan->getBarcode());
+                copyDeltas[op.bookId]++;
+            }
+        }
+    }
+    for (size_t i = 0; i < resolved.size(); ++i) {
+        const CirculationOp& op = resolved[i];
+        if (op.type != CirculationOp::Type::BORROW) {
+            continue;
+        }
+        if (userManager && checkedUsers.insert(op.username).second && !op.username.empty() &&
+            !userManager->findUser(op.username)) {
+            errors.push_back("找不到讀者 " + op.username);
+            ok = false;
+        }
+        if (unresolved[i]) {
+            continue;
+        }
+        if (!op.barcode.empty()) {
+            const BookCopy* copy = inventory.findCopy(op.barcode);
+            bool onShelf = copy && (copy->status == CopyStatus::AVAILABLE ||
+                                    releasedBarcodes.count(op.barcode) > 0);
+            if (copy && !onShelf) {
+                errors.push_back("條碼 " + op.barcode + " 目前" + CopyInventory::statusLabel(copy->status) + "，不可借出");
+                ok = false;
+            } else if (copy && !claimedBarcodes.insert(op.barcode).second) {
+                errors.push_back("條碼 " + op.barcode + " 在同一批次中重複借出");
+                ok = false;
+            }
+        }
+        copyDeltas[op.bookId]--;
+    }
+
+    ok = bookManager.canApplyCopyDeltas(copyDeltas, errors) && ok;
+    if (!ok) {
+        return false;
+    }
+
+    // 兩側都檢查通過後才套用，全部使用同一個時間戳：
+    // 先歸還（放回的冊可在同批借出），再借出指定條碼的冊，最後由空閒串列配給其餘借出
+    if (touched) {
+        touched->assign(resolved.size(), nullptr);
+    }
+    int graceDays = loanManager.getFinePolicy().getGraceDays();
+    for (size_t i = 0; i < resolved.size(); ++i) {
+        if (resolved[i].type == CirculationOp::Type::RETURN) {
+            std::string barcode = returnTargets[i]->getBarcode();
+            loanManager.returnLoan(returnTargets[i], now);
+            if (!barcode.empty()) {
+                bookManager.releaseCopy(barcode);
+            }
+            if (touched) {
+                (*touched)[i] = returnTargets[i];
+            }
+        }
+    }
+    for (int pass = 0; pass < 2; ++pass) {
+        for (size_t i = 0; i < resolved.size(); ++i) {
+            const CirculationOp& op = resolved[i];
+            if (op.type != CirculationOp::Type::BORROW || op.barcode.empty() != (pass == 1)) {
+                continue;
+            }
+            std::string barcode = bookManager.checkoutCopy(op.bookId, op.barcode);
+            loanManager.borrowBook(op.username, op.bookId, now, graceDays, barcode);
+            if (touched && !barcode.empty()) {
+                (*touched)[i] = loanManager.findActiveLoanByBarcode(barcode);
+            }
+        }
+    }
+    return true;
+}
+
+CirculationAudit CirculationService::verify() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto start = std::chrono::steady_clock::now();
+
+    const std::vector<Book>& books = bookManager.getAllBooks();
+    std::vector<LoanRecord*> loans = loanManager.getAllLoans();
+
+    CirculationAudit audit;
+    audit.booksChecked = books.size();
+    audit.loansChecked = loans.size();
+    audit.activeLoans = 0;
+    audit.orphanLoans = 0;
+    audit.dueIndexMismatch = false;
+
+    // bookId -> 館藏位置，掃描借閱紀錄時以陣列查表
+    int maxId = 0;
+    for (const auto& book : books) {
+        if (book.getId() > maxId) {
+            maxId = book.getId();
+        }
+    }
+    std::vector<int> slotOf(static_cast<size_t>(maxId) + 1, -1);
+    for (size_t i = 0; i < books.size(); ++i) {
+        if (books[i].getId() >= 0) {
+            slotOf[static_cast<size_t>(books[i].getId())] = static_cast<int>(i);
+        }
+    }
+
+    // 每個執行緒的部分結果依 parallelFor 實際使用的執行緒數配置
+    WorkerPool& pool = WorkerPool::shared();
+    std::vector<AuditPartial> partials;
+    pool.parallelFor(loans.size(), AUDIT_MORSEL_SIZE,
+        [&books, &partials](size_t threads) {
+            partials.resize(threads);
+            for (auto& partial : partials) {
+                partial.active.assign(books.size(), 0);
+                partial.borrows.assign(books.size(), 0);
+            }
+        },
+        [&loans, &slotOf, &partials](size_t begin, size_t end, size_t worker) {
+            AuditPartial& partial = partials[worker];
+            for (size_t i = begin; i < end; ++i) {
+                const LoanRecord* loan = loans[i];
+                int bookId = loan->getBookId();
+                bool active = !loan->isReturned();
+                if (active) {
+                    partial.activeTotal++;
+                    partial.userActive[loan->getUsername()]++;
+                }
+
+                int slot = (bookId >= 0 && static_cast<size_t>(bookId) < slotOf.size()) ? slotOf[bookId] : -1;
+                if (slot < 0) {
+                    partial.orphans++;
+                    continue;
+                }
+                partial.borrows[slot]++;
+                if (active) {
+                    partial.active[slot]++;
+                }
+            }
+        });
+
+    AuditPartial& merged = partials[0];
+    for (size_t w = 1; w < partials.size(); ++w) {
+        for (size_t i = 0; i < books.size(); ++i) {
+            merged.active[i] += partials[w].active[i];
+            merged.borrows[i] += partials[w].borrows[i];
+        }
+        for (const auto& entry : partials[w].userActive) {
+            merged.userActive[entry.first] += entry.second;
+        }
+        merged.activeTotal += partials[w].activeTotal;
+        merged.orphans += partials[w].orphans;
+    }
+    audit.activeLoans = merged.activeTotal;
+    audit.orphanLoans = merged.orphans;
+
+    // 逐本比對冊數、索引與統計；各區塊只寫入自己的旗標範圍
+    const CirculationStats& stats = loanManager.getCirculationStats();
+    const CopyInventory& inventory = bookManager.getInventory();
+    // 封存區段的借閱次數由 manifest 摘要補上，不必開啟區段
+    const std::unordered_map<int, int>& archivedBorrows = loanManager.getArchive().getBookCounts();
+    for (size_t i = 0; i < books.size(); ++i) {
+        auto it = archivedBorrows.find(books[i].getId());
+        if (it != archivedBorrows.end()) {
+            merged.borrows[i] += it->second;
+        }
+    }
+    std::vector<char> drifted(books.size(), 0);
+    pool.parallelFor(books.size(), AUDIT_MORSEL_SIZE,
+        [this, &books, &merged, &stats, &inventory, &drifted](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; ++i) {
+                const Book& book = books[i];
+                int available = book.getAvailableCopies();
+                int total = book.getTotalCopies();
+                int onLoan = inventory.onLoanCount(book.getId());
+                int outOfService = inventory.copyCount(book.getId()) - inventory.availableCount(book.getId()) - onLoan;
+                bool consistent = available >= 0 && available <= total &&
+                                  total == inventory.copyCount(book.getId()) &&
+                                  available == inventory.availableCount(book.getId()) &&
+                                  onLoan == merged.active[i] &&
+                                  total - available == merged.active[i] + outOfService &&
+                                  loanManager.getActiveBorrowerCount(book.getId()) == merged.active[i] &&
+                                  stats.getBookBorrows(book.getId()) == merged.borrows[i];
+                drifted[i] = consistent ? 0 : 1;
+            }
+        });
+
+    for (size_t i = 0; i < books.size(); ++i) {
+        if (!drifted[i]) {
+            continue;
+        }
+        const Book& book = books[i];
+        audit.drifts.push_back({book.getId(), book.getTitle(), book.getTotalCopies(), book.getAvailableCopies(),
+                                merged.active[i], loanManager.getActiveBorrowerCount(book.getId()),
+                                merged.borrows[i], stats.getBookBorrows(book.getId()),
+                                inventory.copyCount(book.getId()), inventory.onLoanCount(book.getId())});
+    }
+    SortUtil::sort(audit.drifts, [](const CirculationDrift& a, const CirculationDrift& b) {
+        return a.bookId < b.bookId;
+    });
+
+    for (const auto& entry : merged.userActive) {
+        int indexed = loanManager.getActiveLoanCount(entry.first);
+        if (indexed != entry.second) {
+            audit.userMismatches.push_back(entry.first + "：紀錄 " + std::to_string(entry.second) +
+                                           " 筆，索引 " + std::to_string(indexed) + " 筆");
+        }
+    }
+    SortUtil::sort(audit.userMismatches);
+
+    audit.dueIndexMismatch = loanManager.getActiveLoanTotal() != merged.activeTotal;
+
+    auto stop = std::chrono::steady_clock::now();
+    audit.milliseconds = std::chrono::duration<double, std::milli>(stop - start).count();
+    return audit;
+}
+
+size_t CirculationService::reconcileCopies() {
+    std::lock_guard<std::mutex> lock(mutex);
+    const CopyInventory& inventory = bookManager.getInventory();
+    std::unordered_set<int> changed;
+
+    // 1. 借出中的冊必須對應到一筆未歸還借閱，否則放回架上
+    std::vector<std::string> stray;
+    for (const auto& book : bookManager.getAllBooks()) {
+        for (const auto& copy : inventory.getCopies(book.getId())) {
+            if (copy.status != CopyStatus::ON_LOAN) {
+                continue;
+            }
+            const LoanRecord* loan = loanManager.findActiveLoanByBarcode(copy.barcode);
+            if (!loan || loan->getBookId() != book.getId()) {
+                stray.push_back(copy.barcode);
+                changed.insert(book.getId());
+            }
+        }
+    }
+    for (const auto& barcode : stray) {
+        bookManager.releaseCopy(barcode);
+    }
+
+    // 2. 未歸還借閱的冊必須是借出中；已不存在或不可借的冊解除對應，沒有冊的借閱由空閒串列補上
+    std::vector<LoanRecord*> unassigned;
+    for (LoanRecord* loan : loanManager.getActiveLoans()) {
+        const std::string& barcode = loan->getBarcode();
+        if (barcode.empty()) {
+            unassigned.push_back(loan);
+            continue;
+        }
+        CopyInventory::CopyRef ref;
+        const BookCopy* copy = inventory.findCopy(barcode);
+        bool sameBook = inventory.find(barcode, ref) && ref.bookId == loan->getBookId();
+        if (copy && sameBook && copy->status == CopyStatus::ON_LOAN) {
+            continue;
+        }
+        if (copy && sameBook && copy->status == CopyStatus::AVAILABLE) {
+            bookManager.checkoutCopy(loan->getBookId(), barcode);
+        } else {
+            loanManager.assignBarcode(loan, "");
+            unassigned.push_back(loan);
+        }
+        changed.insert(loan->getBookId());
+    }
+
+    // 依借出順序配給，冊數不足時較晚的借閱保持沒有對應的冊
+    SortUtil::sort(unassigned, [](const LoanRecord* a, const LoanRecord* b) {
+        if (a->getBorrowDate() != b->getBorrowDate()) {
+            return a->getBorrowDate() < b->getBorrowDate();
+        }
+        return a < b;
+    });
+    for (LoanRecord* loan : unassigned) {
+        std::string barcode = bookManager.checkoutCopy(loan->getBookId());
+        if (!barcode.empty()) {
+            loanManager.assignBarcode(loan, barcode);
+            changed.insert(loan->getBookId());
+        }
+    }
+
+    return changed.size();
+}
@@ -0,0 +1,216 @@
+#include "../include/CirculationStats.h"
+
+const char* const CirculationStats::UNCATEGORIZED = "未分類";
+
+namespace {
+    template <typename Map, typename Key>
+    int countOf(const Map& map, const Key& key) {
+        auto it = map.find(key);
+        return it == map.end() ? 0 : it->second;
+    }
+
+    // 計數歸零時移除，彙總中只留下實際發生過借閱的項目
+    template <typename Map, typename Key>
+    void adjust(Map& map, const Key& key, int delta) {
+        int& count = map[key];
+        count += delta;
+        if (count <= 0) {
+            map.erase(key);
+        }
+    }
+}
+
+void LoanSummary::add(const LoanRecord& loan) {
+    time_t borrowed = loan.getBorrowDate();
+    if (loans == 0 || borrowed < minDate) {
+        minDate = borrowed;
+    }
+    if (loans == 0 || borrowed > maxDate) {
+        maxDate = borrowed;
+    }
+
+    loans++;
+    bookBorrows[loan.getBookId()]++;
+    userBorrows[loan.getUsername()]++;
+    dailyBorrows[CalendarUtil::dayOrdinal(borrowed)]++;
+    if (loan.isReturned()) {
+        returns++;
+        dailyReturns[CalendarUtil::dayOrdinal(loan.getReturnDate())]++;
+    }
+    int overdueDays = loan.getDaysOverdue(loan.getReturnDate());
+    if (loan.isReturned() && overdueDays > 0) {
+        userOverdueDays[loan.getUsername()][overdueDays]++;
+    }
+}
+
+CirculationStats::CirculationStats() : totalBorrows(0), totalReturns(0) {}
+
+void CirculationStats::addToCategories(const std::vector<std::string>& categories, int delta) {
+    if (delta == 0) {
+        return;
+    }
+    if (categories.empty()) {
+        adjust(categoryBorrows, std::string(UNCATEGORIZED), delta);
+        return;
+    }
+    for (const auto& category : categories) {
+        adjust(categoryBorrows, category, delta);
+    }
+}
+
+void CirculationStats::countBorrow(const LoanRecord& loan) {
+    bookBorrows[loan.getBookId()]++;
+    userBorrows[loan.getUsername()]++;
+
+    long long day = CalendarUtil::dayOrdinal(loan.getBorrowDate());
+    dailyBorrows.add(day);
+    weeklyBorrows.add(CalendarUtil::weekOfDay(day));
+    monthlyBorrows.add(CalendarUtil::monthOfDay(day));
+    totalBorrows++;
+}
+
+void CirculationStats::recordBorrow(const LoanRecord& loan) {
+    countBorrow(loan);
+
+    auto it = bookCategories.find(loan.getBookId());
+    if (it != bookCategories.end()) {
+        addToCategories(it->second, 1);
+    }
+}
+
+void CirculationStats::recordReturn(const LoanRecord& loan) {
+    monthlyReturns.add(CalendarUtil::monthOrdinal(loan.getReturnDate()));
+    totalReturns++;
+}
+
+void CirculationStats::rebuild(const std::deque<LoanRecord>& loans) {
+    clear();
+    for (const auto& loan : loans) {
+        countBorrow(loan);
+        if (loan.isReturned()) {
+            recordReturn(loan);
+        }
+    }
+
+    for (const auto& entry : bookCategories) {
+        addToCategories(entry.second, countOf(bookBorrows, entry.first));
+    }
+}
+
+void CirculationStats::addSummary(const LoanSummary& summary) {
+    for (const auto& entry : summary.bookBorrows) {
+        bookBorrows[entry.first] += entry.second;
+        auto it = bookCategories.find(entry.first);
+        if (it != bookCategories.end()) {
+            addToCategories(it->second, entry.second);
+        }
+    }
+    for (const auto& entry : summary.userBorrows) {
+        userBorrows[entry.first] += entry.second;
+    }
+    for (const auto& entry : summary.dailyBorrows) {
+        dailyBorrows.add(entry.first, entry.second);
+        weeklyBorrows.add(CalendarUtil::weekOfDay(entry.first), entry.second);
+        monthlyBorrows.add(CalendarUtil::monthOfDay(entry.first), entry.second);
+    }
+    for (const auto& entry : summary.dailyReturns) {
+        monthlyReturns.add(CalendarUtil::monthOfDay(entry.first), entry.second);
+    }
+    totalBorrows += static_cast<long long>(summary.loans);
+    totalReturns += static_cast<long long>(summary.returns);
+}
+
+void CirculationStats::clear() {
+    bookBorrows.clear();
+    userBorrows.clear();
+    categoryBorrows.clear();
+    monthlyBorrows.clear();
+    weeklyBorrows.clear();
+    dailyBorrows.clear();
+    monthlyReturns.clear();
+    totalBorrows = 0;
+    totalReturns = 0;
+}
+
+void CirculationStats::setBookCategories(int bookId, const std::vector<std::string>& categories) {
+    int borrows = countOf(bookBorrows, bookId);
+
+    auto it = bookCategories.find(bookId);
+    if (it != bookCategories.end()) {
+        if (it->second == categories) {
+            return;
+        }
+        addToCategories(it->second, -borrows);
+        it->second = categories;
+    } else {
+        bookCategories.emplace(bookId, categories);
+    }
+
+    addToCategories(categories, borrows);
+}
+
+void CirculationStats::removeBook(int bookId) {
+    auto it = bookCategories.find(bookId);
+    if (it == bookCategories.end()) {
+        return;
+    }
+
+    addToCategories(it->second, -countOf(bookBorrows, bookId));
+    bookCategories.erase(it);
+}
+
+int CirculationStats::getBookBorrows(int bookId) const {
+    return countOf(bookBorrows, bookId);
+}
+
+int CirculationStats::getUserBorrows(const std::string& username) const {
+    return countOf(userBorrows, username);
+}
+
+int CirculationStats::getCategoryBorrows(const std::string& category) const {
+    return countOf(categoryBorrows, category);
+}
+
+int CirculationStats::getMonthBorrows(int year, int month) const {
+    return monthlyBorrows.get(CalendarUtil::monthOrdinal(year, month));
+}
+
+int CirculationStats::getMonthReturns(int year, int month) const {
+    return monthlyReturns.get(CalendarUtil::monthOrdinal(year, month));
+}
+
+long long CirculationStats::getTotalBorrows() const {
+    return totalBorrows;
+}
+
+long long CirculationStats::getTotalReturns() const {
+    return totalReturns;
+}
+
+const std::unordered_map<int, int>& CirculationStats::getBookCounts() const {
+    return bookBorrows;
+}
+
+const std::unordered_map<std::string, int>& CirculationStats::getUserCounts() const {
+    return userBorrows;
+}
+
+const std::unordered_map<std::string, int>& CirculationStats::getCategoryCounts() const {
+    return categoryBorrows;
+}
+
+const CalendarUtil::DenseSeries& CirculationStats::getMonthlyBorrows() const {
+    return monthlyBorrows;
+}
+
+const CalendarUtil::DenseSeries& CirculationStats::getWeeklyBorrows() const {
+    return weeklyBorrows;
+}
+
+const CalendarUtil::DenseSeries& CirculationStats::getDailyBorrows() const {
+    return dailyBorrows;
+}
+
+const CalendarUtil::DenseSeries& CirculationStats::getMonthlyReturns() const {
+    return monthlyReturns;
+}
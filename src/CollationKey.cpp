@@ -0,0 +1,60 @@
+#include "../include/CollationKey.h"
+#include "../include/Book.h"
+#include "../include/BookShadow.h"
+
+namespace CollationKey {
+
+    void appendString(std::string& key, const std::string& normalized, bool descending) {
+        const unsigned char flip = descending ? 0xFF : 0x00;
+
+        for (char c : normalized) {
+            unsigned char byte = static_cast<unsigned char>(c);
+            key += static_cast<char>(byte ^ flip);
+            if (byte == 0x00) {
+                key += static_cast<char>(0xFF ^ flip);
+            }
+        }
+
+        // 結尾標記小於任何內容位元組，較短的前綴排在前面
+        key += static_cast<char>(flip);
+        key += static_cast<char>(flip);
+    }
+
+    void appendInt(std::string& key, int value, bool descending) {
+        unsigned int bits = static_cast<unsigned int>(value) ^ 0x80000000u;
+        if (descending) {
+            bits = ~bits;
+        }
+
+        key += static_cast<char>((bits >> 24) & 0xFF);
+        key += static_cast<char>((bits >> 16) & 0xFF);
+        key += static_cast<char>((bits >> 8) & 0xFF);
+        key += static_cast<char>(bits & 0xFF);
+    }
+
+    std::string forBook(const Book& book, const BookShadow& shadow, const std::vector<SortKeyPart>& spec) {
+        std::string key;
+
+        for (const auto& part : spec) {
+            switch (part.field) {
+                case BookSortKey::TITLE:
+                    appendString(key, shadow.title, part.descending);
+                    break;
+                case BookSortKey::AUTHOR:
+                    appendString(key, shadow.author, part.descending);
+                    break;
+                case BookSortKey::YEAR:
+                    appendInt(key, book.getYear(), part.descending);
+                    break;
+                case BookSortKey::PAGES:
+                    appendInt(key, book.getPageCount(), part.descending);
+                    break;
+                case BookSortKey::NONE:
+                    break;
+            }
+        }
+
+        return key;
+    }
+
+} // namespace CollationKey
@@ -0,0 +1,295 @@
+#include "../include/CopyInventory.h"
+#include <cstdio>
+
+std::string CopyInventory::makeBarcode(int bookId, int serial) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "B%06d-%03d", bookId, serial);
+    return buffer;
+}
+
+const char* CopyInventory::statusName(CopyStatus status) {
+    switch (status) {
+        case CopyStatus::AVAILABLE: return "available";
+        case CopyStatus::ON_LOAN: return "on_loan";
+        case CopyStatus::REPAIR: return "repair";
+        case CopyStatus::LOST: return "lost";
+    }
+    return "available";
+}
+
+const char* CopyInventory::statusLabel(CopyStatus status) {
+    switch (status) {
+        case CopyStatus::AVAILABLE: return "在架";
+        case CopyStatus::ON_LOAN: return "借出中";
+        case CopyStatus::REPAIR: return "維修中";
+        case CopyStatus::LOST: return "遺失";
+    }
+    return "在架";
+}
+
+bool CopyInventory::parseStatus(const std::string& name, CopyStatus& status) {
+    static const CopyStatus all[] = {CopyStatus::AVAILABLE, CopyStatus::ON_LOAN,
+                                     CopyStatus::REPAIR, CopyStatus::LOST};
+    for (CopyStatus candidate : all) {
+        if (name == statusName(candidate)) {
+            status = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+CopyInventory::CopyList& CopyInventory::listFor(int bookId) {
+    auto it = lists.find(bookId);
+    if (it == lists.end()) {
+        CopyList list;
+        list.freeHead = -1;
+        list.available = 0;
+        list.onLoan = 0;
+        list.nextSerial = 1;
+        it = lists.emplace(bookId, std::move(list)).first;
+    }
+    return it->second;
+}
+
+// 空閒串列
+void CopyInventory::pushFree(CopyList& list, int index) {
+    BookCopy& copy = list.copies[index];
+    copy.prevFree = -1;
+    copy.nextFree = list.freeHead;
+    if (list.freeHead >= 0) {
+        list.copies[list.freeHead].prevFree = index;
+    }
+    list.freeHead = index;
+}
+
+void CopyInventory::unlinkFree(CopyList& list, int index) {
+    BookCopy& copy = list.copies[index];
+    if (copy.prevFree >= 0) {
+        list.copies[copy.prevFree].nextFree = copy.nextFree;
+    } else {
+        list.freeHead = copy.nextFree;
+    }
+    if (copy.nextFree >= 0) {
+        list.copies[copy.nextFree].prevFree = copy.prevFree;
+    }
+    copy.prevFree = -1;
+    copy.nextFree = -1;
+}
+
+void CopyInventory::changeStatus(CopyList& list, int index, CopyStatus status) {
+    BookCopy& copy = list.copies[index];
+    if (copy.status == status) {
+        return;
+    }
+
+    if (copy.status == CopyStatus::AVAILABLE) {
+        unlinkFree(list, index);
+        list.available--;
+    } else if (copy.status == CopyStatus::ON_LOAN) {
+        list.onLoan--;
+    }
+
+    copy.status = status;
+    if (status == CopyStatus::AVAILABLE) {
+        pushFree(list, index);
+        list.available++;
+    } else if (status == CopyStatus::ON_LOAN) {
+        list.onLoan++;
+    }
+}
+
+// 移除一冊：最後一冊搬進空出的位置，陣列保持連續
+void CopyInventory::eraseCopy(int bookId, CopyList& list, int index) {
+    changeStatus(list, index, CopyStatus::LOST);
+    barcodeIndex.erase(list.copies[index].barcode);
+
+    int last = static_cast<int>(list.copies.size()) - 1;
+    if (index != last) {
+        bool lastFree = list.copies[last].status == CopyStatus::AVAILABLE;
+        if (lastFree) {
+            unlinkFree(list, last);
+        }
+        list.copies[index] = std::move(list.copies[last]);
+        if (lastFree) {
+            pushFree(list, index);
+        }
+        barcodeIndex[list.copies[index].barcode] = {bookId, index};
+    }
+    list.copies.pop_back();
+}
+
+std::string CopyInventory::nextBarcode(int bookId, CopyList& list) {
+    std::string barcode = makeBarcode(bookId, list.nextSerial++);
+    while (barcodeIndex.find(barcode) != barcodeIndex.end()) {
+        barcode = makeBarcode(bookId, list.nextSerial++);
+    }
+    return barcode;
+}
+
+BookCopy* CopyInventory::resolve(const std::string& barcode, CopyList** list) {
+    auto it = barcodeIndex.find(barcode);
+    if (it == barcodeIndex.end()) {
+        return nullptr;
+    }
+
+    CopyList& owner = lists.find(it->second.bookId)->second;
+    if (list) {
+        *list = &owner;
+    }
+    return &owner.copies[it->second.index];
+}
+
+// 建立／調整
+bool CopyInventory::addCopy(int bookId, const std::string& barcode, CopyStatus status,
+                            const std::string& location) {
+    if (barcode.empty() || barcodeIndex.find(barcode) != barcodeIndex.end()) {
+        return false;
+    }
+
+    CopyList& list = listFor(bookId);
+    int index = static_cast<int>(list.copies.size());
+    // 先以非可借狀態放入，再由 changeStatus 統一維護計數與空閒串列
+    list.copies.push_back({barcode, location, CopyStatus::LOST, -1, -1});
+    changeStatus(list, index, status);
+    barcodeIndex[barcode] = {bookId, index};
+    return true;
+}
+
+int CopyInventory::resize(int bookId, int total) {
+    CopyList& list = listFor(bookId);
+    if (total < 0) {
+        total = 0;
+    }
+
+    while (static_cast<int>(list.copies.size()) < total) {
+        addCopy(bookId, nextBarcode(bookId, list));
+    }
+
+    for (int i = static_cast<int>(list.copies.size()) - 1;
+         i >= 0 && static_cast<int>(list.copies.size()) > total; --i) {
+        if (list.copies[i].status == CopyStatus::AVAILABLE) {
+            eraseCopy(bookId, list, i);
+        }
+    }
+
+    return static_cast<int>(list.copies.size());
+}
+
+void CopyInventory::removeBook(int bookId) {
+    auto it = lists.find(bookId);
+    if (it == lists.end()) {
+        return;
+    }
+
+    for (const auto& copy : it->second.copies) {
+        barcodeIndex.erase(copy.barcode);
+    }
+    lists.erase(it);
+}
+
+void CopyInventory::clear() {
+    lists.clear();
+    barcodeIndex.clear();
+}
+
+// 借出／歸還
+std::string CopyInventory::checkout(int bookId) {
+    auto it = lists.find(bookId);
+    if (it == lists.end() || it->second.freeHead < 0) {
+        return "";
+    }
+
+    CopyList& list = it->second;
+    int index = list.freeHead;
+    changeStatus(list, index, CopyStatus::ON_LOAN);
+    return list.copies[index].barcode;
+}
+
+bool CopyInventory::checkout(const std::string& barcode) {
+    CopyList* list = nullptr;
+    BookCopy* copy = resolve(barcode, &list);
+    if (!copy || copy->status != CopyStatus::AVAILABLE) {
+        return false;
+    }
+
+    changeStatus(*list, static_cast<int>(copy - list->copies.data()), CopyStatus::ON_LOAN);
+    return true;
+}
+
+bool CopyInventory::release(const std::string& barcode) {
+    CopyList* list = nullptr;
+    BookCopy* copy = resolve(barcode, &list);
+    if (!copy || copy->status != CopyStatus::ON_LOAN) {
+        return false;
+    }
+
+    changeStatus(*list, static_cast<int>(copy - list->copies.data()), CopyStatus::AVAILABLE);
+    return true;
+}
+
+bool CopyInventory::setStatus(const std::string& barcode, CopyStatus status) {
+    CopyList* list = nullptr;
+    BookCopy* copy = resolve(barcode, &list);
+    if (!copy || copy->status == CopyStatus::ON_LOAN || status == CopyStatus::ON_LOAN) {
+        return false;
+    }
+
+    changeStatus(*list, static_cast<int>(copy - list->copies.data()), status);
+    return true;
+}
+
+bool CopyInventory::setLocation(const std::string& barcode, const std::string& location) {
+    BookCopy* copy = resolve(barcode);
+    if (!copy) {
+        return false;
+    }
+
+    copy->location = location;
+    return true;
+}
+
+// 查詢
+bool CopyInventory::find(const std::string& barcode, CopyRef& ref) const {
+    auto it = barcodeIndex.find(barcode);
+    if (it == barcodeIndex.end()) {
+        return false;
+    }
+
+    ref = it->second;
+    return true;
+}
+
+const BookCopy* CopyInventory::findCopy(const std::string& barcode) const {
+    auto it = barcodeIndex.find(barcode);
+    if (it == barcodeIndex.end()) {
+        return nullptr;
+    }
+
+    return &lists.find(it->second.bookId)->second.copies[it->second.index];
+}
+
+const std::vector<BookCopy>& CopyInventory::getCopies(int bookId) const {
+    static const std::vector<BookCopy> none;
+    auto it = lists.find(bookId);
+    return it == lists.end() ? none : it->second.copies;
+}
+
+int CopyInventory::copyCount(int bookId) const {
+    auto it = lists.find(bookId);
+    return it == lists.end() ? 0 : static_cast<int>(it->second.copies.size());
+}
+
+int CopyInventory::availableCount(int bookId) const {
+    auto it = lists.find(bookId);
+    return it == lists.end() ? 0 : it->second.available;
+}
+
+int CopyInventory::onLoanCount(int bookId) const {
+    auto it = lists.find(bookId);
+    return it == lists.end() ? 0 : it->second.onLoan;
+}
+
+size_t CopyInventory::totalCopies() const {
+    return barcodeIndex.size();
+}
@@ -3,10 +3,32 @@
 #include <iomanip>
 #include <cmath>
 
-FinePolicy::FinePolicy() : graceDays(0), fixedRate(0), incrementalFactor(1.0) {}
+FinePolicy::FinePolicy() : graceDays(0), fixedRate(0), incrementalFactor(1.0) {
+    rebuildTable();
+}
 
 FinePolicy::FinePolicy(int graceDays, double fixedRate, double incrementalFactor)
-    : graceDays(graceDays), fixedRate(fixedRate), incrementalFactor(incrementalFactor) {}
+    : graceDays(graceDays), fixedRate(fixedRate), incrementalFactor(incrementalFactor) {
+    rebuildTable();
+}
+
+// The table is accumulated in the same order as calculateFineIterative,
+// so lookups return exactly the same values as the day-by-day loop
+void FinePolicy::rebuildTable() {
+    auto table = std::make_shared<std::vector<double>>(TABLE_DAYS + 1);
+    std::vector<double>& values = *table;
+    
+    values[0] = 0.0;
+    for (int days = 1; days <= TABLE_DAYS; ++days) {
+        if (incrementalFactor <= 1.0) {
+            values[days] = days * fixedRate;
+        } else {
+            values[days] = values[days - 1] + fixedRate * std::pow(incrementalFactor, days - 1);
+        }
+    }
+    
+    fineTable = table;
+}
 
 // Getters
 int FinePolicy::getGraceDays() const { return graceDays; }
@@ -15,8 +37,8 @@ double FinePolicy::getIncrementalFactor() const { return incrementalFactor; }
 
 // Setters
 void FinePolicy::setGraceDays(int days) { graceDays = days; }
-void FinePolicy::setFixedRate(double rate) { fixedRate = rate; }
-void FinePolicy::setIncrementalFactor(double factor) { incrementalFactor = factor; }
+void FinePolicy::setFixedRate(double rate) { fixedRate = rate; rebuildTable(); }
+void FinePolicy::setIncrementalFactor(double factor) { incrementalFactor = factor; rebuildTable(); }
 
 // Calculate fine amount
 double FinePolicy::calculateFine(int overdueDays) const {
@@ -24,6 +46,32 @@ double FinePolicy::calculateFine(int overdueDays) const {
         return 0.0; // Within grace period
     }
     
+    int daysToCharge = overdueDays - graceDays;
+    if (daysToCharge <= TABLE_DAYS) {
+        return (*fineTable)[daysToCharge];
+    }
+    return calculateFineClosedForm(overdueDays);
+}
+
+double FinePolicy::calculateFineClosedForm(int overdueDays) const {
+    if (overdueDays <= graceDays) {
+        return 0.0;
+    }
+    
+    int daysToCharge = overdueDays - graceDays;
+    if (incrementalFactor <= 1.0) {
+        return daysToCharge * fixedRate;
+    }
+    
+    // Geometric series: rate * (f^n - 1) / (f - 1); expm1/log1p stay accurate when f is close to 1
+    return fixedRate * std::expm1(daysToCharge * std::log1p(incrementalFactor - 1.0)) / (incrementalFactor - 1.0);
+}
+
+double FinePolicy::calculateFineIterative(int overdueDays) const {
+    if (overdueDays <= graceDays) {
+        return 0.0; // Within grace period
+    }
+    
     double fine = 0.0;
     int daysToCharge = overdueDays - graceDays;
     
@@ -40,6 +88,22 @@ double FinePolicy::calculateFine(int overdueDays) const {
     return fine;
 }
 
+void FinePolicy::calculateFines(const std::vector<int>& overdueDays, std::vector<double>& fines) const {
+    fines.resize(overdueDays.size());
+    
+    const double* table = fineTable->data();
+    for (size_t i = 0; i < overdueDays.size(); ++i) {
+        int daysToCharge = overdueDays[i] - graceDays;
+        if (daysToCharge <= 0) {
+            fines[i] = 0.0;
+        } else if (daysToCharge <= TABLE_DAYS) {
+            fines[i] = table[daysToCharge];
+        } else {
+            fines[i] = calculateFineClosedForm(overdueDays[i]);
+        }
+    }
+}
+
 // Display policy
 void FinePolicy::display() const {
     std::cout << "===== 罰款政策 =====" << std::endl;
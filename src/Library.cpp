@@ -14,15 +14,36 @@
 #include <climits>   // for INT_MAX / INT_MIN
 
 Library::Library()
-    : bookFile("data/books.json"),
+    : circulation(bookManager, loanManager, &userManager),
+      bookFile("data/books.json"),
       userFile("data/users.json"),
-      loanFile("data/loans.json") {}
+      loanFile("data/loans.json"),
+      loanEventFile(deriveLoanEventFile(loanFile)) {}
 
 Library::Library(const std::string& bookFile, const std::string& userFile, 
                  const std::string& loanFile)
-    : bookFile(bookFile),
+    : circulation(bookManager, loanManager, &userManager),
+      bookFile(bookFile),
       userFile(userFile),
-      loanFile(loanFile) {}
+      loanFile(loanFile),
+      loanEventFile(deriveLoanEventFile(loanFile)) {}
+
+// data/loans.json -> data/loans_events.jsonl
+std::string Library::deriveLoanEventFile(const std::string& loanFile) {
+    std::string base = loanFile;
+    const std::string extension = ".json";
+    if (base.size() >= extension.size() &&
+        base.compare(base.size() - extension.size(), extension.size(), extension) == 0) {
+        base.erase(base.size() - extension.size());
+    }
+    return base + "_events.jsonl";
+}
+
+// data/loans.json -> data/loans_archive
+std::string Library::deriveLoanArchiveDirectory(const std::string& loanFile) {
+    std::string events = deriveLoanEventFile(loanFile);
+    return events.substr(0, events.size() - std::string("_events.jsonl").size()) + "_archive";
+}
 
 bool Library::initialize() {
     createDataDirectory();
@@ -45,6 +66,7 @@ bool Library::initialize() {
     // 無論用戶資料是否載入成功，都要載入圖書和借閱資料
     loadAllData();
     recommendationEngine.initialize(bookManager, loanManager);
+    startLoanEventScheduler();
     
     return true;
 }
@@ -65,9 +87,73 @@ void Library::loadAllData() {
         std::cout << "未找到現有圖書資料。以空資料庫啟動。" << std::endl;
     }
     
+    // 啟動時只讀封存的 manifest，區段在需要明細時才開啟
+    loanManager.setArchiveDirectory(deriveLoanArchiveDirectory(loanFile));
     if (!loanManager.loadFromFile(loanFile)) {
         std::cout << "未找到現有借閱資料。" << std::endl;
     }
+    
+    // 分類借閱統計依書籍分類彙總，載入館藏後登記每本書的分類
+    for (const auto& book : bookManager.getAllBooks()) {
+        loanManager.setBookCategories(book.getId(), book.getCategories());
+    }
+    
+    // 舊版借閱不會更新可借冊數，也沒有記錄借出的冊；啟動時檢查一次，依借閱紀錄校正並寫回
+    CirculationAudit audit = circulation.verify();
+    if (!audit.drifts.empty()) {
+        size_t fixed = circulation.reconcileCopies();
+        if (fixed > 0) {
+            std::cout << "已依借閱紀錄校正 " << fixed << " 本圖書的逐冊借出狀態。" << std::endl;
+            bookManager.saveToFile(bookFile);
+            loanManager.saveToFile(loanFile);
+        }
+    }
+    
+    size_t archived = loanManager.archiveReturnedLoans(time(nullptr));
+    if (archived > 0) {
+        std::cout << "已封存 " << archived << " 筆超過 " << loanManager.getArchiveHorizonDays()
+                  << " 天的歸還紀錄。" << std::endl;
+        loanManager.saveToFile(loanFile);
+    }
+}
+
+int Library::runStation(const StationConfig& config) {
+    createDataDirectory();
+    
+    // 標準輸出只留給結果行，載入與校正時的訊息改寫到標準錯誤
+    std::streambuf* console = std::cout.rdbuf(std::cerr.rdbuf());
+    userManager.loadFromFile(userFile);
+    loadAllData();
+    startLoanEventScheduler();
+    std::cout.rdbuf(console);
+    
+    std::ifstream file;
+    if (!config.inputPath.empty()) {
+        file.open(config.inputPath);
+        if (!file.is_open()) {
+            std::cerr << "無法開啟掃描事件來源: " << config.inputPath << std::endl;
+            return 1;
+        }
+    }
+    std::istream& input = config.inputPath.empty() ? std::cin : file;
+    
+    CheckoutStation station(circulation, userManager, [this] {
+        return bookManager.saveToFile(bookFile) && loanManager.saveToFile(loanFile);
+    }, std::cout, config);
+    StationReport report = station.run(input);
+    CheckoutStation::writeSummary(std::cout, report);
+    
+    return report.commitFailures == 0 ? 0 : 1;
+}
+
+void Library::startLoanEventScheduler() {
+    // 先補發程式關閉期間應發出的到期提醒／逾期事件，再交給背景執行緒定期推進
+    loanManager.setOutboxFile(loanEventFile);
+    size_t missed = loanManager.catchUpDueEvents();
+    if (missed > 0) {
+        std::cout << "已補發 " << missed << " 筆到期提醒／逾期事件。" << std::endl;
+    }
+    loanManager.startScheduler(LOAN_EVENT_INTERVAL_SECONDS);
 }
 
 bool Library::setupAdmin() {
@@ -210,6 +296,8 @@ bool Library::handleLogoutChoice(int choice, int logoutOption, int exitOption) {
         saveAllData();
         ConsoleUtil::printSuccess("資料已儲存，系統即將退出");
         ConsoleUtil::pauseAndWait();
+        // exit() 不會解構 Library，排程執行緒須先停止
+        loanManager.stopScheduler();
         exit(0);
     }
     return true; // 繼續目前選單
@@ -219,8 +307,8 @@ bool Library::adminMenu() {
     while (true) {
         std::vector<std::string> options = {
             "新增使用者", "設置罰款政策", "新增圖書", "刪除圖書", "編輯圖書",
-            "搜尋圖書", "檢視書籍", "書籍列表", "借閱圖書", "歸還圖書", "修改密碼", 
-            "檢視統計資料", "檢視逾期圖書", "登出", "退出系統"
+            "搜尋圖書", "檢視書籍", "書籍列表", "借閱圖書", "歸還圖書", "批次借還",
+            "修改密碼", "檢視統計資料", "檢視逾期圖書", "登出", "退出系統"
         };
         
         ConsoleUtil::printTitleWithSubtitle("圖書館管理系統", "管理員主選單");
@@ -240,11 +328,12 @@ bool Library::adminMenu() {
             case 8: viewBookList(); break;
             case 9: borrowBook(); break;
             case 10: returnBook(); break;
-            case 11: changePassword(); break;
-            case 12: showStatistics(); break;
-            case 13: displayOverdueLoans(); break;
-            case 14: case 15: 
-                return !handleLogoutChoice(choice, 14, 15);
+            case 11: circulationCart(); break;
+            case 12: changePassword(); break;
+            case 13: showStatistics(); break;
+            case 14: displayOverdueLoans(); break;
+            case 15: case 16: 
+                return !handleLogoutChoice(choice, 15, 16);
             default:
                 showInvalidChoice();
         }
@@ -255,7 +344,7 @@ bool Library::staffMenu() {
     while (true) {
         std::vector<std::string> options = {
             "新增圖書", "刪除圖書", "編輯圖書", "搜尋圖書", "檢視書籍", "書籍列表", 
-            "借閱圖書", "歸還圖書", "修改密碼", "檢視逾期圖書", "登出", "退出系統"
+            "借閱圖書", "歸還圖書", "批次借還", "修改密碼", "檢視逾期圖書", "登出", "退出系統"
         };
         
         ConsoleUtil::printTitleWithSubtitle("圖書館管理系統", "館員主選單");
@@ -273,10 +362,11 @@ bool Library::staffMenu() {
             case 6: viewBookList(); break;
             case 7: borrowBook(); break;
             case 8: returnBook(); break;
-            case 9: changePassword(); break;
-            case 10: displayOverdueLoans(); break;
-            case 11: case 12:
-                return !handleLogoutChoice(choice, 11, 12);
+            case 9: circulationCart(); break;
+            case 10: changePassword(); break;
+            case 11: displayOverdueLoans(); break;
+            case 12: case 13:
+                return !handleLogoutChoice(choice, 12, 13);
             default:
                 showInvalidChoice();
         }
@@ -414,6 +504,7 @@ void Library::addBook() {
     addBookCategories(book);
     
     if (bookManager.addBook(book)) {
+        loanManager.setBookCategories(book.getId(), book.getCategories());
         ConsoleUtil::printSuccess("圖書成功新增，ID: " + std::to_string(book.getId()));
         bookManager.saveToFile(bookFile);
     } else {
@@ -569,6 +660,7 @@ void Library::deleteBook() {
     std::string bookTitle = book->getTitle(); // 保存書名用於顯示
     
     if (bookManager.deleteBook(bookId)) {
+        loanManager.removeBookCategories(bookId);
         ConsoleUtil::printSuccess("圖書「" + bookTitle + "」已成功刪除");
         
         // 保存變更到文件
@@ -661,8 +753,14 @@ void Library::displayBookInventoryStatus(const Book* book) {
         std::cout << "   狀態: " << ConsoleUtil::colorText("已借完", ConsoleUtil::Color::BRIGHT_RED) << std::endl;
     }
     
-    int borrowedCopies = book->getTotalCopies() - book->getAvailableCopies();
-    std::cout << "   已借出數量: " << borrowedCopies << " 本" << std::endl;
+    const CopyInventory& inventory = bookManager.getInventory();
+    int onLoan = inventory.onLoanCount(book->getId());
+    std::cout << "   已借出數量: " << onLoan << " 本" << std::endl;
+    int outOfService = book->getTotalCopies() - book->getAvailableCopies() - onLoan;
+    if (outOfService > 0) {
+        std::cout << "   維修／遺失: " << outOfService << " 本" << std::endl;
+    }
+    displayBookCopies(book->getId());
     
     std::cout << "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━" << std::endl;
 }
@@ -698,14 +796,13 @@ void Library::displayBookSynopsis(const Book* book) {
 }
 
 void Library::displayBookBorrowStats(const Book* book) {
-    auto bookStats = loanManager.getBookBorrowStats();
-    auto it = SearchUtil::mapFind(bookStats, book->getId());
-    if (it != bookStats.end() && it->second > 0) {
+    int borrowCount = loanManager.getCirculationStats().getBookBorrows(book->getId());
+    if (borrowCount > 0) {
         std::cout << ConsoleUtil::colorText("📈 借閱統計", ConsoleUtil::Color::BRIGHT_YELLOW) << std::endl;
-        std::cout << "   歷史借閱次數: " << it->second << " 次" << std::endl;
+        std::cout << "   歷史借閱次數: " << borrowCount << " 次" << std::endl;
         
         // 計算相對熱門度
-        auto popularityInfo = calculateRelativePopularity(book->getId(), bookStats);
+        auto popularityInfo = calculateRelativePopularity(book->getId(), loanManager.getBookBorrowStats());
         std::cout << "   熱門程度: ";
         displayPopularityLevel(popularityInfo);
         
@@ -723,7 +820,7 @@ void Library::displayBookBorrowStats(const Book* book) {
             
             if (choice == 'y' || choice == 'Y') {
                 std::string username = userManager.getCurrentUser()->getUsername();
-                if (loanManager.borrowBook(username, book->getId())) {
+                if (runCirculation({{CirculationOp::Type::BORROW, username, book->getId()}})) {
                     ConsoleUtil::printSuccess("圖書借閱成功！");
                 } else {
                     ConsoleUtil::printError("圖書借閱失敗");
@@ -744,15 +841,15 @@ void Library::searchBooks() {
     ConsoleUtil::printMenuOptions(searchOptions);
     int choice = getMenuChoice();
     
-    std::vector<Book*> results = performSearch(choice);
+    BookCursor results = performSearch(choice);
     displaySearchResults(results);
 }
 
-std::vector<Book*> Library::performSearch(int searchType) {
+BookCursor Library::performSearch(int searchType) {
     switch (searchType) {
         case 1: {
             std::string query = getUserInput("請輸入搜尋關鍵字");
-            return bookManager.searchBooks(query);
+            return bookManager.searchBooksCursor(query);
         }
         case 2: {
             showAdvancedSearchHelp();
@@ -764,10 +861,10 @@ std::vector<Book*> Library::performSearch(int searchType) {
             }
             
             ConsoleUtil::printInfo("搜尋中...");
-            auto results = bookManager.advancedSearch(query);
+            auto results = bookManager.advancedSearchCursor(query);
             
             // If no results and query seems complex, suggest checking syntax
-            if (results.empty() && (SearchUtil::contains(query, "AND") ||
+            if (results.getTotalCount() == 0 && (SearchUtil::contains(query, "AND") ||
                 SearchUtil::contains(query, "OR") ||
                 SearchUtil::contains(query, "NOT")  ||
                 SearchUtil::contains(query, "=") ||
@@ -783,7 +880,7 @@ std::vector<Book*> Library::performSearch(int searchType) {
         }
         case 4: {
             std::string category = getUserInput("請輸入分類");
-            return bookManager.filterByCategory(category);
+            return bookManager.filterByCategoryCursor(category);
         }
         case 5: {
             showSearchTutorial();
@@ -795,7 +892,7 @@ std::vector<Book*> Library::performSearch(int searchType) {
     }
 }
 
-std::vector<Book*> Library::searchByYear() {
+BookCursor Library::searchByYear() {
     ConsoleUtil::printInfo("請輸入年份: ");
     int year;
     std::cin >> year;
@@ -805,17 +902,12 @@ std::vector<Book*> Library::searchByYear() {
     std::string op;
     std::getline(std::cin, op);
 
-    std::vector<Book*> results = bookManager.filterByYear(year, op);
-
-    SortUtil::sort(results, [](Book* a, Book* b) {
-        return a->getTitle() < b->getTitle();
-        });
-
-    return results;
+    // 依書名排序，只在取用頁面時才排序命中的書籍
+    return bookManager.filterByYearCursor(year, op, BookSortKey::TITLE);
 }
 
-void Library::displaySearchResults(const std::vector<Book*>& results) {
-    if (results.empty()) {
+void Library::displaySearchResults(const BookCursor& results) {
+    if (results.getTotalCount() == 0) {
         ConsoleUtil::printWarning("未找到符合條件的圖書");
         std::cout << std::endl;
         ConsoleUtil::printInfo("建議:");
@@ -828,17 +920,66 @@ void Library::displaySearchResults(const std::vector<Book*>& results) {
         return;
     }
     
-    ConsoleUtil::printSuccess("找到了 " + std::to_string(results.size()) + " 本書：");
-    std::cout << std::endl;
+    const size_t resultsPerPage = 20;
+    size_t totalPages = (results.getTotalCount() + resultsPerPage - 1) / resultsPerPage;
+    size_t currentPage = 1;
     
-    // 顯示搜尋結果列表
-    for (const auto* book : results) {
-        displayBookSummaryDetailed(book);
+    while (true) {
+        ConsoleUtil::printSuccess("找到了 " + std::to_string(results.getTotalCount()) + " 本書：");
+        if (totalPages > 1) {
+            ConsoleUtil::printInfo("第 " + std::to_string(currentPage) + " / " +
+                                   std::to_string(totalPages) + " 頁");
+        }
+        std::cout << std::endl;
+        
+        // 只取出目前這一頁的結果
+        for (const auto* book : results.fetch((currentPage - 1) * resultsPerPage, resultsPerPage)) {
+            displayBookSummaryDetailed(book);
+        }
+        
+        std::cout << std::endl;
+        
+        if (totalPages <= 1) {
+            // 提供查看詳情選項
+            offerBookDetails();
+            return;
+        }
+        
+        std::vector<std::string> navOptions;
+        std::vector<int> actions; // 1=上一頁, 2=下一頁, 3=查看詳情, 0=返回
+        if (currentPage > 1) {
+            navOptions.push_back("上一頁");
+            actions.push_back(1);
+        }
+        if (currentPage < totalPages) {
+            navOptions.push_back("下一頁");
+            actions.push_back(2);
+        }
+        navOptions.push_back("檢視書籍詳情");
+        actions.push_back(3);
+        navOptions.push_back("返回");
+        actions.push_back(0);
+        
+        ConsoleUtil::printSubtitle("導航選項");
+        ConsoleUtil::printMenuOptions(navOptions);
+        int choice = getMenuChoice();
+        
+        if (choice < 1 || choice > static_cast<int>(actions.size())) {
+            showInvalidChoice();
+            continue;
+        }
+        
+        switch (actions[choice - 1]) {
+            case 1: currentPage--; break;
+            case 2: currentPage++; break;
+            case 3:
+                offerBookDetails();
+                ConsoleUtil::pauseAndWait();
+                break;
+            default: return;
+        }
+        ConsoleUtil::clearScreen();
     }
-    
-    std::cout << std::endl;
-    // 提供查看詳情選項
-    offerBookDetails(results);
 }
 
 void Library::displayBookSummaryDetailed(const Book* book) {
@@ -850,7 +991,7 @@ void Library::displayBookSummaryDetailed(const Book* book) {
     std::cout << ")" << std::endl;
 }
 
-void Library::offerBookDetails(const std::vector<Book*>&) {
+void Library::offerBookDetails() {
     ConsoleUtil::printInfo("\n請輸入圖書 ID 以查看詳情，或輸入 0 返回: ");
     int bookId = getMenuChoice();
     
@@ -888,7 +1029,7 @@ void Library::borrowBook() {
     int bookId = getBookIdChoice("請輸入圖書 ID");
     std::string username = getBorrowerUsername();
     
-    if (loanManager.borrowBook(username, bookId)) {
+    if (runCirculation({{CirculationOp::Type::BORROW, username, bookId}})) {
         ConsoleUtil::printSuccess("圖書借閱成功！");
     } else {
         ConsoleUtil::printError("圖書借閱失敗，請檢查圖書 ID 和使用者名稱");
@@ -897,22 +1038,22 @@ void Library::borrowBook() {
     ConsoleUtil::pauseAndWait();
 }
 
-std::vector<Book> Library::getAvailableBooks() {
-    std::vector<Book> available;
+std::vector<const Book*> Library::getAvailableBooks() {
+    std::vector<const Book*> available;
     for (const auto& book : bookManager.getAllBooks()) {
         if (book.getAvailableCopies() > 0) {
-            available.push_back(book);
+            available.push_back(&book);
         }
     }
     return available;
 }
 
-void Library::displayAvailableBooks(const std::vector<Book>& books) {
-    for (const auto& book : books) {
-        std::cout << ConsoleUtil::colorText("[ID: " + std::to_string(book.getId()) + "]", 
+void Library::displayAvailableBooks(const std::vector<const Book*>& books) {
+    for (const Book* book : books) {
+        std::cout << ConsoleUtil::colorText("[ID: " + std::to_string(book->getId()) + "]", 
                                           ConsoleUtil::Color::BRIGHT_YELLOW);
-        std::cout << " " << book.getTitle();
-        std::cout << ConsoleUtil::colorText(" (" + std::to_string(book.getAvailableCopies()) + " 本可借)", 
+        std::cout << " " << book->getTitle();
+        std::cout << ConsoleUtil::colorText(" (" + std::to_string(book->getAvailableCopies()) + " 本可借)", 
                                           ConsoleUtil::Color::BRIGHT_GREEN);
         std::cout << std::endl;
     }
@@ -944,7 +1085,7 @@ void Library::returnBook() {
     
     int bookId = getBookIdChoice("請輸入要歸還的圖書 ID");
     
-    if (loanManager.returnBook(targetUser, bookId)) {
+    if (runCirculation({{CirculationOp::Type::RETURN, targetUser, bookId}})) {
         ConsoleUtil::printSuccess("圖書歸還成功！");
         showFineIfAny(targetUser, bookId);
     } else {
@@ -964,16 +1105,7 @@ std::string Library::getTargetUserForReturn() {
 }
 
 std::vector<LoanRecord*> Library::getActiveLoansForUser(const std::string& username) {
-    auto userLoans = loanManager.getLoansForUser(username);
-    std::vector<LoanRecord*> activeLoans;
-    
-    for (auto* loan : userLoans) {
-        if (!loan->isReturned()) {
-            activeLoans.push_back(loan);
-        }
-    }
-    
-    return activeLoans;
+    return loanManager.getActiveLoansForUser(username);
 }
 
 void Library::showNoActiveLoansMessage(const std::string& username) {
@@ -1014,8 +1146,10 @@ void Library::displayLoanRecord(const LoanRecord* loan, const Book* book, bool s
 }
 
 void Library::showFineIfAny(const std::string& username, int bookId) {
+    // 從最近的紀錄往回找，取得剛歸還的那一筆
     auto userLoans = loanManager.getLoansForUser(username);
-    for (auto* loan : userLoans) {
+    for (auto it = userLoans.rbegin(); it != userLoans.rend(); ++it) {
+        LoanRecord* loan = *it;
         if (loan->getBookId() == bookId && loan->isReturned()) {
             double fine = loanManager.calculateFine(*loan);
             if (fine > 0) {
@@ -1026,6 +1160,179 @@ void Library::showFineIfAny(const std::string& username, int bookId) {
     }
 }
 
+// 借還交易
+bool Library::commitCirculation(const std::vector<CirculationOp>& ops, std::vector<std::string>& errors) {
+    if (ops.empty()) {
+        return true;
+    }
+    
+    if (!circulation.apply(ops, errors)) {
+        return false;
+    }
+    
+    // 整批只存檔一次
+    bool booksSaved = bookManager.saveToFile(bookFile);
+    bool loansSaved = loanManager.saveToFile(loanFile);
+    if (!booksSaved || !loansSaved) {
+        errors.push_back("借還已完成，但儲存資料時發生錯誤");
+    }
+    return true;
+}
+
+bool Library::runCirculation(const std::vector<CirculationOp>& ops) {
+    std::vector<std::string> errors;
+    bool committed = commitCirculation(ops, errors);
+    for (const auto& error : errors) {
+        ConsoleUtil::printError(error);
+    }
+    return committed;
+}
+
+void Library::circulationCart() {
+    std::string username = getBorrowerUsername();
+    if (username.empty()) {
+        return;
+    }
+    
+    std::vector<CirculationOp> cart;
+    
+    while (true) {
+        ConsoleUtil::printTitleWithSubtitle("批次借還", "讀者: " + username);
+        displayCart(cart);
+        
+        std::vector<std::string> options = {
+            "加入借閱", "加入歸還", "移除項目", "確認送出", "取消"
+        };
+        ConsoleUtil::printMenuOptions(options);
+        
+        switch (getMenuChoice()) {
+            case 1: addBorrowToCart(cart, username); break;
+            case 2: addReturnToCart(cart, username); break;
+            case 3: removeFromCart(cart); break;
+            case 4: {
+                if (cart.empty()) {
+                    ConsoleUtil::printWarning("清單是空的");
+                    ConsoleUtil::pauseAndWait();
+                    break;
+                }
+                if (!runCirculation(cart)) {
+                    ConsoleUtil::printError("交易未執行，請修正清單後再送出");
+                    ConsoleUtil::pauseAndWait();
+                    break;
+                }
+                
+                ConsoleUtil::printSuccess("已完成 " + std::to_string(cart.size()) + " 筆借還");
+                for (const auto& op : cart) {
+                    if (op.type == CirculationOp::Type::RETURN) {
+                        showFineIfAny(op.username, op.bookId);
+                    }
+                }
+                ConsoleUtil::pauseAndWait();
+                return;
+            }
+            case 5:
+                ConsoleUtil::printInfo("已取消，未做任何變更");
+                ConsoleUtil::pauseAndWait();
+                return;
+            default:
+                showInvalidChoice();
+        }
+    }
+}
+
+void Library::displayCart(const std::vector<CirculationOp>& cart) {
+    if (cart.empty()) {
+        ConsoleUtil::printInfo("清單目前沒有項目");
+        std::cout << std::endl;
+        return;
+    }
+    
+    for (size_t i = 0; i < cart.size(); ++i) {
+        const CirculationOp& op = cart[i];
+        const Book* book = bookManager.getBook(op.bookId);
+        bool borrowing = op.type == CirculationOp::Type::BORROW;
+        
+        std::cout << std::setw(3) << (i + 1) << ". "
+                  << ConsoleUtil::colorText(borrowing ? "[借閱]" : "[歸還]",
+                                            borrowing ? ConsoleUtil::Color::BRIGHT_GREEN
+                                                      : ConsoleUtil::Color::BRIGHT_CYAN)
+                  << " [ID: " << op.bookId << "] "
+                  << (book ? book->getTitle() : std::string("(已刪除的圖書)")) << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+void Library::addBorrowToCart(std::vector<CirculationOp>& cart, const std::string& username) {
+    int bookId = getBookIdChoice("請輸入要借閱的圖書 ID");
+    const Book* book = bookManager.getBook(bookId);
+    if (!book) {
+        ConsoleUtil::printError("找不到此圖書");
+        ConsoleUtil::pauseAndWait();
+        return;
+    }
+    
+    // 提早提示冊數不足；送出時仍會整批檢查
+    int inCart = 0;
+    for (const auto& op : cart) {
+        if (op.bookId == bookId) {
+            inCart += op.type == CirculationOp::Type::BORROW ? 1 : -1;
+        }
+    }
+    if (book->getAvailableCopies() - inCart <= 0) {
+        ConsoleUtil::printError("《" + book->getTitle() + "》目前沒有可借的冊數");
+        ConsoleUtil::pauseAndWait();
+        return;
+    }
+    
+    cart.push_back({CirculationOp::Type::BORROW, username, bookId});
+}
+
+void Library::addReturnToCart(std::vector<CirculationOp>& cart, const std::string& username) {
+    auto activeLoans = loanManager.getActiveLoansForUser(username);
+    if (activeLoans.empty()) {
+        ConsoleUtil::printWarning("該讀者沒有需要歸還的圖書");
+        ConsoleUtil::pauseAndWait();
+        return;
+    }
+    
+    displayActiveLoans(activeLoans, username);
+    int bookId = getBookIdChoice("請輸入要歸還的圖書 ID");
+    
+    int active = 0;
+    for (const auto* loan : activeLoans) {
+        if (loan->getBookId() == bookId) {
+            active++;
+        }
+    }
+    int inCart = 0;
+    for (const auto& op : cart) {
+        if (op.type == CirculationOp::Type::RETURN && op.bookId == bookId) {
+            inCart++;
+        }
+    }
+    if (inCart >= active) {
+        ConsoleUtil::printError(active == 0 ? "該讀者沒有借閱此圖書" : "此圖書已全部加入歸還清單");
+        ConsoleUtil::pauseAndWait();
+        return;
+    }
+    
+    cart.push_back({CirculationOp::Type::RETURN, username, bookId});
+}
+
+void Library::removeFromCart(std::vector<CirculationOp>& cart) {
+    if (cart.empty()) {
+        return;
+    }
+    
+    ConsoleUtil::printInfo("請輸入要移除的項目編號: ");
+    int index = getMenuChoice();
+    if (index < 1 || index > static_cast<int>(cart.size())) {
+        showInvalidChoice();
+        return;
+    }
+    cart.erase(cart.begin() + (index - 1));
+}
+
 // 編輯圖書
 void Library::editBook() {
     if (!userManager.hasPermission(Role::Staff)) {
@@ -1066,8 +1373,10 @@ void Library::runEditMenu(Book& book) {
         } else if (choice == 10) {
             manageBookCategories(book);
         } else if (choice == 11) {
-            if (saveBookChanges(book)) return;
+            manageBookCopies(book);
         } else if (choice == 12) {
+            if (saveBookChanges(book)) return;
+        } else if (choice == 13) {
             ConsoleUtil::printWarning("已取消編輯");
             ConsoleUtil::pauseAndWait();
             return;
@@ -1089,6 +1398,7 @@ std::vector<std::string> Library::createEditOptions(const Book& book) {
         "複本數量 (目前: " + std::to_string(book.getTotalCopies()) + ")",
         "摘要",
         "管理分類",
+        "管理單冊（條碼、狀態、位置）",
         "保存更改並退出",
         "取消編輯"
     };
@@ -1176,6 +1486,80 @@ void Library::manageBookCategories(Book& book) {
     }
 }
 
+void Library::manageBookCopies(Book& book) {
+    while (true) {
+        ConsoleUtil::printTitle("管理單冊");
+        displayBookCopies(book.getId());
+        ConsoleUtil::printInfo("單冊的狀態與位置變更會立即儲存");
+        
+        std::vector<std::string> options = {"設定狀態", "設定位置", "返回主編輯選單"};
+        ConsoleUtil::printMenuOptions(options);
+        
+        int choice = getMenuChoice();
+        
+        if (choice == 1) {
+            std::string barcode = getUserInput("條碼");
+            std::vector<std::string> statusOptions = {"在架", "維修中", "遺失"};
+            ConsoleUtil::printMenuOptions(statusOptions);
+            int statusChoice = getMenuChoice();
+            const CopyStatus statuses[] = {CopyStatus::AVAILABLE, CopyStatus::REPAIR, CopyStatus::LOST};
+            
+            CopyInventory::CopyRef ref;
+            if (statusChoice < 1 || statusChoice > 3) {
+                showInvalidChoice();
+            } else if (!bookManager.getInventory().find(barcode, ref) || ref.bookId != book.getId()) {
+                ConsoleUtil::printError("本書沒有條碼 " + barcode);
+            } else if (!bookManager.setCopyStatus(barcode, statuses[statusChoice - 1])) {
+                ConsoleUtil::printError("借出中的冊須經由歸還變更狀態");
+            } else {
+                bookManager.saveToFile(bookFile);
+                ConsoleUtil::printSuccess("已更新 " + barcode + " 的狀態");
+            }
+        } else if (choice == 2) {
+            std::string barcode = getUserInput("條碼");
+            CopyInventory::CopyRef ref;
+            if (!bookManager.getInventory().find(barcode, ref) || ref.bookId != book.getId()) {
+                ConsoleUtil::printError("本書沒有條碼 " + barcode);
+            } else {
+                bookManager.setCopyLocation(barcode, getUserInput("新位置"));
+                bookManager.saveToFile(bookFile);
+                ConsoleUtil::printSuccess("已更新 " + barcode + " 的位置");
+            }
+        } else if (choice == 3) {
+            break;
+        } else {
+            showInvalidChoice();
+        }
+        
+        // 冊數由逐冊館藏推得，同步回編輯中的副本
+        const Book* stored = bookManager.getBook(book.getId());
+        if (stored) {
+            book.setTotalCopies(stored->getTotalCopies());
+            book.setAvailableCopies(stored->getAvailableCopies());
+        }
+    }
+}
+
+void Library::displayBookCopies(int bookId) {
+    const auto& copies = bookManager.getInventory().getCopies(bookId);
+    if (copies.empty()) {
+        std::cout << "   (沒有單冊紀錄)" << std::endl;
+        return;
+    }
+    
+    for (const auto& copy : copies) {
+        ConsoleUtil::Color color = copy.status == CopyStatus::AVAILABLE ? ConsoleUtil::Color::BRIGHT_GREEN :
+                                   copy.status == CopyStatus::ON_LOAN ? ConsoleUtil::Color::BRIGHT_YELLOW :
+                                   ConsoleUtil::Color::BRIGHT_RED;
+        std::cout << "   " << copy.barcode << "  "
+                  << ConsoleUtil::colorText(CopyInventory::statusLabel(copy.status), color);
+        if (!copy.location.empty()) {
+            std::cout << "  " << copy.location;
+        }
+        std::cout << std::endl;
+    }
+}
+
 void Library::displayCurrentCategories(const Book& book) {
     const auto& categories = book.getCategories();
     std::cout << "目前分類: ";
@@ -1204,6 +1588,7 @@ void Library::removeCategoryFromBook(Book& book) {
 
 bool Library::saveBookChanges(Book& book) {
     if (bookManager.updateBook(book)) {
+        loanManager.setBookCategories(book.getId(), book.getCategories());
         ConsoleUtil::printSuccess("圖書資訊更新成功");
         bookManager.saveToFile(bookFile);
         ConsoleUtil::pauseAndWait();
@@ -1221,6 +1606,12 @@ void Library::displayUserLoans() {
     
     auto userLoans = loanManager.getLoansForUser(username);
     
+    // 封存的歷史紀錄只開啟含有該讀者的區段
+    std::vector<LoanRecord> archivedLoans = loanManager.getArchive().loansForUser(username);
+    for (auto& loan : archivedLoans) {
+        userLoans.push_back(&loan);
+    }
+    
     if (userLoans.empty()) {
         ConsoleUtil::printWarning("您沒有借閱記錄");
         ConsoleUtil::pauseAndWait();
@@ -1234,20 +1625,27 @@ void Library::displayUserLoans() {
 }
 
 void Library::sortLoansByStatus(std::vector<LoanRecord*>& loans) {
-    SortUtil::sort(loans, [](const LoanRecord* a, const LoanRecord* b) {
-        // 目前借閱的排在前面
-        if (a->isReturned() != b->isReturned()) {
-            return !a->isReturned();
-        }
-        
-        // 目前借閱的按到期日排序（最早的在前）
-        if (!a->isReturned()) {
-            return a->getDueDate() < b->getDueDate();
+    // 目前借閱的排在前面，按到期日排序（最早的在前）；
+    // 已歸還的按歸還日期排序（最近的在前）。日期皆為整數時間戳記，使用基數排序
+    std::vector<LoanRecord*> currentLoans;
+    std::vector<LoanRecord*> returnedLoans;
+    for (LoanRecord* loan : loans) {
+        if (loan->isReturned()) {
+            returnedLoans.push_back(loan);
+        } else {
+            currentLoans.push_back(loan);
         }
-        
-        // 已歸還的按歸還日期排序（最近的在前）
-        return a->getReturnDate() > b->getReturnDate();
+    }
+    
+    SortUtil::radixSort(currentLoans, [](const LoanRecord* loan) {
+        return static_cast<long long>(loan->getDueDate());
     });
+    SortUtil::radixSort(returnedLoans, [](const LoanRecord* loan) {
+        return static_cast<long long>(loan->getReturnDate());
+    }, true);
+    
+    loans = std::move(currentLoans);
+    loans.insert(loans.end(), returnedLoans.begin(), returnedLoans.end());
 }
 
 void Library::displayCurrentAndReturnedLoans(const std::vector<LoanRecord*>& loans) {
@@ -1463,7 +1861,7 @@ void Library::handleRecommendationInteraction(const std::vector<std::pair<int, d
         
         std::string username = userManager.getCurrentUser()->getUsername();
         
-        if (loanManager.borrowBook(username, bookId)) {
+        if (runCirculation({{CirculationOp::Type::BORROW, username, bookId}})) {
             ConsoleUtil::printSuccess("圖書借閱成功！");
             
             recommendationEngine.initialize(bookManager, loanManager);
@@ -1497,29 +1895,29 @@ void Library::showWelcomeRecommendations(const std::string& username) {
 void Library::showPopularBooksForNewUser(const std::string& username) {
     std::cout << "===== 歡迎，" << username << "！以下是熱門圖書推薦 =====" << std::endl;
     
-    auto bookStats = loanManager.getBookBorrowStats();
+    const auto& bookStats = loanManager.getBookBorrowStats();
     std::vector<std::pair<int, int>> popularBooks;
     
+    // 先篩出可借閱的書，只需選出前 5 名
     for (const auto& stat : bookStats) {
-        popularBooks.push_back(stat);
+        const Book* book = bookManager.getBook(stat.first);
+        if (book && book->getAvailableCopies() > 0) {
+            popularBooks.push_back(stat);
+        }
     }
     
-    SortUtil::sort(popularBooks, [](const auto& a, const auto& b) {
+    SortUtil::topK(popularBooks, 5, [](const auto& a, const auto& b) {
         return a.second > b.second;
     });
     
     int count = 0;
     for (const auto& bookStat : popularBooks) {
-        if (count >= 5) break;
-        
         const Book* book = bookManager.getBook(bookStat.first);
-        if (book && book->getAvailableCopies() > 0) {
-            std::cout << (count + 1) << ". [" << book->getId() << "] " 
-                      << book->getTitle() 
-                      << std::string(35 - std::min(book->getTitle().length(), size_t(34)), ' ')
-                      << "(熱門借閱：" << bookStat.second << " 次)" << std::endl;
-            count++;
-        }
+        std::cout << (count + 1) << ". [" << book->getId() << "] " 
+                  << book->getTitle() 
+                  << std::string(35 - std::min(book->getTitle().length(), size_t(34)), ' ')
+                  << "(熱門借閱：" << bookStat.second << " 次)" << std::endl;
+        count++;
     }
     
     if (count == 0) {
@@ -1595,31 +1993,31 @@ void Library::displayRecommendationItem(const Book* book, double hybridScore,
 void Library::showPopularBooksRecommendation() {
     ConsoleUtil::printSubtitle("熱門圖書推薦");
     
-    auto bookStats = loanManager.getBookBorrowStats();
+    const auto& bookStats = loanManager.getBookBorrowStats();
     std::vector<std::pair<int, int>> popularBooks;
     
+    // 先篩出可借閱的書，只需選出前 5 名
     for (const auto& stat : bookStats) {
-        popularBooks.push_back(stat);
+        const Book* book = bookManager.getBook(stat.first);
+        if (book && book->getAvailableCopies() > 0) {
+            popularBooks.push_back(stat);
+        }
     }
     
-    SortUtil::sort(popularBooks, [](const auto& a, const auto& b) {
+    SortUtil::topK(popularBooks, 5, [](const auto& a, const auto& b) {
         return a.second > b.second;
     });
     
     int count = 0;
     for (const auto& bookStat : popularBooks) {
-        if (count >= 5) break; // 只顯示前5本
-        
         const Book* book = bookManager.getBook(bookStat.first);
-        if (book && book->getAvailableCopies() > 0) {
-            std::cout << (count + 1) << ". ";
-            std::cout << ConsoleUtil::colorText("[" + std::to_string(book->getId()) + "]", 
-                                              ConsoleUtil::Color::BRIGHT_YELLOW);
-            std::cout << " " << ConsoleUtil::colorText(book->getTitle(), ConsoleUtil::Color::BRIGHT_WHITE);
-            std::cout << " - " << book->getAuthor();
-            std::cout << " (借閱次數: " << bookStat.second << ")" << std::endl;
-            count++;
-        }
+        std::cout << (count + 1) << ". ";
+        std::cout << ConsoleUtil::colorText("[" + std::to_string(book->getId()) + "]", 
+                                          ConsoleUtil::Color::BRIGHT_YELLOW);
+        std::cout << " " << ConsoleUtil::colorText(book->getTitle(), ConsoleUtil::Color::BRIGHT_WHITE);
+        std::cout << " - " << book->getAuthor();
+        std::cout << " (借閱次數: " << bookStat.second << ")" << std::endl;
+        count++;
     }
     
     if (count == 0) {
@@ -1636,16 +2034,11 @@ void Library::displayOverdueLoans() {
     ConsoleUtil::printTitle("逾期圖書");
     
     auto overdueLoans = loanManager.getOverdueLoans();
+    Role userRole = userManager.getCurrentUser()->getRole();
     
     if (overdueLoans.empty()) {
         ConsoleUtil::printSuccess("目前沒有逾期圖書");
-        ConsoleUtil::pauseAndWait();
-        return;
-    }
-    
-    Role userRole = userManager.getCurrentUser()->getRole();
-    
-    if (userRole == Role::Reader) {
+    } else if (userRole == Role::Reader) {
         // 讀者只能看自己的逾期記錄
         displayReaderOverdueLoans(overdueLoans);
     } else {
@@ -1653,9 +2046,34 @@ void Library::displayOverdueLoans() {
         displayAllOverdueLoans(overdueLoans);
     }
     
+    showLoansDueSoon(userRole == Role::Reader);
+    
     ConsoleUtil::pauseAndWait();
 }
 
+void Library::showLoansDueSoon(bool currentUserOnly) {
+    const int dueSoonDays = 3;
+    auto dueSoon = loanManager.getLoansDueWithin(dueSoonDays);
+    
+    size_t count = 0;
+    if (currentUserOnly) {
+        std::string username = userManager.getCurrentUser()->getUsername();
+        for (const auto* loan : dueSoon) {
+            if (loan->getUsername() == username) {
+                count++;
+            }
+        }
+    } else {
+        count = dueSoon.size();
+    }
+    
+    if (count > 0) {
+        std::cout << std::endl;
+        ConsoleUtil::printInfo("另有 " + std::to_string(count) + " 本圖書將在 " +
+                               std::to_string(dueSoonDays) + " 天內到期");
+    }
+}
+
 void Library::displayReaderOverdueLoans(const std::vector<LoanRecord*>& overdueLoans) {
     std::string username = userManager.getCurrentUser()->getUsername();
     std::vector<LoanRecord*> userOverdueLoans;
@@ -1673,14 +2091,19 @@ void Library::displayReaderOverdueLoans(const std::vector<LoanRecord*>& overdueL
     
     ConsoleUtil::printWarning("您有 " + std::to_string(userOverdueLoans.size()) + " 本逾期圖書:");
     
+    // 同一時間點一次算出所有罰款
+    time_t now = time(nullptr);
+    std::vector<double> fines = loanManager.calculateFines(userOverdueLoans, now);
+    
     double totalFine = 0.0;
-    for (const auto* loan : userOverdueLoans) {
+    for (size_t i = 0; i < userOverdueLoans.size(); ++i) {
+        const LoanRecord* loan = userOverdueLoans[i];
         const Book* book = bookManager.getBook(loan->getBookId());
         if (book) {
             std::cout << "[" << loan->getBookId() << "] " << book->getTitle() << std::endl;
-            std::cout << "   逾期: " << loan->getDaysOverdue() << " 天" << std::endl;
+            std::cout << "   逾期: " << loan->getDaysOverdue(now) << " 天" << std::endl;
             
-            double fine = loanManager.calculateFine(*loan);
+            double fine = fines[i];
             totalFine += fine;
             std::cout << "   罰款: $" << std::fixed << std::setprecision(2) << fine << std::endl;
             std::cout << "---" << std::endl;
@@ -1691,11 +2114,13 @@ void Library::displayReaderOverdueLoans(const std::vector<LoanRecord*>& overdueL
 }
 
 void Library::displayAllOverdueLoans(const std::vector<LoanRecord*>& overdueLoans) {
-    // 按使用者分組
-    std::unordered_map<std::string, std::vector<LoanRecord*>> userOverdueLoans;
+    // 先以同一時間點批次算出所有罰款，再按使用者分組
+    time_t now = time(nullptr);
+    std::vector<double> fines = loanManager.calculateFines(overdueLoans, now);
+    std::unordered_map<std::string, std::vector<size_t>> userOverdueLoans;
     
-    for (auto* loan : overdueLoans) {
-        userOverdueLoans[loan->getUsername()].push_back(loan);
+    for (size_t i = 0; i < overdueLoans.size(); ++i) {
+        userOverdueLoans[overdueLoans[i]->getUsername()].push_back(i);
     }
     
     ConsoleUtil::printInfo("總計 " + std::to_string(overdueLoans.size()) + " 本逾期圖書，" + 
@@ -1705,13 +2130,14 @@ void Library::displayAllOverdueLoans(const std::vector<LoanRecord*>& overdueLoan
         std::cout << "\n=== " << userLoan.first << " (" << userLoan.second.size() << " 本逾期) ===" << std::endl;
         
         double userTotalFine = 0.0;
-        for (const auto* loan : userLoan.second) {
+        for (size_t index : userLoan.second) {
+            const LoanRecord* loan = overdueLoans[index];
             const Book* book = bookManager.getBook(loan->getBookId());
             if (book) {
                 std::cout << "[" << loan->getBookId() << "] " << book->getTitle() << std::endl;
-                std::cout << "   逾期: " << loan->getDaysOverdue() << " 天" << std::endl;
+                std::cout << "   逾期: " << loan->getDaysOverdue(now) << " 天" << std::endl;
                 
-                double fine = loanManager.calculateFine(*loan);
+                double fine = fines[index];
                 userTotalFine += fine;
                 std::cout << "   罰款: $" << std::fixed << std::setprecision(2) << fine << std::endl;
             }
@@ -1897,7 +2323,7 @@ void Library::showStatistics() {
         // 顯示統計總覽
         std::vector<std::string> options = {
             "📊 借閱次數統計", "📚 圖書分類統計", "📈 月度借閱統計", 
-            "📋 系統總覽", "🔙 返回主選單"
+            "📋 系統總覽", "🗄️ 查詢快取統計", "🩺 流通資料一致性檢查", "📦 借閱歷史封存", "🔙 返回主選單"
         };
         
         ConsoleUtil::printTitleWithSubtitle("圖書館管理系統", "統計數據中心");
@@ -1915,7 +2341,10 @@ void Library::showStatistics() {
             case 2: showCategoryStats(); break; 
             case 3: showMonthlyStats(); break;
             case 4: showSystemOverview(); break;
-            case 5: return;
+            case 5: showQueryCacheStats(); break;
+            case 6: showCirculationAudit(); break;
+            case 7: showLoanArchive(); break;
+            case 8: return;
             default: showInvalidChoice();
         }
     }
@@ -1993,12 +2422,11 @@ void Library::showSearchTutorial() {
 
 void Library::showQuickStatsSummary() {
     auto allBooks = bookManager.getAllBooks();
-    auto overdueLoans = loanManager.getOverdueLoans();
-    auto bookStats = loanManager.getBookBorrowStats();
-    auto userStats = loanManager.getUserBorrowStats();
+    size_t overdueCount = loanManager.getLoanColumns().countOverdue(time(nullptr));
+    const CirculationStats& stats = loanManager.getCirculationStats();
     
     int totalBooks = allBooks.size();
-    int totalBorrows = 0;
+    long long totalBorrows = stats.getTotalBorrows();
     int activeLoans = 0;
     int availableBooks = 0;
     
@@ -2006,10 +2434,6 @@ void Library::showQuickStatsSummary() {
         availableBooks += book.getAvailableCopies();
     }
     
-    for (const auto& stat : bookStats) {
-        totalBorrows += stat.second;
-    }
-    
     for (const auto& book : allBooks) {
         activeLoans += (book.getTotalCopies() - book.getAvailableCopies());
     }
@@ -2025,9 +2449,9 @@ void Library::showQuickStatsSummary() {
               << " │ " << ConsoleUtil::colorText("目前借出", ConsoleUtil::Color::BRIGHT_YELLOW)
               << ": " << std::setw(10) << activeLoans << " │" << std::endl;
     std::cout << "│ " << ConsoleUtil::colorText("逾期圖書", ConsoleUtil::Color::BRIGHT_RED) 
-              << ": " << std::setw(10) << overdueLoans.size()
+              << ": " << std::setw(10) << overdueCount
               << " │ " << ConsoleUtil::colorText("活躍用戶", ConsoleUtil::Color::BRIGHT_MAGENTA)
-              << ": " << std::setw(10) << userStats.size() << " │" << std::endl;
+              << ": " << std::setw(10) << stats.getUserCounts().size() << " │" << std::endl;
     std::cout << "└─────────────────────────────────────────────────────────────┘" << std::endl << std::endl;
 }
 
@@ -2035,7 +2459,7 @@ void Library::showBorrowStats() {
     ConsoleUtil::clearScreen();
     ConsoleUtil::printTitle("借閱統計分析");
     
-    auto bookStats = loanManager.getBookBorrowStats();
+    const auto& bookStats = loanManager.getBookBorrowStats();
     
     if (bookStats.empty()) {
         ConsoleUtil::printWarning("暫無借閱數據");
@@ -2057,32 +2481,24 @@ void Library::showBorrowStats() {
         }
     }
     
-    SortUtil::sort(topBooks, [](const auto& a, const auto& b) {
+    SortUtil::topK(topBooks, 15, [](const auto& a, const auto& b) {
         return a.second > b.second;
     });
     
-    if (topBooks.size() > 15) {
-        topBooks.resize(15);
-    }
-    
     VisualizationUtil::drawBarChart(topBooks, "📚 熱門圖書排行榜 (Top 15)", 40);
     
     // 用戶活躍度排行榜
-    auto userStats = loanManager.getUserBorrowStats();
+    const auto& userStats = loanManager.getUserBorrowStats();
     std::vector<std::pair<std::string, int>> topUsers;
     
     for (const auto& stat : userStats) {
         topUsers.push_back({stat.first, stat.second});
     }
     
-    SortUtil::sort(topUsers, [](const auto& a, const auto& b) {
+    SortUtil::topK(topUsers, 10, [](const auto& a, const auto& b) {
         return a.second > b.second;
     });
     
-    if (topUsers.size() > 10) {
-        topUsers.resize(10);
-    }
-    
     VisualizationUtil::drawBarChart(topUsers, "👤 活躍讀者排行榜 (Top 10)", 40);
     
     // 借閱數據摘要
@@ -2127,7 +2543,6 @@ void Library::showCategoryStats() {
     ConsoleUtil::printTitle("圖書分類統計");
     
     std::unordered_map<std::string, int> categoryCount;
-    std::unordered_map<std::string, int> categoryBorrows;
     
     // 統計圖書數量分佈
     for (const auto& book : bookManager.getAllBooks()) {
@@ -2143,22 +2558,8 @@ void Library::showCategoryStats() {
     
     VisualizationUtil::drawPieChart(categoryCount, "📚 圖書類別分佈");
     
-    // 統計借閱次數分佈
-    auto bookStats = loanManager.getBookBorrowStats();
-    
-    for (const auto& stat : bookStats) {
-        const Book* book = bookManager.getBook(stat.first);
-        if (book) {
-            const auto& categories = book->getCategories();
-            if (categories.empty()) {
-                categoryBorrows["未分類"] += stat.second;
-            } else {
-                for (const auto& category : categories) {
-                    categoryBorrows[category] += stat.second;
-                }
-            }
-        }
-    }
+    // 借閱次數分佈直接讀取物化的分類彙總
+    const auto& categoryBorrows = loanManager.getCirculationStats().getCategoryCounts();
     
     VisualizationUtil::drawBarChart(categoryBorrows, "📊 各類別借閱熱度", 40);
     
@@ -2173,13 +2574,13 @@ void Library::showCategoryEfficiency(const std::unordered_map<std::string, int>&
     std::vector<std::pair<std::string, double>> efficiency;
     
     for (const auto& count : categoryCount) {
-        auto borrowIt = SearchUtil::mapFind(categoryBorrows, count.first);
+        auto borrowIt = categoryBorrows.find(count.first);
         int borrows = (borrowIt != categoryBorrows.end()) ? borrowIt->second : 0;
         double eff = count.second > 0 ? (double)borrows / count.second : 0;
         efficiency.push_back({count.first, eff});
     }
     
-    SortUtil::sort(efficiency, [](const auto& a, const auto& b) {
+    SortUtil::topK(efficiency, 5, [](const auto& a, const auto& b) {
         return a.second > b.second;
     });
     
@@ -2203,41 +2604,20 @@ void Library::showMonthlyStats() {
     ConsoleUtil::clearScreen();
     ConsoleUtil::printTitle("月度借閱趨勢分析");
     
-    auto monthlyStats = loanManager.getMonthlyStats();
+    const CirculationStats& stats = loanManager.getCirculationStats();
     std::vector<std::pair<std::string, int>> monthlyData;
     
-    time_t now = time(nullptr);
-    struct tm* timeinfo = localtime(&now);
-    int currentYear = timeinfo->tm_year + 1900;
-    int currentMonth = timeinfo->tm_mon + 1;
+    int currentMonth = CalendarUtil::monthOrdinal(time(nullptr));
     
-    // 生成最近12個月的數據
+    // 生成最近12個月的數據（月序連續，直接讀取稠密陣列）
     for (int i = 11; i >= 0; i--) {
-        int month = currentMonth - i;
-        int year = currentYear;
-        
-        if (month <= 0) {
-            month += 12;
-            year -= 1;
-        }
-        
-        char buffer[20];
-        snprintf(buffer, sizeof(buffer), "%04d-%02d", year, month);
-        std::string monthKey = buffer;
+        int monthOrdinal = currentMonth - i;
         
         // 格式化月份顯示
         char displayBuffer[10];
-        snprintf(displayBuffer, sizeof(displayBuffer), "%02d月", month);
-        
-        int count = 0;
-        for (const auto& stat : monthlyStats) {
-            if (stat.first == monthKey) {
-                count = stat.second;
-                break;
-            }
-        }
+        snprintf(displayBuffer, sizeof(displayBuffer), "%02d月", CalendarUtil::monthOfMonth(monthOrdinal));
         
-        monthlyData.push_back({displayBuffer, count});
+        monthlyData.push_back({displayBuffer, stats.getMonthlyBorrows().get(monthOrdinal)});
     }
     
     VisualizationUtil::drawLineChart(monthlyData, "📈 月度借閱趨勢 (近12個月)", 50);
@@ -2280,6 +2660,194 @@ void Library::showMonthlyStatsSummary(const std::vector<std::pair<std::string, i
     std::cout << "└─────────────────────────────────────────────────────────────┘" << std::endl << std::endl;
 }
 
+void Library::showQueryCacheStats() {
+    ConsoleUtil::clearScreen();
+    ConsoleUtil::printTitle("查詢快取統計");
+    
+    QueryCacheStats stats = bookManager.getQueryCacheStats();
+    size_t lookups = stats.hits + stats.misses;
+    double hitRate = lookups > 0 ? (double)stats.hits / lookups * 100 : 0;
+    
+    std::cout << "🗄️ " << ConsoleUtil::colorText("多條件搜尋結果快取 (LRU)", ConsoleUtil::Color::BRIGHT_CYAN) << std::endl;
+    std::cout << "┌─────────────────────────────────────────────────────────────┐" << std::endl;
+    std::cout << "│ 命中次數: " << std::setw(10) << stats.hits
+              << " │ 未命中次數: " << std::setw(10) << stats.misses << "       │" << std::endl;
+    std::cout << "│ 命中率: " << std::setw(11) << std::fixed << std::setprecision(1) << hitRate << "%"
+              << " │ 快取項目: " << std::setw(6) << stats.entries << " / " << std::setw(6) << stats.capacity << " │" << std::endl;
+    std::cout << "│ 容量淘汰: " << std::setw(10) << stats.evictions
+              << " │ 異動失效: " << std::setw(12) << stats.invalidations << "       │" << std::endl;
+    std::cout << "│ 記憶體用量: " << std::setw(8) << stats.memoryBytes << " B"
+              << " │ 館藏版本: " << std::setw(12) << bookManager.getCatalogEpoch() << "       │" << std::endl;
+    std::cout << "└─────────────────────────────────────────────────────────────┘" << std::endl << std::endl;
+    
+    ConsoleUtil::printInfo("新增、編輯、刪除或借還圖書時，快取會自動失效");
+    ConsoleUtil::pauseAndWait();
+}
+
+void Library::showCirculationAudit() {
+    ConsoleUtil::clearScreen();
+    ConsoleUtil::printTitle("流通資料一致性檢查");
+    
+    CirculationAudit audit = circulation.verify();
+    displayCirculationAudit(audit);
+    
+    if (!audit.drifts.empty()) {
+        ConsoleUtil::printInfo("是否依借閱紀錄校正逐冊借出狀態與可借冊數？(y/n): ");
+        char choice;
+        std::cin >> choice;
+        clearInputBuffer();
+        
+        if (choice == 'y' || choice == 'Y') {
+            size_t fixed = circulation.reconcileCopies();
+            if (bookManager.saveToFile(bookFile) && loanManager.saveToFile(loanFile)) {
+                ConsoleUtil::printSuccess("已校正 " + std::to_string(fixed) + " 本圖書的可借冊數");
+            } else {
+                ConsoleUtil::printError("已校正 " + std::to_string(fixed) + " 本圖書，但儲存資料時發生錯誤");
+            }
+        }
+    }
+    
+    ConsoleUtil::pauseAndWait();
+}
+
+void Library::showLoanArchive() {
+    while (true) {
+        ConsoleUtil::clearScreen();
+        ConsoleUtil::printTitle("借閱歷史封存");
+        displayLoanArchive();
+        
+        std::vector<std::string> options = {"設定封存期限", "立即封存", "返回"};
+        ConsoleUtil::printMenuOptions(options);
+        
+        int choice = getMenuChoice();
+        
+        if (choice == 1) {
+            std::cout << "歸還超過幾天的紀錄要封存（0 = 停用，最少 "
+                      << LoanManager::MIN_ARCHIVE_HORIZON_DAYS << " 天）: ";
+            int days;
+            std::cin >> days;
+            clearInputBuffer();
+            loanManager.setArchiveHorizonDays(days);
+            if (loanManager.saveToFile(loanFile)) {
+                ConsoleUtil::printSuccess(loanManager.getArchiveHorizonDays() > 0 ?
+                    "封存期限已設為 " + std::to_string(loanManager.getArchiveHorizonDays()) + " 天" :
+                    std::string("已停用封存"));
+            } else {
+                ConsoleUtil::printError("儲存借閱資料時發生錯誤");
+            }
+            ConsoleUtil::pauseAndWait();
+        } else if (choice == 2) {
+            if (loanManager.getArchiveHorizonDays() <= 0) {
+                ConsoleUtil::printWarning("封存未啟用，請先設定封存期限");
+            } else {
+                size_t archived = loanManager.archiveReturnedLoans(time(nullptr));
+                if (archived > 0 && !loanManager.saveToFile(loanFile)) {
+                    ConsoleUtil::printError("已封存 " + std::to_string(archived) + " 筆，但儲存借閱資料時發生錯誤");
+                } else {
+                    ConsoleUtil::printSuccess("已封存 " + std::to_string(archived) + " 筆歸還紀錄");
+                }
+            }
+            ConsoleUtil::pauseAndWait();
+        } else if (choice == 3) {
+            return;
+        } else {
+            showInvalidChoice();
+        }
+    }
+}
+
+void Library::displayLoanArchive() {
+    const LoanArchive& archive = loanManager.getArchive();
+    int horizon = loanManager.getArchiveHorizonDays();
+    
+    std::cout << "📦 " << ConsoleUtil::colorText("封存摘要", ConsoleUtil::Color::BRIGHT_CYAN) << std::endl;
+    std::cout << "   封存期限: " << (horizon > 0 ? std::to_string(horizon) + " 天" : std::string("停用")) << std::endl;
+    std::cout << "   封存目錄: " << archive.getDirectory() << std::endl;
+    std::cout << "   熱資料: " << loanManager.getAllLoans().size() << " 筆"
+              << "，封存: " << archive.getLoanCount() << " 筆，"
+              << archive.getSegments().size() << " 個區段，" << archive.getByteCount() << " bytes" << std::endl;
+    if (archive.getArchivedBefore() > 0) {
+        std::cout << "   已封存歸還日早於 " << formatTime(archive.getArchivedBefore()) << " 的紀錄" << std::endl;
+    }
+    std::cout << std::endl;
+    
+    if (archive.getSegments().empty()) {
+        return;
+    }
+    
+    std::cout << std::left << std::setw(26) << "區段" << std::right << std::setw(8) << "筆數"
+              << std::setw(12) << "bytes" << "  借出期間" << std::endl;
+    const size_t maxRows = 24;
+    const auto& segments = archive.getSegments();
+    size_t first = segments.size() > maxRows ? segments.size() - maxRows : 0;
+    for (size_t i = first; i < segments.size(); ++i) {
+        const ArchiveSegment& segment = segments[i];
+        std::cout << std::left << std::setw(26) << segment.file << std::right
+                  << std::setw(8) << segment.summary.loans << std::setw(12) << segment.bytes
+                  << "  " << formatTime(segment.summary.minDate) << " ~ " << formatTime(segment.summary.maxDate)
+                  << std::endl;
+    }
+    if (first > 0) {
+        std::cout << "... 較早的 " << first << " 個區段未列出" << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+void Library::displayCirculationAudit(const CirculationAudit& audit) {
+    std::cout << "🩺 " << ConsoleUtil::colorText("檢查摘要", ConsoleUtil::Color::BRIGHT_CYAN) << std::endl;
+    std::cout << "┌─────────────────────────────────────────────────────────────┐" << std::endl;
+    std::cout << "│ 檢查圖書: " << std::setw(10) << audit.booksChecked
+              << " │ 檢查借閱紀錄: " << std::setw(10) << audit.loansChecked << "   │" << std::endl;
+    std::cout << "│ 未歸還借閱: " << std::setw(8) << audit.activeLoans
+              << " │ 館藏外的紀錄: " << std::setw(10) << audit.orphanLoans << "   │" << std::endl;
+    std::cout << "│ 不一致圖書: " << std::setw(8) << audit.drifts.size()
+              << " │ 耗時: " << std::setw(15) << std::fixed << std::setprecision(2)
+              << audit.milliseconds << " ms     │" << std::endl;
+    std::cout << "└─────────────────────────────────────────────────────────────┘" << std::endl << std::endl;
+    
+    if (audit.ok()) {
+        ConsoleUtil::printSuccess("逐冊館藏、可借冊數、借閱索引與統計全部一致");
+        return;
+    }
+    
+    const size_t maxRows = 20;
+    for (size_t i = 0; i < audit.drifts.size() && i < maxRows; ++i) {
+        const CirculationDrift& drift = audit.drifts[i];
+        std::cout << ConsoleUtil::colorText("[ID: " + std::to_string(drift.bookId) + "]",
+                                          ConsoleUtil::Color::BRIGHT_YELLOW)
+                  << " " << truncateToWidth(drift.title, 30)
+                  << "  總冊數 " << drift.totalCopies
+                  << "，可借 " << drift.availableCopies
+                  << "，未歸還 " << drift.loggedActive;
+        if (drift.copyRecords != drift.totalCopies || drift.copiesOnLoan != drift.loggedActive) {
+            std::cout << ConsoleUtil::colorText("（逐冊 " + std::to_string(drift.copyRecords) + " 冊，借出中 " +
+                                              std::to_string(drift.copiesOnLoan) + " 冊）",
+                                              ConsoleUtil::Color::BRIGHT_RED);
+        }
+        if (drift.indexedActive != drift.loggedActive) {
+            std::cout << ConsoleUtil::colorText("（索引 " + std::to_string(drift.indexedActive) + "）",
+                                              ConsoleUtil::Color::BRIGHT_RED);
+        }
+        if (drift.countedBorrows != drift.loggedBorrows) {
+            std::cout << ConsoleUtil::colorText("（統計 " + std::to_string(drift.countedBorrows) + " / 紀錄 " +
+                                              std::to_string(drift.loggedBorrows) + " 次）",
+                                              ConsoleUtil::Color::BRIGHT_RED);
+        }
+        std::cout << std::endl;
+    }
+    if (audit.drifts.size() > maxRows) {
+        std::cout << "... 另有 " << (audit.drifts.size() - maxRows) << " 本" << std::endl;
+    }
+    
+    for (const auto& mismatch : audit.userMismatches) {
+        ConsoleUtil::printWarning("讀者 " + mismatch);
+    }
+    if (audit.dueIndexMismatch) {
+        ConsoleUtil::printWarning("到期日索引的筆數與未歸還借閱不符");
+    }
+    std::cout << std::endl;
+}
+
 void Library::showSystemOverview() {
     ConsoleUtil::clearScreen();
     ConsoleUtil::printTitle("系統全面概覽");
@@ -2296,8 +2864,7 @@ void Library::showSystemOverview() {
 void Library::showDetailedSystemStatus() {
     auto allBooks = bookManager.getAllBooks();
     auto allUsers = userManager.getAllUsers();
-    auto allLoans = loanManager.getAllLoans();
-    auto overdueLoans = loanManager.getOverdueLoans();
+    size_t overdueCount = loanManager.getLoanColumns().countOverdue(time(nullptr));
     
     int totalCopies = 0;
     int availableCopies = 0;
@@ -2325,41 +2892,27 @@ void Library::showDetailedSystemStatus() {
               << (totalCopies > 0 ? (double)(totalCopies - availableCopies) / totalCopies * 100 : 0) << "% ║" << std::endl;
     std::cout << "╠═════════════════════════════════════════════════════════════╣" << std::endl;
     std::cout << "║ 👥 系統用戶: " << std::setw(8) << allUsers.size() << " 人"
-              << " │ 📈 借閱記錄: " << std::setw(8) << allLoans.size() << " 筆 ║" << std::endl;
+              << " │ 📈 借閱記錄: " << std::setw(8) << loanManager.getCirculationStats().getTotalBorrows() << " 筆 ║" << std::endl;
     std::cout << "║ 👑 管理員: " << std::setw(10) << adminCount << " 人"
               << " │ 👨‍💼 館員: " << std::setw(12) << staffCount << " 人 ║" << std::endl;
     std::cout << "║ 👤 讀者: " << std::setw(12) << readerCount << " 人"
-              << " │ ⚠️  逾期: " << std::setw(12) << overdueLoans.size() << " 筆 ║" << std::endl;
+              << " │ ⚠️  逾期: " << std::setw(12) << overdueCount << " 筆 ║" << std::endl;
     std::cout << "╚═════════════════════════════════════════════════════════════╝" << std::endl << std::endl;
 }
 
 void Library::showRecentActivitySummary() {
-    auto allLoans = loanManager.getAllLoans();
+    const LoanColumns& columns = loanManager.getLoanColumns();
     
-    // 計算最近7天和30天的活動
+    // 計算最近7天和30天的活動：直接掃描欄式借閱紀錄（封存期限至少 30 天，熱資料已涵蓋）
     time_t now = time(nullptr);
     time_t week_ago = now - (7 * 24 * 60 * 60);
     time_t month_ago = now - (30 * 24 * 60 * 60);
+    time_t forever = std::numeric_limits<time_t>::max();
     
-    int recent_borrows_7d = 0, recent_returns_7d = 0;
-    int recent_borrows_30d = 0, recent_returns_30d = 0;
-    
-    for (const auto* loan : allLoans) {
-        if (loan->getBorrowDate() >= week_ago) {
-            recent_borrows_7d++;
-        }
-        if (loan->getBorrowDate() >= month_ago) {
-            recent_borrows_30d++;
-        }
-        if (loan->isReturned()) {
-            if (loan->getReturnDate() >= week_ago) {
-                recent_returns_7d++;
-            }
-            if (loan->getReturnDate() >= month_ago) {
-                recent_returns_30d++;
-            }
-        }
-    }
+    size_t recent_borrows_7d = columns.countBorrowedBetween(week_ago, forever);
+    size_t recent_returns_7d = columns.countReturnedBetween(week_ago, forever);
+    size_t recent_borrows_30d = columns.countBorrowedBetween(month_ago, forever);
+    size_t recent_returns_30d = columns.countReturnedBetween(month_ago, forever);
     
     std::cout << "⏰ " << ConsoleUtil::colorText("近期活動摘要", ConsoleUtil::Color::BRIGHT_CYAN) << std::endl;
     std::cout << "┌─────────────────────────────────────────────────────────────┐" << std::endl;
@@ -2371,16 +2924,55 @@ void Library::showRecentActivitySummary() {
               << (recent_borrows_30d / 30.0) << " 本/天"
               << " │ 日均歸還: " << std::setw(5) << std::fixed << std::setprecision(1) 
               << (recent_returns_30d / 30.0) << " 本/天 │" << std::endl;
-    std::cout << "└─────────────────────────────────────────────────────────────┘" << std::endl << std::endl;
+    std::cout << "└─────────────────────────────────────────────────────────────┘" << std::endl;
+    
+    if (recent_borrows_30d == 0) {
+        std::cout << std::endl;
+        return;
+    }
+    
+    // 最近30天依書籍、讀者、日期分組
+    std::vector<int> bookCounts = columns.borrowsByBook(month_ago, forever);
+    std::vector<int> userCounts = columns.borrowsByUser(month_ago, forever);
+    long long today = CalendarUtil::dayOrdinal(now);
+    std::vector<int> dayCounts = columns.borrowsByDay(today - 29, 30);
+    
+    size_t topBook = 0, topUser = 0, topDay = 0;
+    for (size_t i = 1; i < bookCounts.size(); ++i) {
+        if (bookCounts[i] > bookCounts[topBook]) topBook = i;
+    }
+    for (size_t i = 1; i < userCounts.size(); ++i) {
+        if (userCounts[i] > userCounts[topUser]) topUser = i;
+    }
+    for (size_t i = 1; i < dayCounts.size(); ++i) {
+        if (dayCounts[i] > dayCounts[topDay]) topDay = i;
+    }
+    
+    const Book* book = bookManager.getBook(columns.bookIdAt(static_cast<int32_t>(topBook)));
+    std::string title = book ? book->getTitle() : "圖書 ID " + std::to_string(columns.bookIdAt(static_cast<int32_t>(topBook)));
+    if (title.length() > 30) {
+        title = title.substr(0, 27) + "...";
+    }
+    CalendarUtil::CivilDate peak = CalendarUtil::civilFromDays(today - 29 + static_cast<long long>(topDay));
+    char peakDate[16];
+    snprintf(peakDate, sizeof(peakDate), "%04d-%02d-%02d", peak.year, peak.month, peak.day);
+    
+    std::cout << "   30天熱門圖書: " << title << "（" << bookCounts[topBook] << " 次）" << std::endl;
+    std::cout << "   30天最活躍讀者: " << columns.usernameAt(static_cast<int32_t>(topUser))
+              << "（" << userCounts[topUser] << " 次）" << std::endl;
+    if (dayCounts[topDay] > 0) {
+        std::cout << "   30天借出高峰: " << peakDate << "（" << dayCounts[topDay] << " 本）" << std::endl;
+    }
+    std::cout << std::endl;
 }
 
 // 書籍列表功能實現
 void Library::viewBookList() {
     ConsoleUtil::printTitle("書籍列表瀏覽");
     
-    auto allBooks = bookManager.getAllBooks();
+    size_t totalBooks = bookManager.getAllBooks().size();
     
-    if (allBooks.empty()) {
+    if (totalBooks == 0) {
         ConsoleUtil::printWarning("目前沒有任何圖書");
         ConsoleUtil::pauseAndWait();
         return;
@@ -2389,22 +2981,25 @@ void Library::viewBookList() {
     const int booksPerPage = 20;
     int currentPage = 1;
     
-    // 0=NONE, 1=TITLE, 2=AUTHOR, 3=YEAR, 4=PAGES
+    // 0=NONE, 1=TITLE, 2=AUTHOR, 3=YEAR, 4=PAGES（與 BookSortKey 編號一致）
+    // 5=作者、年份、書名的多重排序
     int currentSortField = 0;
     // 0=ASC, 1=DESC
     int currentSortOrder = 0;
     
     while (true) {
-        auto sortedBooks = allBooks;
-        applySorting(sortedBooks, currentSortField, currentSortOrder);
+        int totalPages = (totalBooks + booksPerPage - 1) / booksPerPage;
+        int startIndex = (currentPage - 1) * booksPerPage;
         
-        int totalPages = (sortedBooks.size() + booksPerPage - 1) / booksPerPage;
+        // 只取出目前這一頁：排序結果由 BookManager 持續維護
+        auto pageBooks = bookManager.getBookPage(getSortSpec(currentSortField, currentSortOrder),
+                                                 startIndex, booksPerPage);
         
         ConsoleUtil::clearScreen();
         ConsoleUtil::printTitleWithSubtitle("書籍列表", 
             "第 " + std::to_string(currentPage) + " / " + std::to_string(totalPages) + " 頁");
         
-        displayBookPage(sortedBooks, currentPage, booksPerPage, currentSortField, currentSortOrder);
+        displayBookPage(pageBooks, startIndex, totalBooks, currentSortField, currentSortOrder);
         
         std::vector<std::string> navOptions;
         
@@ -2424,25 +3019,24 @@ void Library::viewBookList() {
         
         int choice = getMenuChoice();
         
-        if (!handleBookListNavigation(choice, currentPage, totalPages, sortedBooks, navOptions,
+        if (!handleBookListNavigation(choice, currentPage, totalPages, navOptions,
                                      currentSortField, currentSortOrder)) {
             break;
         }
     }
 }
 
-void Library::displayBookPage(const std::vector<Book>& books, int page, int booksPerPage,
+void Library::displayBookPage(const std::vector<const Book*>& pageBooks, int startIndex, size_t totalBooks,
                              int currentSortField, int currentSortOrder) {
-    int startIndex = (page - 1) * booksPerPage;
-    int endIndex = std::min(startIndex + booksPerPage, static_cast<int>(books.size()));
+    int endIndex = startIndex + static_cast<int>(pageBooks.size());
     
     ConsoleUtil::printInfo("顯示第 " + std::to_string(startIndex + 1) + 
                           " - " + std::to_string(endIndex) + " 本圖書 (共 " + 
-                          std::to_string(books.size()) + " 本)");
+                          std::to_string(totalBooks) + " 本)");
     std::cout << std::endl;
     
     // 計算每欄的最大寬度
-    auto columnWidths = calculateColumnWidths(books, startIndex, endIndex);
+    auto columnWidths = calculateColumnWidths(pageBooks);
     
     // 排序箭頭符號
     std::string titleArrow = getSortArrow(currentSortField, currentSortOrder, 1);
@@ -2480,7 +3074,7 @@ void Library::displayBookPage(const std::vector<Book>& books, int page, int book
     
     // 顯示書籍列表
     for (int i = startIndex; i < endIndex; i++) {
-        const Book& book = books[i];
+        const Book& book = *pageBooks[i - startIndex];
         
         // 交替行顏色
         ConsoleUtil::Color rowColor = (i % 2 == 0) ? ConsoleUtil::Color::BRIGHT_WHITE : ConsoleUtil::Color::WHITE;
@@ -2535,7 +3129,6 @@ void Library::displayBookPage(const std::vector<Book>& books, int page, int book
 }
 
 bool Library::handleBookListNavigation(int choice, int& currentPage, int totalPages, 
-                                       const std::vector<Book>&, 
                                        const std::vector<std::string>&,
                                        int& currentSortField, int& currentSortOrder) {
     int optionIndex = 1;
@@ -2631,37 +3224,24 @@ void Library::viewBookDetailsFromList() {
 }
 
 // 排序輔助函數
-void Library::applySorting(std::vector<Book>& books, int sortField, int sortOrder) {
-    if (sortField == 0) return; // NONE
-    
-    bool ascending = (sortOrder == 0); // ASC = 0, DESC = 1
+std::vector<SortKeyPart> Library::getSortSpec(int currentSortField, int currentSortOrder) {
+    bool descending = currentSortOrder == 1;
     
-    SortUtil::sort(books, [sortField, ascending](const Book& a, const Book& b) {
-        bool result = false;
-        
-        switch (sortField) {
-            case 1: // TITLE
-                result = a.getTitle() < b.getTitle();
-                break;
-            case 2: // AUTHOR
-                result = a.getAuthor() < b.getAuthor();
-                break;
-            case 3: // YEAR
-                result = a.getYear() < b.getYear();
-                break;
-            case 4: // PAGES
-                result = a.getPageCount() < b.getPageCount();
-                break;
-            default:
-                return false;
-        }
-        
-        return ascending ? result : !result;
-    });
+    if (currentSortField == MULTI_SORT_FIELD) {
+        return {{BookSortKey::AUTHOR, descending},
+                {BookSortKey::YEAR, descending},
+                {BookSortKey::TITLE, descending}};
+    }
+    if (currentSortField == 0) {
+        return {};
+    }
+    return {{static_cast<BookSortKey>(currentSortField), descending}};
 }
 
 std::string Library::getSortArrow(int currentSortField, int currentSortOrder, int fieldId) {
-    if (currentSortField != fieldId) {
+    // 多重排序時在參與排序的書名、作者、年份欄位上都標示方向
+    bool inMultiSort = currentSortField == MULTI_SORT_FIELD && fieldId >= 1 && fieldId <= 3;
+    if (currentSortField != fieldId && !inMultiSort) {
         return "";
     }
     
@@ -2672,7 +3252,8 @@ void Library::showSortMenu(int& currentSortField, int& currentSortOrder) {
     ConsoleUtil::printTitle("重新排列選項");
     
     std::vector<std::string> sortOptions = {
-        "依書名排序", "依作者排序", "依出版年份排序", "依頁數排序", "取消排序", "返回"
+        "依書名排序", "依作者排序", "依出版年份排序", "依頁數排序",
+        "依作者、年份、書名排序", "取消排序", "返回"
     };
     
     // 顯示當前排序狀態
@@ -2683,6 +3264,7 @@ void Library::showSortMenu(int& currentSortField, int& currentSortOrder) {
             case 2: fieldName = "作者"; break;
             case 3: fieldName = "出版年份"; break;
             case 4: fieldName = "頁數"; break;
+            case MULTI_SORT_FIELD: fieldName = "作者、年份、書名"; break;
         }
         
         std::string orderName = (currentSortOrder == 0) ? "升序" : "降序";
@@ -2709,12 +3291,15 @@ void Library::showSortMenu(int& currentSortField, int& currentSortOrder) {
         case 4: // 頁數
             setSortField(currentSortField, currentSortOrder, 4);
             break;
-        case 5: // 取消排序
+        case 5: // 作者、年份、書名
+            setSortField(currentSortField, currentSortOrder, MULTI_SORT_FIELD);
+            break;
+        case 6: // 取消排序
             currentSortField = 0; // NONE
             currentSortOrder = 0; // ASC
             ConsoleUtil::printSuccess("已取消排序");
             break;
-        case 6: // 返回
+        case 7: // 返回
             return;
         default:
             showInvalidChoice();
@@ -2740,6 +3325,7 @@ void Library::setSortField(int& currentSortField, int& currentSortOrder, int new
         case 2: fieldName = "作者"; break;
         case 3: fieldName = "出版年份"; break;
         case 4: fieldName = "頁數"; break;
+        case MULTI_SORT_FIELD: fieldName = "作者、年份、書名"; break;
     }
     
     std::string orderName = (currentSortOrder == 0) ? "升序" : "降序";
@@ -2747,7 +3333,7 @@ void Library::setSortField(int& currentSortField, int& currentSortOrder, int new
 }
 
 // 計算每欄的最大寬度
-Library::ColumnWidths Library::calculateColumnWidths(const std::vector<Book>& books, int startIndex, int endIndex) {
+Library::ColumnWidths Library::calculateColumnWidths(const std::vector<const Book*>& books) {
     ColumnWidths widths = {0, 0, 0, 0, 0, 0};
     
     // 最小寬度（考慮顯示寬度）
@@ -2759,8 +3345,8 @@ Library::ColumnWidths Library::calculateColumnWidths(const std::vector<Book>& bo
     widths.statusWidth = std::max(widths.statusWidth, getDisplayWidth("狀態") + 2); // "狀態" + 空格
     
     // 計算實際內容的最大顯示寬度
-    for (int i = startIndex; i < endIndex; i++) {
-        const Book& book = books[i];
+    for (const Book* bookPtr : books) {
+        const Book& book = *bookPtr;
         
         // ID欄位
         std::string idStr = std::to_string(book.getId());
@@ -2868,7 +3454,7 @@ std::string Library::truncateToWidth(const std::string& str, size_t maxWidth) {
 Library::PopularityInfo Library::calculateRelativePopularity(int bookId, const std::unordered_map<int, int>& bookStats) const {
     PopularityInfo info;
     
-    auto it = SearchUtil::mapFind(bookStats, bookId);
+    auto it = bookStats.find(bookId);
     info.borrowCount = (it != bookStats.end()) ? it->second : 0;
     
     if (bookStats.empty() || info.borrowCount == 0) {
@@ -2887,16 +3473,18 @@ Library::PopularityInfo Library::calculateRelativePopularity(int bookId, const s
         totalBorrows += stat.second;
     }
     
-    SortUtil::sort(allCounts, [](const int& a, const int& b) {
-        return a < b;
-    });
-    
     double mean = static_cast<double>(totalBorrows) / allCounts.size();
     double median = 0.0;
     
+    // 中位數只需選出中間的元素，不必完整排序
     size_t n = allCounts.size();
+    SortUtil::nthElement(allCounts, n / 2);
     if (n % 2 == 0) {
-        median = (allCounts[n/2 - 1] + allCounts[n/2]) / 2.0;
+        int lowerMiddle = allCounts[0];
+        for (size_t i = 1; i < n / 2; ++i) {
+            lowerMiddle = std::max(lowerMiddle, allCounts[i]);
+        }
+        median = (lowerMiddle + allCounts[n/2]) / 2.0;
     } else {
         median = allCounts[n/2];
     }
@@ -0,0 +1,442 @@
+#include "../include/LoanArchive.h"
+#include "../include/LoanCodec.h"
+#include "../include/SimpleJSON.h"
+#include "../include/CalendarUtil.h"
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <cstdio>
+#include <type_traits>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#include <windows.h>
+#endif
+
+using JSONValue = SimpleJSON::JSONValue;
+
+namespace {
+    const char* const MANIFEST_FILE = "manifest.json";
+
+    bool fileExists(const std::string& path) {
+        struct stat info;
+        return stat(path.c_str(), &info) == 0;
+    }
+
+    // 先寫暫存檔再改名，讀取端不會看到寫到一半的檔案；目標檔在任何時刻都存在
+    bool writeFileAtomically(const std::string& path, const std::string& content) {
+        std::string temp = path + ".tmp";
+        std::ofstream file(temp, std::ios::binary);
+        if (!file.is_open() || !(file << content)) {
+            std::remove(temp.c_str());
+            return false;
+        }
+        file.close();
+        if (file.fail()) {
+            std::remove(temp.c_str());
+            return false;
+        }
+#ifdef _WIN32
+        // Windows 的 rename 不會覆蓋既有檔案
+        return MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        // POSIX 的 rename 會以原子方式取代既有檔案
+        return std::rename(temp.c_str(), path.c_str()) == 0;
+#endif
+    }
+
+    template <typename Map>
+    std::shared_ptr<JSONValue> countsToJson(const Map& counts) {
+        auto object = JSONValue::createObject();
+        for (const auto& entry : counts) {
+            std::string key;
+            if constexpr (std::is_same<typename Map::key_type, std::string>::value) {
+                key = entry.first;
+            } else {
+                key = std::to_string(entry.first);
+            }
+            object->set(key, entry.second);
+        }
+        return object;
+    }
+}
+
+LoanArchive::LoanArchive() : archivedBefore(0), loanTotal(0), segmentsOpened(0) {}
+
+void LoanArchive::setDirectory(const std::string& directory) {
+    this->directory = directory;
+}
+
+const std::string& LoanArchive::getDirectory() const {
+    return directory;
+}
+
+std::string LoanArchive::pathOf(const std::string& file) const {
+    return directory + "/" + file;
+}
+
+bool LoanArchive::ensureDirectory() const {
+    if (fileExists(directory)) {
+        return true;
+    }
+#ifdef _WIN32
+    return _mkdir(directory.c_str()) == 0;
+#else
+    return mkdir(directory.c_str(), 0755) == 0;
+#endif
+}
+
+void LoanArchive::clear() {
+    segments.clear();
+    bookTotals.clear();
+    overdueTotals.clear();
+    archivedBefore = 0;
+    loanTotal = 0;
+}
+
+void LoanArchive::addTotals(const ArchiveSegment& segment) {
+    for (const auto& entry : segment.summary.bookBorrows) {
+        bookTotals[entry.first] += entry.second;
+    }
+    for (const auto& user : segment.summary.userOverdueDays) {
+        std::map<int, int>& days = overdueTotals[user.first];
+        for (const auto& entry : user.second) {
+            days[entry.first] += entry.second;
+        }
+    }
+    loanTotal += segment.summary.loans;
+}
+
+bool LoanArchive::load() {
+    clear();
+    if (directory.empty()) {
+        return true;
+    }
+
+    std::ifstream file(pathOf(MANIFEST_FILE));
+    if (!file.is_open()) {
+        return true;
+    }
+
+    try {
+        std::string jsonStr((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        auto j = SimpleJSON::parseJSON(jsonStr);
+
+        archivedBefore = static_cast<time_t>(j->at("archivedBefore")->getNumber());
+        for (const auto& segmentJson : j->at("segments")->getArray()) {
+            ArchiveSegment segment;
+            segment.file = segmentJson->at("file")->getString();
+            segment.month = segmentJson->at("month")->getInt();
+            segment.bytes = static_cast<size_t>(segmentJson->at("bytes")->getNumber());
+
+            LoanSummary& summary = segment.summary;
+            summary.loans = static_cast<size_t>(segmentJson->at("loans")->getNumber());
+            summary.returns = static_cast<size_t>(segmentJson->at("returns")->getNumber());
+            summary.minDate = static_cast<time_t>(segmentJson->at("minDate")->getNumber());
+            summary.maxDate = static_cast<time_t>(segmentJson->at("maxDate")->getNumber());
+            for (const auto& entry : segmentJson->at("books")->getObject()) {
+                summary.bookBorrows[std::stoi(entry.first)] = entry.second->getInt();
+            }
+            for (const auto& entry : segmentJson->at("users")->getObject()) {
+                summary.userBorrows[entry.first] = entry.second->getInt();
+            }
+            for (const auto& entry : segmentJson->at("borrowDays")->getObject()) {
+                summary.dailyBorrows[std::stoll(entry.first)] = entry.second->getInt();
+            }
+            for (const auto& entry : segmentJson->at("returnDays")->getObject()) {
+                summary.dailyReturns[std::stoll(entry.first)] = entry.second->getInt();
+            }
+            if (segmentJson->contains("overdue")) {
+                for (const auto& user : segmentJson->at("overdue")->getObject()) {
+                    for (const auto& entry : user.second->getObject()) {
+                        summary.userOverdueDays[user.first][std::stoi(entry.first)] = entry.second->getInt();
+                    }
+                }
+            } else {
+                // 較早的 manifest 沒有逾期摘要：開啟區段補算一次，下次寫入 manifest 時一併保存
+                // 區段無法讀取時 readSegment 已輸出錯誤，該區段不計罰款
+                std::vector<LoanRecord> loans;
+                readSegment(segment, loans);
+                for (const auto& loan : loans) {
+                    int days = loan.getDaysOverdue(loan.getReturnDate());
+                    if (loan.isReturned() && days > 0) {
+                        summary.userOverdueDays[loan.getUsername()][days]++;
+                    }
+                }
+            }
+
+            addTotals(segment);
+            segments.push_back(std::move(segment));
+        }
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error loading loan archive manifest: " << e.what() << std::endl;
+        clear();
+        return false;
+    }
+}
+
+bool LoanArchive::writeManifest() const {
+    auto segmentsJson = JSONValue::createArray();
+    for (const auto& segment : segments) {
+        const LoanSummary& summary = segment.summary;
+        auto segmentJson = JSONValue::createObject();
+        segmentJson->set("file", segment.file);
+        segmentJson->set("month", segment.month);
+        segmentJson->set("bytes", static_cast<double>(segment.bytes));
+        segmentJson->set("loans", static_cast<double>(summary.loans));
+        segmentJson->set("returns", static_cast<double>(summary.returns));
+        segmentJson->set("minDate", static_cast<double>(summary.minDate));
+        segmentJson->set("maxDate", static_cast<double>(summary.maxDate));
+        segmentJson->set("books", countsToJson(summary.bookBorrows));
+        segmentJson->set("users", countsToJson(summary.userBorrows));
+        segmentJson->set("borrowDays", countsToJson(summary.dailyBorrows));
+        segmentJson->set("returnDays", countsToJson(summary.dailyReturns));
+        auto overdueJson = JSONValue::createObject();
+        for (const auto& user : summary.userOverdueDays) {
+            overdueJson->set(user.first, countsToJson(user.second));
+        }
+        segmentJson->set("overdue", overdueJson);
+        segmentsJson->push_back(segmentJson);
+    }
+
+    auto manifest = JSONValue::createObject();
+    manifest->set("archivedBefore", static_cast<double>(archivedBefore));
+    manifest->set("segments", segmentsJson);
+    return writeFileAtomically(pathOf(MANIFEST_FILE), SimpleJSON::stringifyJSON(manifest, 2));
+}
+
+bool LoanArchive::writeSegment(const std::string& file, const std::vector<const LoanRecord*>& loans,
+                               size_t& bytes) const {
+    std::string content = LoanCodec::encode(loans);
+    bytes = content.size();
+    return writeFileAtomically(pathOf(file), content);
+}
+
+bool LoanArchive::append(const std::vector<const LoanRecord*>& loans, time_t cutoff) {
+    if (directory.empty() || !ensureDirectory()) {
+        std::cerr << "Error creating loan archive directory " << directory << std::endl;
+        return false;
+    }
+
+    // 依借出月份分區；區段內的順序由 LoanCodec 決定（讀者、借出時間）
+    std::map<int, std::vector<const LoanRecord*>> partitions;
+    for (const LoanRecord* loan : loans) {
+        partitions[CalendarUtil::monthOrdinal(loan->getBorrowDate())].push_back(loan);
+    }
+
+    std::vector<ArchiveSegment> written;
+    for (auto& partition : partitions) {
+        const std::vector<const LoanRecord*>& records = partition.second;
+
+        // 既有區段不改寫：同一個月份再次封存時寫成下一個序號的新檔
+        std::string base = "loans-" + CalendarUtil::formatMonth(partition.first);
+        std::string file;
+        for (int serial = 1; file.empty() || fileExists(pathOf(file)) ||
+                             fileExists(pathOf(file.substr(0, file.size() - 4) + ".json")); ++serial) {
+            file = base + "-" + std::to_string(serial) + ".lhb";
+        }
+
+        ArchiveSegment segment;
+        segment.file = file;
+        segment.month = partition.first;
+        if (!writeSegment(file, records, segment.bytes)) {
+            std::cerr << "Error writing loan archive segment " << file << std::endl;
+            return false;
+        }
+        for (const LoanRecord* loan : records) {
+            segment.summary.add(*loan);
+        }
+        written.push_back(std::move(segment));
+    }
+
+    // 區段都寫入後才更新 manifest；此前中斷時新區段不會被讀到，紀錄仍在熱資料中
+    std::vector<ArchiveSegment> previous = segments;
+    time_t previousWatermark = archivedBefore;
+    for (auto& segment : written) {
+        segments.push_back(segment);
+    }
+    if (cutoff > archivedBefore) {
+        archivedBefore = cutoff;
+    }
+    if (!writeManifest()) {
+        std::cerr << "Error writing loan archive manifest" << std::endl;
+        segments.swap(previous);
+        archivedBefore = previousWatermark;
+        return false;
+    }
+
+    for (const auto& segment : written) {
+        addTotals(segment);
+    }
+    return true;
+}
+
+bool LoanArchive::isArchived(const LoanRecord& loan) const {
+    return loan.isReturned() && loan.getReturnDate() < archivedBefore;
+}
+
+time_t LoanArchive::getArchivedBefore() const {
+    return archivedBefore;
+}
+
+const std::vector<ArchiveSegment>& LoanArchive::getSegments() const {
+    return segments;
+}
+
+const std::unordered_map<int, int>& LoanArchive::getBookCounts() const {
+    return bookTotals;
+}
+
+const std::map<int, int>* LoanArchive::getOverdueDays(const std::string& username) const {
+    auto it = overdueTotals.find(username);
+    return it != overdueTotals.end() ? &it->second : nullptr;
+}
+
+size_t LoanArchive::getLoanCount() const {
+    return loanTotal;
+}
+
+size_t LoanArchive::getByteCount() const {
+    size_t bytes = 0;
+    for (const auto& segment : segments) {
+        bytes += segment.bytes;
+    }
+    return bytes;
+}
+
+size_t LoanArchive::getSegmentsOpened() const {
+    return segmentsOpened;
+}
+
+bool LoanArchive::readSegmentData(const ArchiveSegment& segment, std::string& data) const {
+    std::ifstream file(pathOf(segment.file), std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error opening loan archive segment " << segment.file << std::endl;
+        return false;
+    }
+    segmentsOpened++;
+    data.assign((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return true;
+}
+
+bool LoanArchive::parseJsonSegment(const std::string& data, std::vector<LoanRecord>& loans) const {
+    auto j = SimpleJSON::parseJSON(data);
+
+    std::vector<std::string> users;
+    for (const auto& user : j->at("users")->getArray()) {
+        users.push_back(user->getString());
+    }
+
+    for (const auto& record : j->at("loans")->getArray()) {
+        const auto& fields = record->getArray();
+        LoanRecord loan(users.at(static_cast<size_t>(fields.at(1)->getInt())),
+                        fields.at(0)->getInt(),
+                        static_cast<time_t>(fields.at(2)->getNumber()),
+                        static_cast<time_t>(fields.at(3)->getNumber()));
+        loan.setReturnDate(static_cast<time_t>(fields.at(4)->getNumber()));
+        loan.setBarcode(fields.at(5)->getString());
+        loans.push_back(loan);
+    }
+    return true;
+}
+
+bool LoanArchive::readSegment(const ArchiveSegment& segment, std::vector<LoanRecord>& loans) const {
+    std::string data;
+    if (!readSegmentData(segment, data)) {
+        return false;
+    }
+
+    try {
+        if (LoanCodec::isEncoded(data)) {
+            if (!LoanCodec::decode(data, loans)) {
+                std::cerr << "Error decoding loan archive segment " << segment.file << std::endl;
+                return false;
+            }
+            return true;
+        }
+        return parseJsonSegment(data, loans);
+    } catch (const std::exception& e) {
+        std::cerr << "Error reading loan archive segment " << segment.file << ": " << e.what() << std::endl;
+        return false;
+    }
+}
+
+std::vector<LoanRecord> LoanArchive::loansForUser(const std::string& username) const {
+    std::vector<LoanRecord> result;
+    std::vector<LoanRecord> records;
+    std::string data;
+    for (const auto& segment : segments) {
+        if (segment.summary.userBorrows.find(username) == segment.summary.userBorrows.end()) {
+            continue;
+        }
+        if (!readSegmentData(segment, data)) {
+            continue;
+        }
+
+        // 編碼區段依讀者排序：串流解碼到該讀者的紀錄結束為止，其他讀者的紀錄不轉成 LoanRecord
+        if (LoanCodec::isEncoded(data)) {
+            LoanCodec::Reader reader(data);
+            int64_t target = reader.findUser(username);
+            LoanCodec::Entry entry;
+            while (target >= 0 && reader.next(entry) && entry.user <= target) {
+                if (entry.user == target) {
+                    result.push_back(reader.toRecord(entry));
+                }
+            }
+            if (!reader.ok()) {
+                std::cerr << "Error decoding loan archive segment " << segment.file << std::endl;
+            }
+            continue;
+        }
+
+        records.clear();
+        try {
+            parseJsonSegment(data, records);
+        } catch (const std::exception& e) {
+            std::cerr << "Error reading loan archive segment " << segment.file << ": " << e.what() << std::endl;
+        }
+        for (const auto& loan : records) {
+            if (loan.getUsername() == username) {
+                result.push_back(loan);
+            }
+        }
+    }
+    return result;
+}
+
+std::vector<LoanRecord> LoanArchive::loansForBook(int bookId) const {
+    std::vector<LoanRecord> result;
+    std::vector<LoanRecord> records;
+    for (const auto& segment : segments) {
+        if (segment.summary.bookBorrows.find(bookId) == segment.summary.bookBorrows.end()) {
+            continue;
+        }
+        records.clear();
+        readSegment(segment, records);
+        for (const auto& loan : records) {
+            if (loan.getBookId() == bookId) {
+                result.push_back(loan);
+            }
+        }
+    }
+    return result;
+}
+
+std::vector<LoanRecord> LoanArchive::loansBorrowedBetween(time_t from, time_t to) const {
+    std::vector<LoanRecord> result;
+    std::vector<LoanRecord> records;
+    for (const auto& segment : segments) {
+        if (segment.summary.maxDate < from || segment.summary.minDate > to) {
+            continue;
+        }
+        records.clear();
+        readSegment(segment, records);
+        for (const auto& loan : records) {
+            if (loan.getBorrowDate() >= from && loan.getBorrowDate() <= to) {
+                result.push_back(loan);
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,315 @@
+#include "../include/LoanCodec.h"
+#include "../include/CopyInventory.h"
+#include "../include/SortUtil.h"
+#include <algorithm>
+#include <climits>
+
+namespace {
+    const char MAGIC[4] = {'L', 'H', 'B', '1'};
+
+    const unsigned char BARCODE_NONE = 0;
+    const unsigned char BARCODE_SERIAL = 1;
+    const unsigned char BARCODE_RAW = 2;
+    const unsigned char BARCODE_MASK = 3;
+    const unsigned char RETURNED = 4;
+
+    void putVarint(std::string& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    void putSigned(std::string& out, int64_t value) {
+        putVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+
+    // 以無號運算取差與和，極端的 time_t 也不會有未定義的溢位
+    int64_t difference(time_t a, time_t b) {
+        return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b));
+    }
+
+    time_t offset(time_t base, int64_t delta) {
+        return static_cast<time_t>(static_cast<uint64_t>(base) + static_cast<uint64_t>(delta));
+    }
+
+    // 條碼為 makeBarcode(bookId, 序號) 時回傳序號，否則為 0
+    int canonicalSerial(const LoanRecord& loan) {
+        const std::string& barcode = loan.getBarcode();
+        size_t dash = barcode.rfind('-');
+        if (dash == std::string::npos || dash + 1 >= barcode.size()) {
+            return 0;
+        }
+        long long serial = 0;
+        for (size_t i = dash + 1; i < barcode.size(); ++i) {
+            if (barcode[i] < '0' || barcode[i] > '9' || serial > INT_MAX / 10) {
+                return 0;
+            }
+            serial = serial * 10 + (barcode[i] - '0');
+        }
+        if (serial <= 0 || serial > INT_MAX) {
+            return 0;
+        }
+        return CopyInventory::makeBarcode(loan.getBookId(), static_cast<int>(serial)) == barcode ?
+            static_cast<int>(serial) : 0;
+    }
+}
+
+namespace LoanCodec {
+
+    std::string encode(const std::vector<const LoanRecord*>& loans) {
+        std::vector<const LoanRecord*> sorted = loans;
+        SortUtil::sort(sorted, [](const LoanRecord* a, const LoanRecord* b) {
+            if (a->getUsername() != b->getUsername()) {
+                return a->getUsername() < b->getUsername();
+            }
+            if (a->getBorrowDate() != b->getBorrowDate()) {
+                return a->getBorrowDate() < b->getBorrowDate();
+            }
+            return a->getBookId() < b->getBookId();
+        });
+
+        // 排序後相同讀者相鄰，字典也就依字典順序排列
+        std::vector<const std::string*> users;
+        for (const LoanRecord* loan : sorted) {
+            if (users.empty() || *users.back() != loan->getUsername()) {
+                users.push_back(&loan->getUsername());
+            }
+        }
+        time_t base = 0;
+        for (size_t i = 0; i < sorted.size(); ++i) {
+            if (i == 0 || sorted[i]->getBorrowDate() < base) {
+                base = sorted[i]->getBorrowDate();
+            }
+        }
+
+        std::string out(MAGIC, sizeof(MAGIC));
+        out.reserve(sizeof(MAGIC) + sorted.size() * 16);
+        putVarint(out, users.size());
+        for (const std::string* user : users) {
+            putVarint(out, user->size());
+            out += *user;
+        }
+        putVarint(out, sorted.size());
+        putSigned(out, static_cast<int64_t>(base));
+
+        size_t user = 0;
+        time_t borrow = base;
+        time_t dueSpan = 0;
+        for (size_t i = 0; i < sorted.size(); ++i) {
+            const LoanRecord& loan = *sorted[i];
+            size_t userDelta = 0;
+            while (*users[user] != loan.getUsername()) {
+                ++user;
+                ++userDelta;
+            }
+            if (userDelta > 0) {
+                borrow = base;
+            }
+            putVarint(out, userDelta);
+            putSigned(out, difference(loan.getBorrowDate(), borrow));
+            putVarint(out, static_cast<uint32_t>(loan.getBookId()));
+            borrow = loan.getBorrowDate();
+
+            int serial = canonicalSerial(loan);
+            unsigned char flags = loan.getBarcode().empty() ? BARCODE_NONE : (serial > 0 ? BARCODE_SERIAL : BARCODE_RAW);
+            if (loan.isReturned()) {
+                flags |= RETURNED;
+            }
+            out.push_back(static_cast<char>(flags));
+
+            time_t span = static_cast<time_t>(difference(loan.getDueDate(), loan.getBorrowDate()));
+            putSigned(out, difference(span, dueSpan));
+            dueSpan = span;
+            if (loan.isReturned()) {
+                putSigned(out, difference(loan.getReturnDate(), loan.getBorrowDate()));
+            }
+            if ((flags & BARCODE_MASK) == BARCODE_SERIAL) {
+                putVarint(out, static_cast<uint64_t>(serial));
+            } else if ((flags & BARCODE_MASK) == BARCODE_RAW) {
+                putVarint(out, loan.getBarcode().size());
+                out += loan.getBarcode();
+            }
+        }
+        return out;
+    }
+
+    bool isEncoded(const std::string& data) {
+        return data.size() >= sizeof(MAGIC) && std::equal(MAGIC, MAGIC + sizeof(MAGIC), data.begin());
+    }
+
+    bool decode(const std::string& data, std::vector<LoanRecord>& loans) {
+        Reader reader(data);
+        loans.reserve(loans.size() + reader.size());
+        Entry entry;
+        while (reader.next(entry)) {
+            loans.push_back(reader.toRecord(entry));
+        }
+        return reader.ok();
+    }
+
+    Reader::Reader(const std::string& data)
+        : cursor(reinterpret_cast<const unsigned char*>(data.data())),
+          end(reinterpret_cast<const unsigned char*>(data.data()) + data.size()),
+          total(0), decoded(0), failed(false), user(0), base(0), borrow(0), dueSpan(0) {
+        if (!isEncoded(data)) {
+            fail();
+            return;
+        }
+        cursor += sizeof(MAGIC);
+
+        // 長度都先與剩餘位元組比較，損毀的表頭不會造成過大的配置
+        uint64_t userCount = 0;
+        if (!readVarint(userCount) || userCount > static_cast<uint64_t>(end - cursor)) {
+            fail();
+            return;
+        }
+        users.reserve(static_cast<size_t>(userCount));
+        for (uint64_t i = 0; i < userCount; ++i) {
+            uint64_t length = 0;
+            if (!readVarint(length) || length > static_cast<uint64_t>(end - cursor)) {
+                fail();
+                return;
+            }
+            users.emplace_back(reinterpret_cast<const char*>(cursor), static_cast<size_t>(length));
+            cursor += length;
+        }
+
+        uint64_t count = 0;
+        int64_t first = 0;
+        if (!readVarint(count) || count > static_cast<uint64_t>(end - cursor) || !readSigned(first)) {
+            fail();
+            return;
+        }
+        total = static_cast<size_t>(count);
+        base = static_cast<time_t>(first);
+        borrow = base;
+    }
+
+    bool Reader::fail() {
+        failed = true;
+        total = decoded;
+        return false;
+    }
+
+    bool Reader::readVarint(uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (cursor == end) {
+                return false;
+            }
+            unsigned char byte = *cursor++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool Reader::readSigned(int64_t& value) {
+        uint64_t raw = 0;
+        if (!readVarint(raw)) {
+            return false;
+        }
+        value = static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+        return true;
+    }
+
+    bool Reader::next(Entry& entry) {
+        if (decoded >= total) {
+            return false;
+        }
+
+        uint64_t userDelta = 0;
+        int64_t borrowDelta = 0;
+        uint64_t bookId = 0;
+        if (!readVarint(userDelta) || !readSigned(borrowDelta) || !readVarint(bookId) || cursor == end) {
+            return fail();
+        }
+        if (userDelta > 0) {
+            if (userDelta >= users.size() - user) {
+                return fail();
+            }
+            user += static_cast<uint32_t>(userDelta);
+            borrow = base;
+        }
+        if (user >= users.size()) {
+            return fail();
+        }
+        unsigned char flags = *cursor++;
+        if ((flags & ~(BARCODE_MASK | RETURNED)) != 0 || (flags & BARCODE_MASK) > BARCODE_RAW) {
+            return fail();
+        }
+
+        int64_t dueDelta = 0;
+        if (!readSigned(dueDelta)) {
+            return fail();
+        }
+        borrow = offset(borrow, borrowDelta);
+        dueSpan = offset(dueSpan, dueDelta);
+
+        entry.user = user;
+        entry.bookId = static_cast<int>(static_cast<uint32_t>(bookId));
+        entry.borrowDate = borrow;
+        entry.dueDate = offset(borrow, static_cast<int64_t>(dueSpan));
+        entry.returnDate = 0;
+        entry.barcodeSerial = 0;
+        entry.rawBarcode.clear();
+
+        if (flags & RETURNED) {
+            int64_t returnSpan = 0;
+            if (!readSigned(returnSpan)) {
+                return fail();
+            }
+            entry.returnDate = offset(borrow, returnSpan);
+        }
+        if ((flags & BARCODE_MASK) == BARCODE_SERIAL) {
+            uint64_t serial = 0;
+            if (!readVarint(serial) || serial == 0 || serial > INT_MAX) {
+                return fail();
+            }
+            entry.barcodeSerial = static_cast<int>(serial);
+        } else if ((flags & BARCODE_MASK) == BARCODE_RAW) {
+            uint64_t length = 0;
+            if (!readVarint(length) || length > static_cast<uint64_t>(end - cursor)) {
+                return fail();
+            }
+            entry.rawBarcode.assign(reinterpret_cast<const char*>(cursor), static_cast<size_t>(length));
+            cursor += length;
+        }
+
+        decoded++;
+        return true;
+    }
+
+    LoanRecord Reader::toRecord(const Entry& entry) const {
+        LoanRecord loan(users[entry.user], entry.bookId, entry.borrowDate, entry.dueDate);
+        loan.setReturnDate(entry.returnDate);
+        loan.setBarcode(entry.barcodeSerial > 0 ? CopyInventory::makeBarcode(entry.bookId, entry.barcodeSerial) :
+                                                  entry.rawBarcode);
+        return loan;
+    }
+
+    size_t Reader::size() const {
+        return total;
+    }
+
+    size_t Reader::remaining() const {
+        return total - decoded;
+    }
+
+    bool Reader::ok() const {
+        return !failed;
+    }
+
+    const std::vector<std::string>& Reader::getUsers() const {
+        return users;
+    }
+
+    int64_t Reader::findUser(const std::string& username) const {
+        auto it = std::lower_bound(users.begin(), users.end(), username);
+        return it != users.end() && *it == username ? static_cast<int64_t>(it - users.begin()) : -1;
+    }
+}
@@ -0,0 +1,244 @@
+#include "../include/LoanColumns.h"
+#include "../include/CalendarUtil.h"
+
+const int32_t LoanColumns::NOT_RETURNED;
+const time_t LoanColumns::EPOCH;
+
+namespace {
+    // 區塊長度：16 個 int32 為 4 個 SSE／2 個 AVX 暫存器
+    const size_t BLOCK = 16;
+
+    // 區塊內落在 [from, to) 的筆數；固定長度、無分支，編譯器會向量化
+    inline int32_t blockHits(const int32_t* values, int32_t from, int32_t to) {
+        int32_t hits = 0;
+        for (size_t j = 0; j < BLOCK; ++j) {
+            hits += (values[j] >= from) & (values[j] < to);
+        }
+        return hits;
+    }
+
+    size_t countInRange(const std::vector<int32_t>& column, int32_t from, int32_t to) {
+        const int32_t* values = column.data();
+        size_t n = column.size();
+        size_t total = 0;
+        size_t i = 0;
+        for (; i + BLOCK <= n; i += BLOCK) {
+            total += blockHits(values + i, from, to);
+        }
+        for (; i < n; ++i) {
+            total += (values[i] >= from) & (values[i] < to);
+        }
+        return total;
+    }
+}
+
+int32_t LoanColumns::encodeTime(time_t t) {
+    // 先比較再相減，避免 time_t 極值溢位
+    long long value = static_cast<long long>(t);
+    long long epoch = static_cast<long long>(EPOCH);
+    if (value <= epoch + NOT_RETURNED) {
+        return NOT_RETURNED + 1;
+    }
+    if (value >= epoch + INT32_MAX) {
+        return INT32_MAX;
+    }
+    return static_cast<int32_t>(value - epoch);
+}
+
+time_t LoanColumns::decodeTime(int32_t value) {
+    return value == NOT_RETURNED ? 0 : EPOCH + static_cast<time_t>(value);
+}
+
+int32_t LoanColumns::internBook(int bookId) {
+    auto it = bookOrdinals.find(bookId);
+    if (it != bookOrdinals.end()) {
+        return it->second;
+    }
+    int32_t ordinal = static_cast<int32_t>(bookIds.size());
+    bookIds.push_back(bookId);
+    bookOrdinals.emplace(bookId, ordinal);
+    return ordinal;
+}
+
+int32_t LoanColumns::internUser(const std::string& username) {
+    auto it = userOrdinals.find(username);
+    if (it != userOrdinals.end()) {
+        return it->second;
+    }
+    int32_t ordinal = static_cast<int32_t>(usernames.size());
+    usernames.push_back(username);
+    userOrdinals.emplace(username, ordinal);
+    return ordinal;
+}
+
+template<typename Visit>
+void LoanColumns::forEachInRange(const std::vector<int32_t>& column, int32_t from, int32_t to, Visit visit) const {
+    const int32_t* values = column.data();
+    size_t n = column.size();
+    size_t i = 0;
+    for (; i + BLOCK <= n; i += BLOCK) {
+        // 整個區塊都不命中時直接跳過（窄區間查詢的常見情況）
+        if (blockHits(values + i, from, to) == 0) {
+            continue;
+        }
+        for (size_t j = 0; j < BLOCK; ++j) {
+            if (values[i + j] >= from && values[i + j] < to) {
+                visit(i + j);
+            }
+        }
+    }
+    for (; i < n; ++i) {
+        if (values[i] >= from && values[i] < to) {
+            visit(i);
+        }
+    }
+}
+
+// 維護
+size_t LoanColumns::append(const LoanRecord& loan) {
+    bookColumn.push_back(internBook(loan.getBookId()));
+    userColumn.push_back(internUser(loan.getUsername()));
+    borrowColumn.push_back(encodeTime(loan.getBorrowDate()));
+    dueColumn.push_back(encodeTime(loan.getDueDate()));
+    returnColumn.push_back(loan.isReturned() ? encodeTime(loan.getReturnDate()) : NOT_RETURNED);
+    borrowDayColumn.push_back(static_cast<int32_t>(CalendarUtil::dayOrdinal(loan.getBorrowDate())));
+    return bookColumn.size() - 1;
+}
+
+void LoanColumns::setReturnDate(size_t row, time_t returnDate) {
+    if (row < returnColumn.size()) {
+        returnColumn[row] = returnDate != 0 ? encodeTime(returnDate) : NOT_RETURNED;
+    }
+}
+
+void LoanColumns::rebuild(const std::deque<LoanRecord>& loans) {
+    clear();
+    bookColumn.reserve(loans.size());
+    userColumn.reserve(loans.size());
+    borrowColumn.reserve(loans.size());
+    dueColumn.reserve(loans.size());
+    returnColumn.reserve(loans.size());
+    borrowDayColumn.reserve(loans.size());
+    for (const auto& loan : loans) {
+        append(loan);
+    }
+}
+
+void LoanColumns::clear() {
+    bookColumn.clear();
+    userColumn.clear();
+    borrowColumn.clear();
+    dueColumn.clear();
+    returnColumn.clear();
+    borrowDayColumn.clear();
+    bookIds.clear();
+    bookOrdinals.clear();
+    usernames.clear();
+    userOrdinals.clear();
+}
+
+// 字典
+size_t LoanColumns::size() const {
+    return bookColumn.size();
+}
+
+size_t LoanColumns::bookCount() const {
+    return bookIds.size();
+}
+
+size_t LoanColumns::userCount() const {
+    return usernames.size();
+}
+
+int32_t LoanColumns::bookOrdinal(int bookId) const {
+    auto it = bookOrdinals.find(bookId);
+    return it != bookOrdinals.end() ? it->second : -1;
+}
+
+int32_t LoanColumns::userOrdinal(const std::string& username) const {
+    auto it = userOrdinals.find(username);
+    return it != userOrdinals.end() ? it->second : -1;
+}
+
+int LoanColumns::bookIdAt(int32_t ordinal) const {
+    return bookIds[ordinal];
+}
+
+const std::string& LoanColumns::usernameAt(int32_t ordinal) const {
+    return usernames[ordinal];
+}
+
+const std::vector<int32_t>& LoanColumns::books() const {
+    return bookColumn;
+}
+
+const std::vector<int32_t>& LoanColumns::users() const {
+    return userColumn;
+}
+
+// 計數
+size_t LoanColumns::countBorrowedBetween(time_t from, time_t to) const {
+    return countInRange(borrowColumn, encodeTime(from), encodeTime(to));
+}
+
+size_t LoanColumns::countReturnedBetween(time_t from, time_t to) const {
+    return countInRange(returnColumn, encodeTime(from), encodeTime(to));
+}
+
+size_t LoanColumns::countOverdue(time_t asOf) const {
+    const int32_t* returned = returnColumn.data();
+    const int32_t* due = dueColumn.data();
+    int32_t limit = encodeTime(asOf);
+    size_t n = returnColumn.size();
+    size_t total = 0;
+    size_t i = 0;
+    for (; i + BLOCK <= n; i += BLOCK) {
+        int32_t hits = 0;
+        for (size_t j = 0; j < BLOCK; ++j) {
+            hits += (returned[i + j] == NOT_RETURNED) & (due[i + j] < limit);
+        }
+        total += hits;
+    }
+    for (; i < n; ++i) {
+        total += (returned[i] == NOT_RETURNED) & (due[i] < limit);
+    }
+    return total;
+}
+
+// 篩選
+std::vector<uint32_t> LoanColumns::rowsBorrowedBetween(time_t from, time_t to) const {
+    std::vector<uint32_t> rows;
+    forEachInRange(borrowColumn, encodeTime(from), encodeTime(to), [&](size_t row) {
+        rows.push_back(static_cast<uint32_t>(row));
+    });
+    return rows;
+}
+
+// 分組計數
+std::vector<int> LoanColumns::borrowsByBook(time_t from, time_t to) const {
+    std::vector<int> counts(bookIds.size(), 0);
+    forEachInRange(borrowColumn, encodeTime(from), encodeTime(to), [&](size_t row) {
+        counts[bookColumn[row]]++;
+    });
+    return counts;
+}
+
+std::vector<int> LoanColumns::borrowsByUser(time_t from, time_t to) const {
+    std::vector<int> counts(usernames.size(), 0);
+    forEachInRange(borrowColumn, encodeTime(from), encodeTime(to), [&](size_t row) {
+        counts[userColumn[row]]++;
+    });
+    return counts;
+}
+
+std::vector<int> LoanColumns::borrowsByDay(long long firstDay, int days) const {
+    std::vector<int> counts(days > 0 ? days : 0, 0);
+    if (days <= 0) {
+        return counts;
+    }
+    int32_t first = static_cast<int32_t>(firstDay);
+    forEachInRange(borrowDayColumn, first, first + days, [&](size_t row) {
+        counts[borrowDayColumn[row] - first]++;
+    });
+    return counts;
+}
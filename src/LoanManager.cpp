@@ -3,8 +3,11 @@
 #include <fstream>
 #include <iomanip>
 #include <ctime>
+#include <chrono>
+#include <unordered_set>
 #include "../include/SimpleJSON.h"
 #include "../include/SearchUtil.h"
+#include "../include/SortUtil.h"
 
 using JSONValue = SimpleJSON::JSONValue;
 
@@ -16,52 +19,493 @@ std::string formatDate(time_t t) {
     return std::string(buffer);
 }
 
-LoanManager::LoanManager() {
+LoanManager::LoanManager()
+    : archiveHorizonDays(0), nextTimerId(1), reminderLeadSeconds(24 * 60 * 60), schedulerStopping(false) {
 }
 
-LoanManager::LoanManager(const std::string& filename) {
+LoanManager::LoanManager(const std::string& filename)
+    : archiveHorizonDays(0), nextTimerId(1), reminderLeadSeconds(24 * 60 * 60), schedulerStopping(false) {
     loadFromFile(filename);
 }
 
+LoanManager::~LoanManager() {
+    stopScheduler();
+}
+
 // Loan operations
 bool LoanManager::borrowBook(const std::string& username, int bookId, int graceDays) {
+    return borrowBook(username, bookId, time(nullptr), graceDays);
+}
+
+bool LoanManager::borrowBook(const std::string& username, int bookId, time_t now, int graceDays,
+                             const std::string& barcode) {
     // Create loan record
-    time_t now = time(nullptr);
     time_t dueDate = now + (14 * 24 * 60 * 60); // Due in 14 days
     
     LoanRecord loan(username, bookId, now, dueDate, graceDays);
+    loan.setBarcode(barcode);
     
     // Add to collections
     loans.push_back(loan);
-    bookLoans[bookId].push_back(&loans.back());
-    userLoans[username].push_back(&loans.back());
+    LoanRecord* record = &loans.back();
+    bookLoans[bookId].push_back(record);
+    userLoans[username].push_back(record);
+    indexActiveLoan(record);
+    stats.recordBorrow(*record);
+    columnRows[record] = columns.append(*record);
+    scheduleDueEvents(record);
     
     return true;
 }
 
 bool LoanManager::returnBook(const std::string& username, int bookId) {
-    // Find the loan record
-    LoanRecord* loan = nullptr;
-    for (auto* record : userLoans[username]) {
-        if (record->getBookId() == bookId && !record->isReturned()) {
-            loan = record;
+    return returnBook(username, bookId, time(nullptr));
+}
+
+bool LoanManager::returnBook(const std::string& username, int bookId, time_t now) {
+    // Find the active loan record through the index
+    return returnLoan(findActiveLoan(username, bookId), now);
+}
+
+bool LoanManager::returnLoan(LoanRecord* loan, time_t now) {
+    if (!loan || loan->isReturned()) {
+        return false;
+    }
+    
+    // Update loan record - set return date
+    unindexActiveLoan(loan);
+    cancelDueEvents(loan);
+    loan->setReturnDate(now);
+    stats.recordReturn(*loan);
+    auto rowIt = columnRows.find(loan);
+    if (rowIt != columnRows.end()) {
+        columns.setReturnDate(rowIt->second, now);
+    }
+    
+    return true;
+}
+
+// Batch circulation
+bool LoanManager::validateBatch(const std::vector<CirculationOp>& ops, std::vector<LoanRecord*>& returnTargets,
+                                std::vector<std::string>& errors) const {
+    bool ok = true;
+    returnTargets.assign(ops.size(), nullptr);
+    std::unordered_set<const LoanRecord*> claimed;
+    
+    // Returns by barcode claim their own loan first
+    for (size_t i = 0; i < ops.size(); ++i) {
+        const CirculationOp& op = ops[i];
+        if (op.type != CirculationOp::Type::RETURN || op.barcode.empty()) {
+            continue;
+        }
+        
+        LoanRecord* loan = findActiveLoanByBarcode(op.barcode);
+        if (!loan) {
+            errors.push_back("條碼 " + op.barcode + " 沒有借出中的紀錄");
+            ok = false;
+        } else if (!op.username.empty() && op.username != loan->getUsername()) {
+            errors.push_back("條碼 " + op.barcode + " 不是由 " + op.username + " 借出");
+            ok = false;
+        } else if (!claimed.insert(loan).second) {
+            errors.push_back("條碼 " + op.barcode + " 在同一批次中重複歸還");
+            ok = false;
+        } else {
+            returnTargets[i] = loan;
+        }
+    }
+    
+    // Remaining returns take the oldest unclaimed loan for the same user and book
+    for (size_t i = 0; i < ops.size(); ++i) {
+        const CirculationOp& op = ops[i];
+        if (!op.barcode.empty() && op.type == CirculationOp::Type::RETURN) {
+            continue;
+        }
+        if (op.username.empty()) {
+            errors.push_back("圖書 ID " + std::to_string(op.bookId) + " 未指定讀者");
+            ok = false;
+            continue;
+        }
+        if (op.type != CirculationOp::Type::RETURN) {
+            continue;
+        }
+        
+        auto userIt = activeLoans.find(op.username);
+        if (userIt != activeLoans.end()) {
+            auto bookIt = userIt->second.find(op.bookId);
+            if (bookIt != userIt->second.end()) {
+                for (LoanRecord* loan : bookIt->second) {
+                    if (claimed.insert(loan).second) {
+                        returnTargets[i] = loan;
+                        break;
+                    }
+                }
+            }
+        }
+        
+        if (!returnTargets[i]) {
+            errors.push_back(op.username + " 沒有可歸還的圖書 ID " + std::to_string(op.bookId));
+            ok = false;
+        }
+    }
+    
+    return ok;
+}
+
+// Active loan index
+void LoanManager::indexActiveLoan(LoanRecord* loan) {
+    const std::string& username = loan->getUsername();
+    activeLoans[username][loan->getBookId()].push_back(loan);
+    dueIndex.emplace(loan->getDueDate(), loan);
+    activeCountByUser[username]++;
+    activeCountByBook[loan->getBookId()]++;
+    if (!loan->getBarcode().empty()) {
+        activeByBarcode[loan->getBarcode()] = loan;
+    }
+}
+
+void LoanManager::unindexActiveLoan(LoanRecord* loan) {
+    const std::string username = loan->getUsername();
+    auto userIt = activeLoans.find(username);
+    if (userIt == activeLoans.end()) {
+        return;
+    }
+    
+    auto bookIt = userIt->second.find(loan->getBookId());
+    if (bookIt == userIt->second.end()) {
+        return;
+    }
+    
+    std::vector<LoanRecord*>& records = bookIt->second;
+    for (size_t i = 0; i < records.size(); ++i) {
+        if (records[i] == loan) {
+            records.erase(records.begin() + i);
             break;
         }
     }
     
-    if (!loan) {
-        return false;
+    auto range = dueIndex.equal_range(loan->getDueDate());
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == loan) {
+            dueIndex.erase(it);
+            break;
+        }
     }
     
-    // Update loan record - set return date
-    loan->setReturnDate(time(nullptr));
+    if (records.empty()) {
+        userIt->second.erase(bookIt);
+        if (userIt->second.empty()) {
+            activeLoans.erase(userIt);
+        }
+    }
     
-    return true;
+    if (--activeCountByUser[username] <= 0) {
+        activeCountByUser.erase(username);
+    }
+    if (--activeCountByBook[loan->getBookId()] <= 0) {
+        activeCountByBook.erase(loan->getBookId());
+    }
+    auto barcodeIt = activeByBarcode.find(loan->getBarcode());
+    if (barcodeIt != activeByBarcode.end() && barcodeIt->second == loan) {
+        activeByBarcode.erase(barcodeIt);
+    }
+}
+
+void LoanManager::rebuildIndexes() {
+    bookLoans.clear();
+    userLoans.clear();
+    activeLoans.clear();
+    dueIndex.clear();
+    activeCountByUser.clear();
+    activeCountByBook.clear();
+    activeByBarcode.clear();
+    columns.clear();
+    columnRows.clear();
+    
+    for (auto& loan : loans) {
+        columnRows[&loan] = columns.append(loan);
+        bookLoans[loan.getBookId()].push_back(&loan);
+        userLoans[loan.getUsername()].push_back(&loan);
+        if (!loan.isReturned()) {
+            indexActiveLoan(&loan);
+        }
+    }
+    
+    stats.rebuild(loans);
+    for (const auto& segment : archive.getSegments()) {
+        stats.addSummary(segment.summary);
+    }
+    resetDueEvents();
+}
+
+LoanRecord* LoanManager::findActiveLoan(const std::string& username, int bookId) const {
+    auto userIt = activeLoans.find(username);
+    if (userIt == activeLoans.end()) {
+        return nullptr;
+    }
+    
+    auto bookIt = userIt->second.find(bookId);
+    if (bookIt == userIt->second.end() || bookIt->second.empty()) {
+        return nullptr;
+    }
+    
+    // Oldest active loan first, matching the borrow order
+    return bookIt->second.front();
+}
+
+LoanRecord* LoanManager::findActiveLoanByBarcode(const std::string& barcode) const {
+    auto it = activeByBarcode.find(barcode);
+    return it == activeByBarcode.end() ? nullptr : it->second;
+}
+
+std::vector<LoanRecord*> LoanManager::getActiveLoans() const {
+    std::vector<LoanRecord*> result;
+    result.reserve(dueIndex.size());
+    for (const auto& entry : dueIndex) {
+        result.push_back(entry.second);
+    }
+    return result;
+}
+
+void LoanManager::assignBarcode(LoanRecord* loan, const std::string& barcode) {
+    if (!loan || loan->getBarcode() == barcode) {
+        return;
+    }
+    
+    if (!loan->isReturned()) {
+        auto it = activeByBarcode.find(loan->getBarcode());
+        if (it != activeByBarcode.end() && it->second == loan) {
+            activeByBarcode.erase(it);
+        }
+        if (!barcode.empty()) {
+            activeByBarcode[barcode] = loan;
+        }
+    }
+    loan->setBarcode(barcode);
+}
+
+std::vector<LoanRecord*> LoanManager::getActiveLoansForUser(const std::string& username) const {
+    std::vector<LoanRecord*> result;
+    
+    auto userIt = activeLoans.find(username);
+    if (userIt == activeLoans.end()) {
+        return result;
+    }
+    
+    for (const auto& entry : userIt->second) {
+        result.insert(result.end(), entry.second.begin(), entry.second.end());
+    }
+    
+    // Borrow order, as in the full history
+    SortUtil::radixSort(result, [](const LoanRecord* loan) {
+        return static_cast<long long>(loan->getBorrowDate());
+    });
+    return result;
+}
+
+int LoanManager::getActiveLoanCount(const std::string& username) const {
+    auto it = activeCountByUser.find(username);
+    return it == activeCountByUser.end() ? 0 : it->second;
+}
+
+int LoanManager::getActiveBorrowerCount(int bookId) const {
+    auto it = activeCountByBook.find(bookId);
+    return it == activeCountByBook.end() ? 0 : it->second;
+}
+
+size_t LoanManager::getActiveLoanTotal() const {
+    return dueIndex.size();
+}
+
+// Due-date events
+void LoanManager::setOutboxFile(const std::string& filename) {
+    {
+        std::lock_guard<std::mutex> lock(schedulerMutex);
+        outboxFile = filename;
+    }
+    resetDueEvents();
+}
+
+void LoanManager::setReminderLeadDays(int days) {
+    {
+        std::lock_guard<std::mutex> lock(schedulerMutex);
+        reminderLeadSeconds = static_cast<time_t>(days > 0 ? days : 0) * 24 * 60 * 60;
+    }
+    resetDueEvents();
+}
+
+time_t LoanManager::readLastEventRun() const {
+    std::ifstream state(outboxFile + ".state");
+    long long lastRun = 0;
+    if (!(state >> lastRun)) {
+        return 0;
+    }
+    return static_cast<time_t>(lastRun);
+}
+
+void LoanManager::resetDueEvents() {
+    std::lock_guard<std::mutex> lock(schedulerMutex);
+    dueEvents.clear();
+    loanTimers.clear();
+    
+    if (outboxFile.empty()) {
+        dueWheel.reset(time(nullptr));
+        return;
+    }
+    
+    // Resume from the last processed time; on the first run start from now without back-filling
+    time_t lastRun = readLastEventRun();
+    dueWheel.reset(lastRun > 0 ? lastRun : time(nullptr));
+    
+    for (const auto& loan : loans) {
+        if (!loan.isReturned()) {
+            addDueTimer("reminder", &loan, loan.getDueDate() - reminderLeadSeconds);
+            addDueTimer("overdue", &loan, loan.getDueDate() + 1);
+        }
+    }
+}
+
+void LoanManager::addDueTimer(const std::string& type, const LoanRecord* loan, time_t deadline) {
+    // Events at or before the last processed time were already written
+    if (deadline <= dueWheel.getProcessedUntil()) {
+        return;
+    }
+    
+    unsigned long id = nextTimerId++;
+    dueEvents[id] = DueEvent{type, loan, loan->getUsername(), loan->getBookId(), loan->getDueDate()};
+    loanTimers[loan].push_back(id);
+    dueWheel.schedule(deadline, id);
+}
+
+void LoanManager::scheduleDueEvents(const LoanRecord* loan) {
+    std::lock_guard<std::mutex> lock(schedulerMutex);
+    if (outboxFile.empty()) {
+        return;
+    }
+    
+    addDueTimer("reminder", loan, loan->getDueDate() - reminderLeadSeconds);
+    addDueTimer("overdue", loan, loan->getDueDate() + 1);
+}
+
+void LoanManager::cancelDueEvents(const LoanRecord* loan) {
+    std::lock_guard<std::mutex> lock(schedulerMutex);
+    auto it = loanTimers.find(loan);
+    if (it == loanTimers.end()) {
+        return;
+    }
+    
+    // Timers stay in the wheel and are skipped when they fire
+    for (unsigned long id : it->second) {
+        dueEvents.erase(id);
+    }
+    loanTimers.erase(it);
+}
+
+size_t LoanManager::processDueEvents(time_t now) {
+    std::lock_guard<std::mutex> lock(schedulerMutex);
+    if (outboxFile.empty()) {
+        return 0;
+    }
+    
+    std::vector<std::pair<unsigned long, time_t>> fired;
+    dueWheel.advance(now, [this, &fired](const TimingWheel::Timer& timer) {
+        if (dueEvents.count(timer.id) != 0) {
+            fired.push_back({timer.id, timer.deadline});
+        }
+    });
+    
+    std::string lines;
+    for (const auto& entry : fired) {
+        const DueEvent& event = dueEvents[entry.first];
+        auto eventJson = SimpleJSON::JSONValue::createObject();
+        eventJson->set("type", event.type);
+        eventJson->set("username", event.username);
+        eventJson->set("bookId", event.bookId);
+        eventJson->set("dueDate", static_cast<int>(event.dueDate));
+        eventJson->set("firedAt", static_cast<int>(now));
+        lines += SimpleJSON::stringifyJSON(eventJson) + "\n";
+    }
+    
+    if (!lines.empty()) {
+        std::ofstream outbox(outboxFile, std::ios::app);
+        if (!outbox.is_open() || !(outbox << lines)) {
+            // Put the events back so the next run retries them
+            std::cerr << "Error writing loan events to " << outboxFile << std::endl;
+            for (const auto& entry : fired) {
+                dueWheel.schedule(entry.second, entry.first);
+            }
+            return 0;
+        }
+    }
+    
+    for (const auto& entry : fired) {
+        auto eventIt = dueEvents.find(entry.first);
+        auto timersIt = loanTimers.find(eventIt->second.loan);
+        if (timersIt != loanTimers.end()) {
+            auto& ids = timersIt->second;
+            for (size_t i = 0; i < ids.size(); ++i) {
+                if (ids[i] == entry.first) {
+                    ids.erase(ids.begin() + i);
+                    break;
+                }
+            }
+            if (ids.empty()) {
+                loanTimers.erase(timersIt);
+            }
+        }
+        dueEvents.erase(eventIt);
+    }
+    
+    std::ofstream state(outboxFile + ".state");
+    state << static_cast<long long>(now) << "\n";
+    
+    return fired.size();
+}
+
+size_t LoanManager::catchUpDueEvents() {
+    return processDueEvents(time(nullptr));
+}
+
+void LoanManager::startScheduler(int intervalSeconds) {
+    if (schedulerThread.joinable()) {
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(schedulerMutex);
+        schedulerStopping = false;
+    }
+    schedulerThread = std::thread(&LoanManager::schedulerLoop, this, intervalSeconds > 0 ? intervalSeconds : 1);
+}
+
+void LoanManager::stopScheduler() {
+    if (!schedulerThread.joinable()) {
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(schedulerMutex);
+        schedulerStopping = true;
+    }
+    schedulerWake.notify_all();
+    schedulerThread.join();
+}
+
+void LoanManager::schedulerLoop(int intervalSeconds) {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(schedulerMutex);
+            if (schedulerWake.wait_for(lock, std::chrono::seconds(intervalSeconds),
+                                       [this] { return schedulerStopping; })) {
+                return;
+            }
+        }
+        processDueEvents(time(nullptr));
+    }
 }
 
 // Get loans
 std::vector<LoanRecord*> LoanManager::getLoansForUser(const std::string& username) const {
-    auto it = SearchUtil::mapFind(userLoans, username);
+    auto it = userLoans.find(username);
     if (it == userLoans.end()) {
         return std::vector<LoanRecord*>();
     }
@@ -69,7 +513,7 @@ std::vector<LoanRecord*> LoanManager::getLoansForUser(const std::string& usernam
 }
 
 std::vector<LoanRecord*> LoanManager::getLoansForBook(int bookId) const {
-    auto it = SearchUtil::mapFind(bookLoans, bookId);
+    auto it = bookLoans.find(bookId);
     if (it == bookLoans.end()) {
         return std::vector<LoanRecord*>();
     }
@@ -77,17 +521,39 @@ std::vector<LoanRecord*> LoanManager::getLoansForBook(int bookId) const {
 }
 
 std::vector<LoanRecord*> LoanManager::getOverdueLoans() const {
+    return getOverdueLoans(time(nullptr));
+}
+
+std::vector<LoanRecord*> LoanManager::getOverdueLoans(time_t asOf) const {
+    // Active loans due strictly before asOf form a prefix of the due-date index
     std::vector<LoanRecord*> overdueLoans;
-    
-    for (const auto& loan : loans) {
-        if (!loan.isReturned() && loan.isOverdue()) {
-            overdueLoans.push_back(const_cast<LoanRecord*>(&loan));
-        }
+    auto end = dueIndex.lower_bound(asOf);
+    for (auto it = dueIndex.begin(); it != end; ++it) {
+        overdueLoans.push_back(it->second);
     }
     
     return overdueLoans;
 }
 
+std::vector<LoanRecord*> LoanManager::getLoansDueBetween(time_t from, time_t to) const {
+    std::vector<LoanRecord*> dueLoans;
+    if (to < from) {
+        return dueLoans;
+    }
+    
+    auto end = dueIndex.upper_bound(to);
+    for (auto it = dueIndex.lower_bound(from); it != end; ++it) {
+        dueLoans.push_back(it->second);
+    }
+    
+    return dueLoans;
+}
+
+std::vector<LoanRecord*> LoanManager::getLoansDueWithin(int days) const {
+    time_t now = time(nullptr);
+    return getLoansDueBetween(now, now + static_cast<time_t>(days) * 24 * 60 * 60);
+}
+
 std::vector<LoanRecord*> LoanManager::getAllLoans() const {
     std::vector<LoanRecord*> allLoans;
     
@@ -112,6 +578,36 @@ double LoanManager::calculateFine(const LoanRecord& loan) const {
     return finePolicy.calculateFine(overdueDays);
 }
 
+std::vector<double> LoanManager::calculateFines(const std::vector<LoanRecord*>& loanList, time_t asOf) const {
+    std::vector<int> overdueDays(loanList.size());
+    for (size_t i = 0; i < loanList.size(); ++i) {
+        overdueDays[i] = loanList[i]->getDaysOverdue(asOf);
+    }
+    
+    std::vector<double> fines;
+    finePolicy.calculateFines(overdueDays, fines);
+    return fines;
+}
+
+double LoanManager::calculateUserFines(const std::string& username) const {
+    double total = 0.0;
+    auto it = userLoans.find(username);
+    if (it != userLoans.end()) {
+        for (double fine : calculateFines(it->second, time(nullptr))) {
+            total += fine;
+        }
+    }
+    
+    // Archived loans are all returned; their overdue days come from the segment summaries
+    const std::map<int, int>* archived = archive.getOverdueDays(username);
+    if (archived) {
+        for (const auto& entry : *archived) {
+            total += finePolicy.calculateFine(entry.first) * entry.second;
+        }
+    }
+    return total;
+}
+
 // File operations
 bool LoanManager::loadFromFile(const std::string& filename) {
     try {
@@ -124,8 +620,7 @@ bool LoanManager::loadFromFile(const std::string& filename) {
         auto j = SimpleJSON::parseJSON(jsonStr);
         
         loans.clear();
-        bookLoans.clear();
-        userLoans.clear();
+        archive.load();
         
         // Load fine policy
         if (j->contains("finePolicy")) {
@@ -137,6 +632,11 @@ bool LoanManager::loadFromFile(const std::string& filename) {
             );
         }
         
+        archiveHorizonDays = 0;
+        if (j->contains("archivePolicy")) {
+            setArchiveHorizonDays(j->at("archivePolicy")->at("horizonDays")->getInt());
+        }
+        
         // Load loans
         if (j->contains("loans")) {
             const auto& loansArray = j->at("loans")->getArray();
@@ -153,15 +653,21 @@ bool LoanManager::loadFromFile(const std::string& filename) {
                     loan.setReturnDate(loanJsonPtr->at("returnDate")->getInt());
                 }
                 
+                if (loanJsonPtr->contains("barcode")) {
+                    loan.setBarcode(loanJsonPtr->at("barcode")->getString());
+                }
+                
+                // Already in an archive segment (archived, but loans.json was not rewritten yet)
+                if (archive.isArchived(loan)) {
+                    continue;
+                }
+                
                 loans.push_back(loan);
             }
         }
         
-        // Rebuild lookup maps
-        for (auto& loan : loans) {
-            bookLoans[loan.getBookId()].push_back(&loan);
-            userLoans[loan.getUsername()].push_back(&loan);
-        }
+        // Rebuild lookup maps and the active loan index
+        rebuildIndexes();
         
         return true;
     } catch (const std::exception& e) {
@@ -181,6 +687,12 @@ bool LoanManager::saveToFile(const std::string& filename) const {
         finePolicyJson->set("incrementalFactor", finePolicy.getIncrementalFactor());
         j->set("finePolicy", finePolicyJson);
         
+        if (archiveHorizonDays > 0) {
+            auto archivePolicyJson = SimpleJSON::JSONValue::createObject();
+            archivePolicyJson->set("horizonDays", archiveHorizonDays);
+            j->set("archivePolicy", archivePolicyJson);
+        }
+        
         // Save loans
         auto loansArray = SimpleJSON::JSONValue::createArray();
         for (const auto& loan : loans) {
@@ -194,6 +706,10 @@ bool LoanManager::saveToFile(const std::string& filename) const {
                 loanJson->set("returnDate", static_cast<int>(loan.getReturnDate()));
             }
             
+            if (!loan.getBarcode().empty()) {
+                loanJson->set("barcode", loan.getBarcode());
+            }
+            
             loansArray->push_back(loanJson);
         }
         j->set("loans", loansArray);
@@ -211,54 +727,108 @@ bool LoanManager::saveToFile(const std::string& filename) const {
     }
 }
 
-// Statistics and visualization
-std::unordered_map<int, int> LoanManager::getBookBorrowStats() const {
-    std::unordered_map<int, int> stats;
-    
-    for (const auto& loan : loans) {
-        stats[loan.getBookId()]++;
+// Loan history archive
+void LoanManager::setArchiveDirectory(const std::string& directory) {
+    archive.setDirectory(directory);
+}
+
+void LoanManager::setArchiveHorizonDays(int days) {
+    if (days <= 0) {
+        archiveHorizonDays = 0;
+    } else {
+        archiveHorizonDays = days < MIN_ARCHIVE_HORIZON_DAYS ? MIN_ARCHIVE_HORIZON_DAYS : days;
     }
-    
-    return stats;
 }
 
-std::unordered_map<std::string, int> LoanManager::getUserBorrowStats() const {
-    std::unordered_map<std::string, int> stats;
+int LoanManager::getArchiveHorizonDays() const {
+    return archiveHorizonDays;
+}
+
+size_t LoanManager::archiveReturnedLoans(time_t now) {
+    if (archiveHorizonDays <= 0 || archive.getDirectory().empty()) {
+        return 0;
+    }
+    
+    time_t cutoff = now - static_cast<time_t>(archiveHorizonDays) * 24 * 60 * 60;
+    if (cutoff <= archive.getArchivedBefore()) {
+        return 0;
+    }
+    
+    std::vector<const LoanRecord*> cold;
+    for (const auto& loan : loans) {
+        if (loan.isReturned() && loan.getReturnDate() < cutoff) {
+            cold.push_back(&loan);
+        }
+    }
+    if (!archive.append(cold, cutoff)) {
+        return 0;
+    }
+    if (cold.empty()) {
+        return 0;
+    }
     
+    // Keep only the hot tier; records move, so every index is rebuilt
+    std::deque<LoanRecord> hot;
     for (const auto& loan : loans) {
-        stats[loan.getUsername()]++;
+        if (!archive.isArchived(loan)) {
+            hot.push_back(loan);
+        }
     }
+    loans.swap(hot);
+    rebuildIndexes();
     
+    return cold.size();
+}
+
+const LoanArchive& LoanManager::getArchive() const {
+    return archive;
+}
+
+// Statistics and visualization
+const CirculationStats& LoanManager::getCirculationStats() const {
     return stats;
 }
 
+const LoanColumns& LoanManager::getLoanColumns() const {
+    return columns;
+}
+
+const std::unordered_map<int, int>& LoanManager::getBookBorrowStats() const {
+    return stats.getBookCounts();
+}
+
+const std::unordered_map<std::string, int>& LoanManager::getUserBorrowStats() const {
+    return stats.getUserCounts();
+}
+
 std::vector<std::pair<std::string, int>> LoanManager::getMonthlyStats() const {
-    std::unordered_map<std::string, int> statsMap;
-    
-    for (const auto& loan : loans) {
-        time_t borrowTime = loan.getBorrowDate();
-        struct tm* timeInfo = localtime(&borrowTime);
-        
-        char buffer[8];
-        strftime(buffer, 8, "%Y-%m", timeInfo);
-        std::string month(buffer);
-        
-        statsMap[month]++;
-    }
+    std::vector<std::pair<std::string, int>> result;
+    const CalendarUtil::DenseSeries& monthly = stats.getMonthlyBorrows();
+    const std::vector<int>& counts = monthly.values();
     
-    std::vector<std::pair<std::string, int>> stats;
-    for (const auto& pair : statsMap) {
-        stats.push_back(pair);
+    // Dense array indexed by month ordinal, so the result is already in month order
+    for (size_t i = 0; i < counts.size(); ++i) {
+        if (counts[i] > 0) {
+            int month = static_cast<int>(monthly.firstOrdinal() + static_cast<long long>(i));
+            result.push_back({CalendarUtil::formatMonth(month), counts[i]});
+        }
     }
-    
-    return stats;
+    return result;
+}
+
+void LoanManager::setBookCategories(int bookId, const std::vector<std::string>& categories) {
+    stats.setBookCategories(bookId, categories);
+}
+
+void LoanManager::removeBookCategories(int bookId) {
+    stats.removeBook(bookId);
 }
 
 // Display
 void LoanManager::displayUserLoans(const std::string& username) const {
     std::cout << "===== Loans for " << username << " =====" << std::endl;
     
-    auto it = SearchUtil::mapFind(userLoans, username);
+    auto it = userLoans.find(username);
     if (it == userLoans.end() || it->second.empty()) {
         std::cout << "No loans found." << std::endl;
         return;
@@ -296,25 +866,25 @@ void LoanManager::displayUserLoans(const std::string& username) const {
 void LoanManager::displayOverdueLoans() const {
     std::cout << "===== Overdue Loans =====" << std::endl;
     
-    bool hasOverdue = false;
+    // One clock read for the whole report; the due-date index yields the overdue prefix
+    time_t now = time(nullptr);
+    auto overdueLoans = getOverdueLoans(now);
+    std::vector<double> fines = calculateFines(overdueLoans, now);
     
-    for (const auto& loan : loans) {
-        if (!loan.isReturned() && loan.isOverdue()) {
-            hasOverdue = true;
-            
-            int days = loan.getDaysOverdue();
-            double fine = finePolicy.calculateFine(days);
-            
-            std::cout << "Book ID: " << loan.getBookId() << "\n"
-                      << "Username: " << loan.getUsername() << "\n"
-                      << "Due Date: " << formatDate(loan.getDueDate()) << "\n"
-                      << "Days Overdue: " << days << "\n"
-                      << "Fine: $" << std::fixed << std::setprecision(2) << fine << "\n"
-                      << "------------------------------\n";
-        }
+    for (size_t i = 0; i < overdueLoans.size(); ++i) {
+        const LoanRecord* loan = overdueLoans[i];
+        int days = loan->getDaysOverdue(now);
+        double fine = fines[i];
+        
+        std::cout << "Book ID: " << loan->getBookId() << "\n"
+                  << "Username: " << loan->getUsername() << "\n"
+                  << "Due Date: " << formatDate(loan->getDueDate()) << "\n"
+                  << "Days Overdue: " << days << "\n"
+                  << "Fine: $" << std::fixed << std::setprecision(2) << fine << "\n"
+                  << "------------------------------\n";
     }
     
-    if (!hasOverdue) {
+    if (overdueLoans.empty()) {
         std::cout << "No overdue loans found." << std::endl;
     }
 }
@@ -322,7 +892,18 @@ void LoanManager::displayOverdueLoans() const {
 void LoanManager::displayLoanHistory() const {
     std::cout << "===== Loan History =====" << std::endl;
     
+    // Oldest borrow first; stable radix sort on the timestamp keeps record order for ties
+    std::vector<const LoanRecord*> history;
+    history.reserve(loans.size());
     for (const auto& loan : loans) {
+        history.push_back(&loan);
+    }
+    SortUtil::radixSort(history, [](const LoanRecord* loan) {
+        return static_cast<long long>(loan->getBorrowDate());
+    });
+    
+    for (const LoanRecord* record : history) {
+        const LoanRecord& loan = *record;
         std::cout << "Book ID: " << loan.getBookId() << "\n"
                   << "Username: " << loan.getUsername() << "\n"
                   << "Borrow Date: " << formatDate(loan.getBorrowDate()) << "\n"
@@ -9,14 +9,15 @@ LoanRecord::LoanRecord()
 LoanRecord::LoanRecord(const std::string& username, int bookId, time_t borrowDate, 
                        time_t dueDate, int graceDays)
     : username(username), bookId(bookId), borrowDate(borrowDate), 
-      dueDate(dueDate), returnDate(0), fineAmount(0) {}
+      dueDate(dueDate), returnDate(0) {}
 
 // Getters
 int LoanRecord::getBookId() const { return bookId; }
-std::string LoanRecord::getUsername() const { return username; }
+const std::string& LoanRecord::getUsername() const { return username; }
 time_t LoanRecord::getBorrowDate() const { return borrowDate; }
 time_t LoanRecord::getDueDate() const { return dueDate; }
 time_t LoanRecord::getReturnDate() const { return returnDate; }
+const std::string& LoanRecord::getBarcode() const { return barcode; }
 
 // Setters
 void LoanRecord::setBookId(int bookId) { this->bookId = bookId; }
@@ -24,6 +25,7 @@ void LoanRecord::setUsername(const std::string& username) { this->username = use
 void LoanRecord::setBorrowDate(time_t borrowDate) { this->borrowDate = borrowDate; }
 void LoanRecord::setDueDate(time_t dueDate) { this->dueDate = dueDate; }
 void LoanRecord::setReturnDate(time_t returnDate) { this->returnDate = returnDate; }
+void LoanRecord::setBarcode(const std::string& barcode) { this->barcode = barcode; }
 
 // Operations
 bool LoanRecord::isReturned() const { return returnDate != 0; }
@@ -0,0 +1,92 @@
+#include "../include/QueryCache.h"
+
+QueryCache::QueryCache(size_t capacity)
+    : capacity(capacity), epoch(0), hits(0), misses(0), evictions(0),
+      invalidations(0), memoryBytes(0) {}
+
+size_t QueryCache::entryBytes(const Entry& entry) {
+    // 串列節點 + 雜湊節點各保存一份鍵
+    return sizeof(Entry) + 2 * entry.key.capacity() +
+           entry.ordinals.capacity() * sizeof(int) +
+           sizeof(std::list<Entry>::iterator) + 4 * sizeof(void*);
+}
+
+void QueryCache::syncEpoch(unsigned long catalogEpoch) {
+    if (catalogEpoch == epoch) {
+        return;
+    }
+
+    invalidations += lru.size();
+    lru.clear();
+    index.clear();
+    memoryBytes = 0;
+    epoch = catalogEpoch;
+}
+
+void QueryCache::evictLast() {
+    if (lru.empty()) {
+        return;
+    }
+
+    const Entry& last = lru.back();
+    memoryBytes -= entryBytes(last);
+    index.erase(last.key);
+    lru.pop_back();
+    evictions++;
+}
+
+const std::vector<int>* QueryCache::lookup(const std::string& key, unsigned long catalogEpoch) {
+    syncEpoch(catalogEpoch);
+
+    auto it = index.find(key);
+    if (it == index.end()) {
+        misses++;
+        return nullptr;
+    }
+
+    lru.splice(lru.begin(), lru, it->second);
+    hits++;
+    return &it->second->ordinals;
+}
+
+void QueryCache::store(const std::string& key, unsigned long catalogEpoch, std::vector<int> ordinals) {
+    syncEpoch(catalogEpoch);
+
+    if (capacity == 0) {
+        return;
+    }
+
+    auto it = index.find(key);
+    if (it != index.end()) {
+        memoryBytes -= entryBytes(*it->second);
+        it->second->ordinals = std::move(ordinals);
+        memoryBytes += entryBytes(*it->second);
+        lru.splice(lru.begin(), lru, it->second);
+        return;
+    }
+
+    while (lru.size() >= capacity) {
+        evictLast();
+    }
+
+    lru.push_front(Entry{key, std::move(ordinals)});
+    index[key] = lru.begin();
+    memoryBytes += entryBytes(lru.front());
+}
+
+void QueryCache::clear() {
+    lru.clear();
+    index.clear();
+    memoryBytes = 0;
+}
+
+void QueryCache::setCapacity(size_t newCapacity) {
+    capacity = newCapacity;
+    while (lru.size() > capacity) {
+        evictLast();
+    }
+}
+
+QueryCacheStats QueryCache::getStats() const {
+    return {hits, misses, evictions, invalidations, lru.size(), capacity, memoryBytes};
+}
@@ -11,6 +11,11 @@ std::string QueryMatcher::toLower(const std::string& str) {
 
 bool QueryMatcher::matchString(const std::string& text, FieldOperator op, 
                               const std::string& value, bool ignoreCase) {
+    if (op == FieldOperator::CONTAINS) {
+        return ignoreCase ? SearchUtil::containsIgnoreCase(text, value)
+                          : SearchUtil::contains(text, value);
+    }
+    
     std::string compareValue = ignoreCase ? toLower(text) : text;
     std::string compareQuery = ignoreCase ? toLower(value) : value;
     
@@ -18,9 +23,6 @@ bool QueryMatcher::matchString(const std::string& text, FieldOperator op,
         case FieldOperator::EQUALS:
             return compareValue == compareQuery;
             
-        case FieldOperator::CONTAINS:
-            return SearchUtil::contains(compareValue, compareQuery);
-            
         case FieldOperator::GREATER:
             return compareValue > compareQuery;
             
@@ -0,0 +1,277 @@
+#include "../include/QueryProgram.h"
+#include "../include/SearchUtil.h"
+#include "../include/SortUtil.h"
+#include "../include/TextUtils.h"
+#include <cctype>
+
+namespace {
+    bool applyOrdering(int cmp, FieldOperator op) {
+        switch (op) {
+            case FieldOperator::EQUALS:     return cmp == 0;
+            case FieldOperator::GREATER:    return cmp > 0;
+            case FieldOperator::LESS:       return cmp < 0;
+            case FieldOperator::GREATER_EQ: return cmp >= 0;
+            case FieldOperator::LESS_EQ:    return cmp <= 0;
+            default:                        return false;
+        }
+    }
+
+    // 兩邊皆已正規化，直接以位元組比較
+    bool matchString(const std::string& text, FieldOperator op, const std::string& value) {
+        if (op == FieldOperator::CONTAINS) {
+            return SearchUtil::contains(text, value);
+        }
+        return applyOrdering(text.compare(value), op);
+    }
+
+    // 將同類型（AND 或 OR）的連續節點攤平成一個運算元列表
+    void collectOperands(const std::shared_ptr<QueryNode>& node, NodeType type,
+                         std::vector<std::shared_ptr<QueryNode>>& operands) {
+        if (node && node->type == type) {
+            collectOperands(node->left, type, operands);
+            collectOperands(node->right, type, operands);
+        } else {
+            operands.push_back(node);
+        }
+    }
+
+    std::string lengthPrefixed(const std::string& text) {
+        return std::to_string(text.size()) + ":" + text;
+    }
+
+    bool matchInt(int number, FieldOperator op, int queryValue) {
+        switch (op) {
+            case FieldOperator::EQUALS:     return number == queryValue;
+            case FieldOperator::GREATER:    return number > queryValue;
+            case FieldOperator::LESS:       return number < queryValue;
+            case FieldOperator::GREATER_EQ: return number >= queryValue;
+            case FieldOperator::LESS_EQ:    return number <= queryValue;
+            default:                        return false;
+        }
+    }
+}
+
+bool FieldPredicate::isNumeric() const {
+    return field == BookField::YEAR || field == BookField::PAGE_COUNT ||
+           field == BookField::TOTAL_COPIES || field == BookField::AVAILABLE_COPIES;
+}
+
+bool FieldPredicate::matches(const Book& book, const BookShadow& shadow) const {
+    switch (field) {
+        case BookField::TITLE:     return matchString(shadow.title, op, value);
+        case BookField::AUTHOR:    return matchString(shadow.author, op, value);
+        case BookField::ISBN:      return matchString(shadow.isbn, op, value);
+        case BookField::PUBLISHER: return matchString(shadow.publisher, op, value);
+        case BookField::LANGUAGE:  return matchString(shadow.language, op, value);
+        case BookField::SYNOPSIS:  return matchString(shadow.synopsis, op, value);
+
+        case BookField::CATEGORY:
+            for (const auto& category : shadow.categories) {
+                if (matchString(category, op, value)) {
+                    return true;
+                }
+            }
+            return false;
+
+        case BookField::YEAR:
+            return numberValid && matchInt(book.getYear(), op, number);
+        case BookField::PAGE_COUNT:
+            return numberValid && matchInt(book.getPageCount(), op, number);
+        case BookField::TOTAL_COPIES:
+            return numberValid && matchInt(book.getTotalCopies(), op, number);
+        case BookField::AVAILABLE_COPIES:
+            return numberValid && matchInt(book.getAvailableCopies(), op, number);
+
+        case BookField::UNKNOWN:
+        default:
+            return false;
+    }
+}
+
+QueryProgram::QueryProgram() : maxStackDepth(0) {}
+
+BookField QueryProgram::resolveField(const std::string& fieldName) {
+    std::string lowerField = fieldName;
+    for (char& c : lowerField) c = std::tolower(c);
+
+    if (lowerField == "title" || lowerField == "標題") return BookField::TITLE;
+    if (lowerField == "author" || lowerField == "作者") return BookField::AUTHOR;
+    if (lowerField == "year" || lowerField == "年份") return BookField::YEAR;
+    if (lowerField == "isbn") return BookField::ISBN;
+    if (lowerField == "publisher" || lowerField == "出版社") return BookField::PUBLISHER;
+    if (lowerField == "language" || lowerField == "語言") return BookField::LANGUAGE;
+    if (lowerField == "pagecount" || lowerField == "頁數") return BookField::PAGE_COUNT;
+    if (lowerField == "category" || lowerField == "類別" || lowerField == "標籤") return BookField::CATEGORY;
+    if (lowerField == "synopsis" || lowerField == "簡介" || lowerField == "概要") return BookField::SYNOPSIS;
+    if (lowerField == "copies" || lowerField == "totalcopies" || lowerField == "總數量") return BookField::TOTAL_COPIES;
+    if (lowerField == "availablecopies" || lowerField == "可用數量") return BookField::AVAILABLE_COPIES;
+
+    return BookField::UNKNOWN;
+}
+
+QueryProgram QueryProgram::compile(const std::shared_ptr<QueryNode>& root) {
+    QueryProgram program;
+    program.maxStackDepth = program.emit(root, 1);
+    return program;
+}
+
+// 以後序輸出指令，回傳此子樹執行時所需的最大堆疊深度
+int QueryProgram::emit(const std::shared_ptr<QueryNode>& node, int depth) {
+    if (!node) {
+        code.push_back({QueryOpCode::PUSH_FALSE, 0});
+        return depth;
+    }
+
+    switch (node->type) {
+        case NodeType::TERM:
+        case NodeType::KEYWORD_QUERY: {
+            terms.push_back(node->term);
+            code.push_back({QueryOpCode::TEST_TERM, static_cast<int>(terms.size() - 1)});
+            return depth;
+        }
+
+        case NodeType::FIELD_QUERY: {
+            FieldPredicate predicate;
+            predicate.field = resolveField(node->field);
+            predicate.op = node->fieldOp;
+            predicate.value = node->fieldValue;
+            predicate.number = 0;
+            predicate.numberValid = false;
+
+            if (predicate.isNumeric()) {
+                try {
+                    predicate.number = std::stoi(node->fieldValue);
+                    predicate.numberValid = true;
+                } catch (const std::exception&) {
+                    predicate.numberValid = false;
+                }
+            } else {
+                predicate.value = TextUtils::normalizeForSearch(node->fieldValue);
+            }
+
+            if (predicate.field == BookField::UNKNOWN) {
+                code.push_back({QueryOpCode::PUSH_FALSE, 0});
+                return depth;
+            }
+
+            predicates.push_back(predicate);
+            code.push_back({QueryOpCode::TEST_FIELD, static_cast<int>(predicates.size() - 1)});
+            return depth;
+        }
+
+        case NodeType::AND:
+        case NodeType::OR: {
+            int leftDepth = emit(node->left, depth);
+            int rightDepth = emit(node->right, depth + 1);
+            code.push_back({node->type == NodeType::AND ? QueryOpCode::AND : QueryOpCode::OR, 0});
+            return leftDepth > rightDepth ? leftDepth : rightDepth;
+        }
+
+        case NodeType::NOT: {
+            int childDepth = emit(node->left, depth);
+            code.push_back({QueryOpCode::NOT, 0});
+            return childDepth;
+        }
+    }
+
+    code.push_back({QueryOpCode::PUSH_FALSE, 0});
+    return depth;
+}
+
+std::string QueryProgram::canonicalKey(const std::shared_ptr<QueryNode>& node) {
+    if (!node) {
+        return "0";
+    }
+
+    switch (node->type) {
+        case NodeType::TERM:
+        case NodeType::KEYWORD_QUERY: {
+            return "T" + lengthPrefixed(TextUtils::normalizeForSearch(node->term));
+        }
+
+        case NodeType::FIELD_QUERY: {
+            BookField field = resolveField(node->field);
+            if (field == BookField::UNKNOWN) {
+                return "0";
+            }
+
+            FieldPredicate predicate{field, node->fieldOp, node->fieldValue, 0, false};
+            std::string prefix = "F" + std::to_string(static_cast<int>(field)) +
+                                 "o" + std::to_string(static_cast<int>(node->fieldOp));
+
+            if (predicate.isNumeric()) {
+                try {
+                    return prefix + "#" + std::to_string(std::stoi(node->fieldValue));
+                } catch (const std::exception&) {
+                    return "0";
+                }
+            }
+
+            return prefix + "=" + lengthPrefixed(TextUtils::normalizeForSearch(node->fieldValue));
+        }
+
+        case NodeType::AND:
+        case NodeType::OR: {
+            std::vector<std::shared_ptr<QueryNode>> operands;
+            collectOperands(node, node->type, operands);
+
+            std::vector<std::string> keys;
+            keys.reserve(operands.size());
+            for (const auto& operand : operands) {
+                keys.push_back(canonicalKey(operand));
+            }
+            SortUtil::sort(keys);
+
+            std::string key = node->type == NodeType::AND ? "A(" : "O(";
+            for (size_t i = 0; i < keys.size(); ++i) {
+                if (i > 0) key += ",";
+                key += keys[i];
+            }
+            return key + ")";
+        }
+
+        case NodeType::NOT:
+            return "N(" + canonicalKey(node->left) + ")";
+    }
+
+    return "0";
+}
+
+const std::vector<QueryInstruction>& QueryProgram::getCode() const { return code; }
+const std::vector<FieldPredicate>& QueryProgram::getPredicates() const { return predicates; }
+const std::vector<std::string>& QueryProgram::getTerms() const { return terms; }
+int QueryProgram::getMaxStackDepth() const { return maxStackDepth; }
+bool QueryProgram::empty() const { return code.empty(); }
+
+bool QueryProgram::matches(const Book& book, const BookShadow& shadow, size_t ordinal,
+                           const std::vector<std::vector<char>>& termHits,
+                           std::vector<char>& stack) const {
+    size_t top = 0;
+
+    for (const auto& instruction : code) {
+        switch (instruction.op) {
+            case QueryOpCode::PUSH_FALSE:
+                stack[top++] = 0;
+                break;
+            case QueryOpCode::TEST_FIELD:
+                stack[top++] = predicates[instruction.operand].matches(book, shadow) ? 1 : 0;
+                break;
+            case QueryOpCode::TEST_TERM:
+                stack[top++] = termHits[instruction.operand][ordinal];
+                break;
+            case QueryOpCode::AND:
+                --top;
+                stack[top - 1] = stack[top - 1] & stack[top];
+                break;
+            case QueryOpCode::OR:
+                --top;
+                stack[top - 1] = stack[top - 1] | stack[top];
+                break;
+            case QueryOpCode::NOT:
+                stack[top - 1] = !stack[top - 1];
+                break;
+        }
+    }
+
+    return top > 0 && stack[top - 1] != 0;
+}
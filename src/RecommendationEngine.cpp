@@ -35,24 +35,19 @@ std::vector<std::string> RecommendationEngine::tokenize(const std::string& text)
 void RecommendationEngine::buildUserLoanMatrix(const LoanManager& loanManager) {
     userLoans.clear();
     
-    // 取得所有使用者統計資料
-    auto userStats = loanManager.getUserBorrowStats();
+    // 直接掃描欄式借閱紀錄的讀者序號與書籍序號，不必逐位讀者取出紀錄
+    const LoanColumns& columns = loanManager.getLoanColumns();
+    const auto& users = columns.users();
+    const auto& books = columns.books();
     
-    // 對每個使用者
-    for (const auto& userPair : userStats) {
-        const std::string& username = userPair.first;
-        
-        // 取得該使用者的所有借閱記錄
-        auto loans = loanManager.getLoansForUser(username);
-        
-        // 建立該使用者借閱過的書籍 ID 集合
-        std::unordered_set<int> bookSet;
-        for (const auto* loan : loans) {
-            bookSet.insert(loan->getBookId());
-        }
-        
-        // 儲存到 userLoans 映射中
-        userLoans[username] = bookSet;
+    std::vector<std::unordered_set<int>> booksByUser(columns.userCount());
+    for (size_t row = 0; row < users.size(); ++row) {
+        booksByUser[users[row]].insert(columns.bookIdAt(books[row]));
+    }
+    
+    // 儲存到 userLoans 映射中
+    for (size_t ordinal = 0; ordinal < booksByUser.size(); ++ordinal) {
+        userLoans[columns.usernameAt(static_cast<int32_t>(ordinal))] = std::move(booksByUser[ordinal]);
     }
 }
 
@@ -261,19 +256,14 @@ std::vector<std::pair<int, double>> RecommendationEngine::getCollaborativeFilter
         recommendations.push_back(pair);
     }
     
-    // 使用改良的排序方式，確保結果一致性
-    SortUtil::sort(recommendations, [](const auto& a, const auto& b) {
+    // 只選出請求的數量，分數相同時依書籍 ID 確保結果一致
+    SortUtil::topK(recommendations, static_cast<size_t>(std::max(count, 0)), [](const auto& a, const auto& b) {
         if (std::abs(a.second - b.second) < 1e-9) {
             return a.first < b.first; // 根據書籍 ID 進行穩定排序
         }
         return a.second > b.second;
     });
     
-    // 限制為請求的數量
-    if (recommendations.size() > static_cast<size_t>(count)) {
-        recommendations.resize(count);
-    }
-    
     return recommendations;
 }
 
@@ -304,16 +294,11 @@ std::vector<std::pair<int, double>> RecommendationEngine::getContentBasedRecomme
         }
     }
     
-    // 按相似度排序（降序）
-    SortUtil::sort(similarities, [](const auto& a, const auto& b) {
+    // 只選出相似度最高的 count 本（降序）
+    SortUtil::topK(similarities, static_cast<size_t>(std::max(count, 0)), [](const auto& a, const auto& b) {
         return a.second > b.second;
     });
     
-    // 限制為請求的數量
-    if (similarities.size() > static_cast<size_t>(count)) {
-        similarities.resize(count);
-    }
-    
     return similarities;
 }
 
@@ -419,8 +404,8 @@ std::vector<std::pair<int, double>> RecommendationEngine::getHybridRecommendatio
         hybrid.push_back(pair);
     }
     
-    // 按最終分數排序
-    SortUtil::sort(hybrid, [](const auto& a, const auto& b) {
+    // 按最終分數選出前 count 名
+    SortUtil::topK(hybrid, static_cast<size_t>(std::max(count, 0)), [](const auto& a, const auto& b) {
         if (std::abs(a.second - b.second) < 1e-9) {
             return a.first < b.first; // 穩定排序
         }
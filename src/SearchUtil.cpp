@@ -1,23 +1,210 @@
 #include "SearchUtil.h"
+#include <atomic>
+#include <cstring>
 
-namespace SearchUtil {
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && defined(__SSE2__)
+#define SEARCH_UTIL_X86 1
+#include <immintrin.h>
+#else
+#define SEARCH_UTIL_X86 0
+#endif
 
-    int indexOf(const std::string& text, const std::string& pattern) {
+namespace {
+
+    inline unsigned char foldAscii(unsigned char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c - 'A' + 'a') : c;
+    }
+
+    /* 針對首、尾兩個位元組預先計算比對條件：(byte | mask) == value
+     * 區分大小寫時 mask = 0；忽略大小寫且為英文字母時 mask = 0x20、value 為小寫，
+     * 如此 'A' 與 'a' 都會命中，且不會誤中其他字元 */
+    struct Needle {
+        const char* data;
+        size_t size;
+        unsigned char first;
+        unsigned char last;
+        unsigned char firstMask;
+        unsigned char lastMask;
+    };
+
+    template <bool IgnoreCase>
+    Needle makeNeedle(const std::string& pattern) {
+        Needle needle;
+        needle.data = pattern.data();
+        needle.size = pattern.size();
+
+        unsigned char first = static_cast<unsigned char>(pattern.front());
+        unsigned char last = static_cast<unsigned char>(pattern.back());
+        unsigned char foldedFirst = first | 0x20;
+        unsigned char foldedLast = last | 0x20;
+        bool firstAlpha = IgnoreCase && foldedFirst >= 'a' && foldedFirst <= 'z';
+        bool lastAlpha = IgnoreCase && foldedLast >= 'a' && foldedLast <= 'z';
+
+        needle.first = firstAlpha ? foldedFirst : first;
+        needle.last = lastAlpha ? foldedLast : last;
+        needle.firstMask = firstAlpha ? 0x20 : 0;
+        needle.lastMask = lastAlpha ? 0x20 : 0;
+        return needle;
+    }
+
+    // 首尾位元組命中後再驗證整段
+    template <bool IgnoreCase>
+    inline bool equalsAt(const char* text, const Needle& needle) {
+        if (!IgnoreCase) {
+            return std::memcmp(text, needle.data, needle.size) == 0;
+        }
+        for (size_t j = 0; j < needle.size; ++j) {
+            if (foldAscii(static_cast<unsigned char>(text[j])) !=
+                foldAscii(static_cast<unsigned char>(needle.data[j]))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <bool IgnoreCase>
+    inline bool candidateAt(const char* text, const Needle& needle) {
+        return (static_cast<unsigned char>(text[0]) | needle.firstMask) == needle.first &&
+               (static_cast<unsigned char>(text[needle.size - 1]) | needle.lastMask) == needle.last &&
+               equalsAt<IgnoreCase>(text, needle);
+    }
+
+    // 純量版本：同時作為短字串與向量化區塊結束後的尾端處理
+    template <bool IgnoreCase>
+    int scalarSearch(const char* text, size_t n, const Needle& needle, size_t start) {
+        const size_t m = needle.size;
+        for (size_t i = start; i + m <= n; ++i) {
+            if (candidateAt<IgnoreCase>(text + i, needle)) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+#if SEARCH_UTIL_X86
+    // 一次比較 16 個起點：首位元組與尾位元組皆命中的位置才逐一驗證
+    template <bool IgnoreCase>
+    int sse2Search(const char* text, size_t n, const Needle& needle) {
+        const size_t m = needle.size;
+        const __m128i first = _mm_set1_epi8(static_cast<char>(needle.first));
+        const __m128i last = _mm_set1_epi8(static_cast<char>(needle.last));
+        const __m128i firstMask = _mm_set1_epi8(static_cast<char>(needle.firstMask));
+        const __m128i lastMask = _mm_set1_epi8(static_cast<char>(needle.lastMask));
+
+        size_t i = 0;
+        for (; i + m - 1 + 16 <= n; i += 16) {
+            __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+            __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i + m - 1));
+            __m128i eqFirst = _mm_cmpeq_epi8(_mm_or_si128(blockFirst, firstMask), first);
+            __m128i eqLast = _mm_cmpeq_epi8(_mm_or_si128(blockLast, lastMask), last);
+            unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_and_si128(eqFirst, eqLast)));
+
+            while (mask != 0) {
+                unsigned int bit = static_cast<unsigned int>(__builtin_ctz(mask));
+                if (equalsAt<IgnoreCase>(text + i + bit, needle)) {
+                    return static_cast<int>(i + bit);
+                }
+                mask &= mask - 1;
+            }
+        }
+        return scalarSearch<IgnoreCase>(text, n, needle, i);
+    }
+
+    template <bool IgnoreCase>
+    __attribute__((target("avx2")))
+    int avx2Search(const char* text, size_t n, const Needle& needle) {
+        const size_t m = needle.size;
+        const __m256i first = _mm256_set1_epi8(static_cast<char>(needle.first));
+        const __m256i last = _mm256_set1_epi8(static_cast<char>(needle.last));
+        const __m256i firstMask = _mm256_set1_epi8(static_cast<char>(needle.firstMask));
+        const __m256i lastMask = _mm256_set1_epi8(static_cast<char>(needle.lastMask));
+
+        size_t i = 0;
+        for (; i + m - 1 + 32 <= n; i += 32) {
+            __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+            __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i + m - 1));
+            __m256i eqFirst = _mm256_cmpeq_epi8(_mm256_or_si256(blockFirst, firstMask), first);
+            __m256i eqLast = _mm256_cmpeq_epi8(_mm256_or_si256(blockLast, lastMask), last);
+            unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_and_si256(eqFirst, eqLast)));
+
+            while (mask != 0) {
+                unsigned int bit = static_cast<unsigned int>(__builtin_ctz(mask));
+                if (equalsAt<IgnoreCase>(text + i + bit, needle)) {
+                    return static_cast<int>(i + bit);
+                }
+                mask &= mask - 1;
+            }
+        }
+        return scalarSearch<IgnoreCase>(text, n, needle, i);
+    }
+#endif
+
+    SearchUtil::SimdLevel detectSimdLevel() {
+#if SEARCH_UTIL_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return SearchUtil::SimdLevel::AVX2;
+        }
+        return SearchUtil::SimdLevel::SSE2;
+#else
+        return SearchUtil::SimdLevel::SCALAR;
+#endif
+    }
+
+    std::atomic<SearchUtil::SimdLevel>& activeSimdLevel() {
+        static std::atomic<SearchUtil::SimdLevel> level(detectSimdLevel());
+        return level;
+    }
+
+    template <bool IgnoreCase>
+    int dispatchSearch(const std::string& text, const std::string& pattern) {
         if (pattern.empty()) return 0;
         const size_t n = text.size(), m = pattern.size();
         if (m > n) return -1;
 
-        for (size_t i = 0; i <= n - m; ++i) {
-            size_t j = 0;
-            for (; j < m && text[i + j] == pattern[j]; ++j);
-            if (j == m) return static_cast<int>(i);
+        Needle needle = makeNeedle<IgnoreCase>(pattern);
+        switch (activeSimdLevel().load(std::memory_order_relaxed)) {
+#if SEARCH_UTIL_X86
+            case SearchUtil::SimdLevel::AVX2:
+                return avx2Search<IgnoreCase>(text.data(), n, needle);
+            case SearchUtil::SimdLevel::SSE2:
+                return sse2Search<IgnoreCase>(text.data(), n, needle);
+#endif
+            default:
+                return scalarSearch<IgnoreCase>(text.data(), n, needle, 0);
         }
-        return -1;
+    }
+
+} // namespace
+
+namespace SearchUtil {
+
+    int indexOf(const std::string& text, const std::string& pattern) {
+        return dispatchSearch<false>(text, pattern);
     }
     int indexOf(const std::string& text, char ch) {
         for (size_t i = 0; i < text.size(); ++i)
             if (text[i] == ch) return static_cast<int>(i);
         return -1;
     }
+    int indexOfIgnoreCase(const std::string& text, const std::string& pattern) {
+        return dispatchSearch<true>(text, pattern);
+    }
+
+    SimdLevel detectedSimdLevel() {
+        static const SimdLevel detected = detectSimdLevel();
+        return detected;
+    }
+    SimdLevel getSimdLevel() {
+        return activeSimdLevel().load(std::memory_order_relaxed);
+    }
+    SimdLevel setSimdLevel(SimdLevel level) {
+        // 不可超過 CPU 實際支援的指令集
+        if (static_cast<int>(level) > static_cast<int>(detectedSimdLevel())) {
+            level = detectedSimdLevel();
+        }
+        activeSimdLevel().store(level, std::memory_order_relaxed);
+        return level;
+    }
 
 } // namespace SearchUtil
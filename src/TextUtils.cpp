@@ -93,4 +93,49 @@ std::unordered_set<std::string> TextUtils::extractBookTerms(const std::string& t
     }
     
     return allTerms;
-} 
\ No newline at end of file
+}
+
+std::string TextUtils::normalizeForSearch(const std::string& text) {
+    std::string result;
+    result.reserve(text.size());
+    
+    for (size_t i = 0; i < text.size(); ) {
+        unsigned char c = text[i];
+        
+        if (c >= 'A' && c <= 'Z') {
+            result += static_cast<char>(c - 'A' + 'a');
+            i++;
+            continue;
+        }
+        
+        if (i + 2 < text.size()) {
+            unsigned char c1 = text[i + 1];
+            unsigned char c2 = text[i + 2];
+            
+            // U+3000 全形空白 = E3 80 80
+            if (c == 0xE3 && c1 == 0x80 && c2 == 0x80) {
+                result += ' ';
+                i += 3;
+                continue;
+            }
+            
+            // U+FF01–U+FF5E = EF BC 81–EF BD 9E，對應 ASCII 0x21–0x7E
+            if (c == 0xEF && ((c1 == 0xBC && c2 >= 0x81 && c2 <= 0xBF) ||
+                              (c1 == 0xBD && c2 >= 0x80 && c2 <= 0x9E))) {
+                unsigned int codePoint = ((c1 & 0x3F) << 6) | (c2 & 0x3F);   // 低 12 位元
+                char ascii = static_cast<char>((0xF000 | codePoint) - 0xFEE0);
+                if (ascii >= 'A' && ascii <= 'Z') {
+                    ascii = static_cast<char>(ascii - 'A' + 'a');
+                }
+                result += ascii;
+                i += 3;
+                continue;
+            }
+        }
+        
+        result += static_cast<char>(c);
+        i++;
+    }
+    
+    return result;
+}
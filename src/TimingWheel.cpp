@@ -0,0 +1,143 @@
+#include "../include/TimingWheel.h"
+
+TimingWheel::TimingWheel(time_t tickSeconds)
+    : tickSeconds(tickSeconds > 0 ? tickSeconds : 1), currentTick(0), timerCount(0) {
+    for (int level = 0; level < LEVELS; ++level) {
+        slots[level].resize(SLOTS);
+        levelCounts[level] = 0;
+    }
+}
+
+long long TimingWheel::tickFor(time_t deadline) const {
+    long long value = static_cast<long long>(deadline);
+    long long ticks = value / tickSeconds;
+    if (ticks * tickSeconds < value) {
+        ++ticks;
+    }
+    return ticks;
+}
+
+void TimingWheel::reset(time_t now) {
+    for (int level = 0; level < LEVELS; ++level) {
+        for (auto& slot : slots[level]) {
+            slot.clear();
+        }
+        levelCounts[level] = 0;
+    }
+    overflow.clear();
+    expired.clear();
+    timerCount = 0;
+    currentTick = static_cast<long long>(now) / tickSeconds + 1;
+}
+
+void TimingWheel::place(const Timer& timer) {
+    long long tick = timer.tick;
+    long long delta = tick - currentTick;
+
+    for (int level = 0; level < LEVELS; ++level) {
+        if (delta < (1LL << (SLOT_BITS * (level + 1)))) {
+            long long index = (tick >> (SLOT_BITS * level)) & (SLOTS - 1);
+            slots[level][static_cast<size_t>(index)].push_back(timer);
+            levelCounts[level]++;
+            return;
+        }
+    }
+
+    overflow.push_back(timer);
+}
+
+void TimingWheel::schedule(time_t deadline, unsigned long id) {
+    Timer timer{deadline, id, tickFor(deadline)};
+    if (timer.tick < currentTick) {
+        expired.push_back(timer);
+    } else {
+        place(timer);
+    }
+    timerCount++;
+}
+
+// 把第 level 層目前所在的格子重新放置到較低的層
+void TimingWheel::cascade(int level) {
+    long long index = (currentTick >> (SLOT_BITS * level)) & (SLOTS - 1);
+    std::vector<Timer> moving;
+    moving.swap(slots[level][static_cast<size_t>(index)]);
+    levelCounts[level] -= moving.size();
+
+    for (const auto& timer : moving) {
+        place(timer);
+    }
+}
+
+size_t TimingWheel::advance(time_t now, const FireCallback& fire) {
+    long long targetTick = static_cast<long long>(now) / tickSeconds;
+    size_t fired = 0;
+
+    if (!expired.empty()) {
+        std::vector<Timer> due;
+        due.swap(expired);
+        timerCount -= due.size();
+        for (const auto& timer : due) {
+            fire(timer);
+            fired++;
+        }
+    }
+
+    while (currentTick <= targetTick) {
+        if (timerCount == 0) {
+            currentTick = targetTick + 1;
+            break;
+        }
+
+        // 進入新的一圈：由低到高逐層下放，上一層的索引也歸零時才繼續往上
+        if ((currentTick & (SLOTS - 1)) == 0) {
+            for (int level = 1; level < LEVELS; ++level) {
+                cascade(level);
+                if (((currentTick >> (SLOT_BITS * level)) & (SLOTS - 1)) != 0) {
+                    break;
+                }
+                if (level == LEVELS - 1 && !overflow.empty()) {
+                    std::vector<Timer> waiting;
+                    waiting.swap(overflow);
+                    for (const auto& timer : waiting) {
+                        place(timer);
+                    }
+                }
+            }
+        }
+
+        // 第 0 層整層為空：直接跳到下一圈的開頭
+        if (levelCounts[0] == 0) {
+            long long nextRound = (currentTick | (SLOTS - 1)) + 1;
+            currentTick = nextRound <= targetTick + 1 ? nextRound : targetTick + 1;
+            continue;
+        }
+
+        std::vector<Timer>& slot = slots[0][static_cast<size_t>(currentTick & (SLOTS - 1))];
+        if (!slot.empty()) {
+            std::vector<Timer> due;
+            due.swap(slot);
+            levelCounts[0] -= due.size();
+            timerCount -= due.size();
+
+            for (const auto& timer : due) {
+                fire(timer);
+                fired++;
+            }
+        }
+        ++currentTick;
+    }
+
+    return fired;
+}
+
+time_t TimingWheel::getProcessedUntil() const {
+    return static_cast<time_t>((currentTick - 1) * tickSeconds);
+}
+
+time_t TimingWheel::getTickSeconds() const {
+    return tickSeconds;
+}
+
+size_t TimingWheel::size() const {
+    return timerCount;
+}
@@ -52,7 +52,7 @@ bool UserManager::deleteUser(const std::string& username) {
 }
 
 User* UserManager::findUser(const std::string& username) {
-    auto it = SearchUtil::mapFind(users, username);
+    auto it = users.find(username);
     if (it == users.end()) {
         return nullptr;
     }
@@ -61,7 +61,7 @@ User* UserManager::findUser(const std::string& username) {
 }
 
 const User* UserManager::findUser(const std::string& username) const {
-    auto it = SearchUtil::mapFind(users, username);
+    auto it = users.find(username);
     if (it == users.end()) {
         return nullptr;
     }
@@ -163,9 +163,7 @@ namespace VisualizationUtil {
             sortedData.push_back(item);
         }
         
-        SortUtil::sort(sortedData, [](const auto& a, const auto& b) {
-            return a.second > b.second;
-        });
+        SortUtil::radixSort(sortedData, [](const auto& item) { return item.second; }, true);
         
         drawBarChart(sortedData, title, maxWidth);
     }
@@ -183,9 +181,7 @@ namespace VisualizationUtil {
             sortedData.push_back({std::to_string(item.first), item.second});
         }
         
-        SortUtil::sort(sortedData, [](const auto& a, const auto& b) { 
-            return a.second > b.second; 
-        });
+        SortUtil::radixSort(sortedData, [](const auto& item) { return item.second; }, true);
         
         drawBarChart(sortedData, title, maxWidth);
     }
@@ -323,29 +319,30 @@ namespace VisualizationUtil {
             sortedData.push_back(item);
         }
         
-        // Sort by value (descending) for better visualization
-        SortUtil::sort(sortedData, [](const auto& a, const auto& b) {
-            return a.second > b.second;
-        });
+        // Sort by value (descending) for better visualization; counts are integers, so radix sort
+        SortUtil::radixSort(sortedData, [](const auto& item) { return item.second; }, true);
         
         drawPieChart(sortedData, title);
     }
     
     // Helper to convert unordered_map to sorted vector for visualization
     template<typename K, typename V>
-    std::vector<std::pair<K, V>> sortMapByValue(const std::unordered_map<K, V>& map, bool ascending) {
+    std::vector<std::pair<K, V>> sortMapByValue(const std::unordered_map<K, V>& map, bool ascending,
+                                                size_t limit) {
         std::vector<std::pair<K, V>> pairs;
+        pairs.reserve(map.size());
         for (const auto& item : map) {
             pairs.push_back(item);
         }
         
-        // Use SortUtil instead of std::sort
+        // Only the first `limit` entries are selected and sorted (0 = all)
+        size_t keep = (limit == 0) ? pairs.size() : limit;
         if (ascending) {
-            SortUtil::sort(pairs, [](const auto& a, const auto& b) { 
+            SortUtil::topK(pairs, keep, [](const auto& a, const auto& b) { 
                 return a.second < b.second; 
             });
         } else {
-            SortUtil::sort(pairs, [](const auto& a, const auto& b) { 
+            SortUtil::topK(pairs, keep, [](const auto& a, const auto& b) { 
                 return a.second > b.second; 
             });
         }
@@ -355,7 +352,7 @@ namespace VisualizationUtil {
     
     // Explicit template instantiations
     template std::vector<std::pair<std::string, int>> sortMapByValue(
-        const std::unordered_map<std::string, int>& map, bool ascending);
+        const std::unordered_map<std::string, int>& map, bool ascending, size_t limit);
     template std::vector<std::pair<int, int>> sortMapByValue(
-        const std::unordered_map<int, int>& map, bool ascending);
+        const std::unordered_map<int, int>& map, bool ascending, size_t limit);
 } 
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include "../include/WorkerPool.h"
+#include "../include/SortUtil.h"
+
+namespace {
+    thread_local bool insidePoolTask = false;
+}
+
+WorkerPool::WorkerPool(size_t threadCount)
+    : job(nullptr), generation(0), pending(0), stopping(false) {
+    startWorkers(threadCount == 0 ? defaultThreadCount() : threadCount);
+}
+
+WorkerPool::~WorkerPool() {
+    stopWorkers();
+}
+
+size_t WorkerPool::defaultThreadCount() {
+    unsigned int hardware = std::thread::hardware_concurrency();
+    return hardware == 0 ? 1 : hardware;
+}
+
+WorkerPool& WorkerPool::shared() {
+    static WorkerPool pool;
+    return pool;
+}
+
+void WorkerPool::startWorkers(size_t threadCount) {
+    stopping = false;
+    // 呼叫端執行緒本身算作第 0 號執行緒；此時沒有進行中的工作，新執行緒從目前世代開始等待
+    for (size_t i = 1; i < threadCount; ++i) {
+        workers.emplace_back(&WorkerPool::workerLoop, this, i, generation);
+    }
+}
+
+void WorkerPool::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers.clear();
+}
+
+size_t WorkerPool::getThreadCount() const {
+    return workers.size() + 1;
+}
+
+void WorkerPool::setThreadCount(size_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = defaultThreadCount();
+    }
+
+    std::lock_guard<std::mutex> submitLock(submitMutex);
+    if (threadCount == getThreadCount()) {
+        return;
+    }
+
+    stopWorkers();
+    startWorkers(threadCount);
+}
+
+void WorkerPool::runMorsels(Job& job, size_t workerIndex) {
+    bool wasInside = insidePoolTask;
+    insidePoolTask = true;
+
+    while (true) {
+        size_t begin = job.next.fetch_add(job.morselSize);
+        if (begin >= job.count) {
+            break;
+        }
+        size_t end = begin + job.morselSize < job.count ? begin + job.morselSize : job.count;
+
+        try {
+            (*job.task)(begin, end, workerIndex);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(job.errorMutex);
+            if (!job.error) {
+                job.error = std::current_exception();
+            }
+            // 讓其他執行緒盡快結束
+            job.next.store(job.count);
+        }
+    }
+
+    insidePoolTask = wasInside;
+}
+
+void WorkerPool::workerLoop(size_t workerIndex, unsigned long startGeneration) {
+    unsigned long seenGeneration = startGeneration;
+
+    while (true) {
+        Job* current = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = generation;
+            current = job;
+        }
+
+        runMorsels(*current, workerIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) {
+                done.notify_all();
+            }
+        }
+    }
+}
+
+void WorkerPool::parallelFor(size_t count, size_t morselSize, const RangeTask& task) {
+    parallelFor(count, morselSize, PrepareTask(), task);
+}
+
+void WorkerPool::parallelFor(size_t count, size_t morselSize, const PrepareTask& prepare, const RangeTask& task) {
+    if (count == 0) {
+        if (prepare) {
+            prepare(1);
+        }
+        return;
+    }
+    if (morselSize == 0) {
+        morselSize = 1;
+    }
+
+    // 巢狀呼叫時外層已持有提交鎖，不可再鎖；其餘情況在鎖內讀取執行緒數，
+    // 避免與 setThreadCount 同時修改 workers
+    std::unique_lock<std::mutex> submitLock(submitMutex, std::defer_lock);
+    if (!insidePoolTask) {
+        submitLock.lock();
+    }
+
+    // 單執行緒、資料量不足一個區塊或巢狀呼叫時直接在呼叫端執行
+    if (workers.empty() || count <= morselSize || insidePoolTask) {
+        if (submitLock.owns_lock()) {
+            submitLock.unlock();
+        }
+        if (prepare) {
+            prepare(1);
+        }
+        for (size_t begin = 0; begin < count; begin += morselSize) {
+            size_t end = begin + morselSize < count ? begin + morselSize : count;
+            task(begin, end, 0);
+        }
+        return;
+    }
+
+    if (prepare) {
+        prepare(workers.size() + 1);
+    }
+
+    Job current;
+    current.task = &task;
+    current.count = count;
+    current.morselSize = morselSize;
+    current.next.store(0);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &current;
+        pending = workers.size();
+        ++generation;
+    }
+    wake.notify_all();
+
+    runMorsels(current, 0);
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&] { return pending == 0; });
+        job = nullptr;
+    }
+
+    if (current.error) {
+        std::rethrow_exception(current.error);
+    }
+}
+
+// SortUtil::parallelSort 透過這兩個函式使用共享工作池
+size_t SortUtil::detail::poolThreadCount() {
+    return WorkerPool::shared().getThreadCount();
+}
+
+void SortUtil::detail::poolParallelFor(size_t count, size_t morselSize,
+                                       const std::function<void(size_t, size_t, size_t)>& task) {
+    WorkerPool::shared().parallelFor(count, morselSize, task);
+}
@@ -1,11 +1,43 @@
 #include <iostream>
+#include <string>
+#include <cstdlib>
 #include "../include/Library.h"
 
-int main() {
+namespace {
+    void printUsage(const char* program) {
+        std::cerr << "用法: " << program << " [--station [--input 路徑] [--batch 筆數] [--flush-ms 毫秒]]" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    bool station = false;
+    StationConfig stationConfig;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--station") {
+            station = true;
+        } else if (arg == "--input" && hasValue) {
+            stationConfig.inputPath = argv[++i];
+        } else if (arg == "--batch" && hasValue) {
+            stationConfig.maxBatch = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--flush-ms" && hasValue) {
+            stationConfig.flushMillis = std::atoi(argv[++i]);
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+    
     try {
         Library library("data/books.json", "data/users.json", 
                        "data/loans.json");
         
+        if (station) {
+            return library.runStation(stationConfig);
+        }
+        
         if (library.initialize()) {
             library.run();
         }
@@ -15,4 +47,4 @@ int main() {
     }
     
     return 0;
-} 
\ No newline at end of file
+}